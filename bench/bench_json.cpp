@@ -0,0 +1,142 @@
+// JSON benchmarks:
+//  - parse_json: the previous MiniJson tree + conversion against the direct
+//    json::parse
+//  - json_doc: building the structural index (json::Document) and reading
+//    three fields, against a full json::parse
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -Isrc bench/bench_json.cpp src/Json.cpp src/Simd.cpp src/MappedFile.cpp src/Memory.cpp -o bench_json
+//   ./bench_json [max_mb]
+//
+// Payloads are API-response shaped (arrays of records with nested objects,
+// strings and numbers) at 1 KB, 64 KB, 1 MB, 16 MB and 256 MB; MiniJson is
+// skipped above 16 MB.
+
+#include "Json.h"
+#include "Environment.h"
+#include "MiniJson.h"
+#include "Simd.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace {
+
+// The previous parse_json, as it was in Builtins.cpp
+Value oldParseJson(const std::string& text) {
+    MiniJson::Value root;
+    MiniJson::Reader reader;
+    if (!reader.parse(text, root)) {
+        throw RuntimeError("Failed to parse JSON");
+    }
+
+    std::function<Value(const MiniJson::Value&)> convert;
+    convert = [&](const MiniJson::Value& mv) -> Value {
+        if (mv.type == MiniJson::OBJECT) {
+            Value dv = Value::makeDictionary();
+            auto& map = dv.asDictionary().map;
+            for (const auto& name : mv.getMemberNames()) {
+                map[name] = convert(mv[name]);
+            }
+            return dv;
+        } else if (mv.type == MiniJson::ARRAY) {
+            std::vector<Value> av;
+            for (const auto& item : mv.items) av.push_back(convert(item));
+            return Value::makeArray(av);
+        } else {
+            std::string s = mv.asString();
+            if (s == "true") return Value(true);
+            if (s == "false") return Value(false);
+            if (s == "null") return Value();
+            if (!s.empty() && (isdigit(s[0]) || s[0] == '-' || s[0] == '.')) {
+                try {
+                    size_t pos;
+                    double d = std::stod(s, &pos);
+                    if (pos == s.length()) return Value(d);
+                } catch (...) {}
+            }
+            return Value(s);
+        }
+    };
+    return convert(root);
+}
+
+std::string makePayload(size_t size) {
+    static const char* const names[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot"};
+    std::mt19937 rng(7);
+    std::string out = "{\"model\": \"demo\", \"candidates\": [";
+    for (int i = 0; out.size() < size; i++) {
+        if (i > 0) out += ", ";
+        out += "{\"id\": " + std::to_string(i) +
+               ", \"name\": \"" + names[rng() % 6] + "\"" +
+               ", \"score\": " + std::to_string((rng() % 100000) / 1000.0) +
+               ", \"active\": " + (rng() % 2 ? "true" : "false") +
+               ", \"tags\": [\"x\", \"y\", \"z\"]" +
+               ", \"content\": {\"role\": \"model\", \"text\": \"The quick brown fox jumps over the lazy dog\"}}";
+    }
+    out += "], \"usage\": {\"promptTokens\": 12, \"totalTokens\": 345}}";
+    return out;
+}
+
+double timeMs(const std::function<void()>& fn, size_t bytes) {
+    int reps = static_cast<int>(std::max<size_t>(1, (32u << 20) / std::max<size_t>(bytes, 1)));
+    reps = std::min(reps, 5000);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / reps;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxMb = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 256;
+    const size_t sizes[] = {1u << 10, 64u << 10, 1u << 20, 16u << 20, 256u << 20};
+    volatile size_t sink = 0;
+
+    std::printf("parse_json (%s)\n", simd::levelName());
+    for (size_t size : sizes) {
+        if (size > (maxMb << 20) && size > (1u << 20)) break;
+        std::string text = makePayload(size);
+        double newMs = timeMs([&] { sink = json::parse(text).asDictionary().map.size(); }, text.size());
+        if (size > (16u << 20)) {
+            std::printf("%10zu B  MiniJson       n/a     json::parse %9.3f ms         (%.0f MB/s)\n",
+                        text.size(), newMs, text.size() / (newMs * 1e3));
+            continue;
+        }
+        double oldMs = timeMs([&] { sink = oldParseJson(text).asDictionary().map.size(); }, text.size());
+        std::printf("%10zu B  MiniJson %9.3f ms  json::parse %9.3f ms  %5.2fx  (%.0f MB/s)\n",
+                    text.size(), oldMs, newMs, oldMs / newMs, text.size() / (newMs * 1e3));
+    }
+
+    std::printf("json_doc + 3 x json_get vs parse_json\n");
+    for (size_t size : sizes) {
+        if (size > (maxMb << 20) && size > (1u << 20)) break;
+        auto text = std::make_shared<EZString>(makePayload(size));
+        std::vector<json::PathStep> model = json::parsePath("model");
+        std::vector<json::PathStep> first = json::parsePath("candidates[0].content.text");
+        std::vector<json::PathStep> usage = json::parsePath("usage.totalTokens");
+        double fullMs = timeMs([&] { sink = json::parse(text->view()).asDictionary().map.size(); }, text->size());
+        double docMs = timeMs([&] {
+            json::Document doc(text);
+            Value out;
+            doc.get(model, out);
+            doc.get(first, out);
+            doc.get(usage, out);
+            sink = static_cast<size_t>(out.asNumber());
+        }, text->size());
+        std::vector<uint32_t> index;
+        double stage1Ms = timeMs([&] {
+            index.clear();
+            simd::jsonStructurals(text->data(), text->size(), index);
+            sink = index.size();
+        }, text->size());
+        std::printf("%10zu B  parse_json %9.3f ms  json_doc %9.3f ms  %5.2fx  (stage 1 alone %.0f MB/s)\n",
+                    text->size(), fullMs, docMs, fullMs / docMs, text->size() / (stage1Ms * 1e3));
+    }
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Number <-> text benchmark: the previous Value::toString number formatting
+// (int cast / std::to_string) and num() parsing (std::stod) against the
+// <charconv> helpers in Numbers.h.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -Isrc bench/bench_numbers.cpp -o bench_numbers
+//   ./bench_numbers
+//
+// Each case converts 1M values: small integers (ids, counters), prices with
+// two decimals, and arbitrary doubles.
+
+#include "Numbers.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The previous Value::toString for numbers
+std::string oldFormat(double num) {
+    if (num == static_cast<int>(num)) {
+        return std::to_string(static_cast<int>(num));
+    }
+    return std::to_string(num);
+}
+
+volatile size_t sink;
+
+double timeMs(const std::function<void()>& fn) {
+    fn();  // warm up
+    const int reps = 5;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / reps;
+}
+
+void report(const char* name, double oldMs, double newMs) {
+    std::printf("  %-22s old %8.2f ms  new %8.2f ms  %5.2fx\n", name, oldMs, newMs, oldMs / newMs);
+}
+
+void runCase(const char* name, const std::vector<double>& values) {
+    std::printf("%s\n", name);
+
+    // Formatting, as `str(x)` / `out x` / string concatenation do it
+    report("format", timeMs([&] {
+        size_t total = 0;
+        for (double d : values) total += oldFormat(d).size();
+        sink = total;
+    }), timeMs([&] {
+        size_t total = 0;
+        for (double d : values) total += formatNumber(d).size();
+        sink = total;
+    }));
+
+    // join(row, ","): appending into one buffer
+    report("join into one string", timeMs([&] {
+        std::string out;
+        for (double d : values) {
+            out += oldFormat(d);
+            out += ',';
+        }
+        sink = out.size();
+    }), timeMs([&] {
+        std::string out;
+        for (double d : values) {
+            appendNumber(out, d);
+            out += ',';
+        }
+        sink = out.size();
+    }));
+
+    // num(): parse back the new (shortest) text
+    std::vector<std::string> texts;
+    texts.reserve(values.size());
+    for (double d : values) texts.push_back(formatNumber(d));
+    report("parse", timeMs([&] {
+        double total = 0;
+        for (const auto& t : texts) total += std::stod(t);
+        sink = static_cast<size_t>(total);
+    }), timeMs([&] {
+        double total = 0;
+        for (const auto& t : texts) {
+            double d = 0;
+            parseNumber(t, d);
+            total += d;
+        }
+        sink = static_cast<size_t>(total);
+    }));
+}
+
+} // namespace
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(11);
+    std::vector<double> ints, prices, doubles;
+    for (size_t i = 0; i < n; i++) {
+        ints.push_back(static_cast<double>(rng() % 1000000));
+        prices.push_back(static_cast<double>(rng() % 100000) / 100.0);
+        doubles.push_back(std::uniform_real_distribution<double>(-1e6, 1e6)(rng));
+    }
+    runCase("integers", ints);
+    runCase("prices (2 decimals)", prices);
+    runCase("arbitrary doubles", doubles);
+    return 0;
+}
@@ -0,0 +1,175 @@
+// String kernel microbenchmarks: the original std::string implementations of
+// split/replace/contains/upper/trim against the simd:: kernels that back the
+// builtins now.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -Isrc bench/bench_strings.cpp src/Simd.cpp -o bench_strings
+//   ./bench_strings [max_mb]
+//
+// Each case runs at 1 KB, 64 KB, 1 MB and 100 MB (or up to max_mb) and is
+// repeated at every SIMD level the CPU supports.
+
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ---- Previous implementations (as they were in Builtins.cpp) ----
+
+std::vector<std::string> oldSplit(const std::string& str, const std::string& delim) {
+    std::vector<std::string> result;
+    size_t start = 0;
+    size_t end = str.find(delim);
+    while (end != std::string::npos) {
+        result.push_back(str.substr(start, end - start));
+        start = end + delim.length();
+        end = str.find(delim, start);
+    }
+    result.push_back(str.substr(start));
+    return result;
+}
+
+std::string oldReplace(std::string s, const std::string& from, const std::string& to) {
+    size_t pos = 0;
+    while ((pos = s.find(from, pos)) != std::string::npos) {
+        s.replace(pos, from.length(), to);
+        pos += to.length();
+    }
+    return s;
+}
+
+std::string oldUpper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+    return s;
+}
+
+std::string oldTrim(std::string s) {
+    s.erase(0, s.find_first_not_of(" \t\n\r"));
+    s.erase(s.find_last_not_of(" \t\n\r") + 1);
+    return s;
+}
+
+// ---- New implementations ----
+
+std::vector<std::string> newSplit(const std::string& str, char delim) {
+    std::vector<size_t> positions;
+    simd::splitByte(str.data(), str.size(), delim, positions);
+    std::vector<std::string> result;
+    result.reserve(positions.size() + 1);
+    size_t start = 0;
+    for (size_t pos : positions) {
+        result.emplace_back(str.data() + start, pos - start);
+        start = pos + 1;
+    }
+    result.emplace_back(str.data() + start, str.size() - start);
+    return result;
+}
+
+std::string newUpper(const std::string& s) {
+    std::string out(s.size(), '\0');
+    simd::toUpperAscii(s.data(), &out[0], s.size());
+    return out;
+}
+
+std::string newTrim(const std::string& s) {
+    size_t begin, end;
+    simd::trimBounds(s.data(), s.size(), begin, end);
+    return s.substr(begin, end - begin);
+}
+
+// Log-like text: words separated by spaces, one line every ~80 bytes
+std::string makeText(size_t size) {
+    static const char* const words[] = {"GET", "/index.html", "200", "request", "served", "in",
+                                        "ms", "user", "session", "cache", "hit", "miss"};
+    std::mt19937 rng(42);
+    std::string text = "   \t";
+    size_t lineLen = 0;
+    while (text.size() < size) {
+        const char* w = words[rng() % 12];
+        text += w;
+        lineLen += std::char_traits<char>::length(w) + 1;
+        if (lineLen > 80) {
+            text += '\n';
+            lineLen = 0;
+        } else {
+            text += ' ';
+        }
+    }
+    text.resize(size);
+    return text + " \n ";
+}
+
+volatile size_t sink;
+
+double timeMs(const std::function<void()>& fn, size_t bytes) {
+    int reps = static_cast<int>(std::max<size_t>(1, (64u << 20) / std::max<size_t>(bytes, 1)));
+    reps = std::min(reps, 10000);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / reps;
+}
+
+void report(const char* name, size_t bytes, double oldMs, double newMs) {
+    double gbps = newMs > 0 ? bytes / (newMs * 1e6) : 0;
+    if (oldMs == 0) {
+        std::printf("  %-10s %10zu B  old        n/a     new %10.3f ms           (%.2f GB/s)\n",
+                    name, bytes, newMs, gbps);
+        return;
+    }
+    std::printf("  %-10s %10zu B  old %10.3f ms  new %10.3f ms  %6.2fx  (%.2f GB/s)\n",
+                name, bytes, oldMs, newMs, newMs > 0 ? oldMs / newMs : 0.0, gbps);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxMb = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 100;
+    std::vector<size_t> sizes = {1u << 10, 64u << 10, 1u << 20, 100u << 20};
+    sizes.erase(std::remove_if(sizes.begin(), sizes.end(),
+                               [&](size_t s) { return s > (maxMb << 20) && s > (1u << 20); }),
+                sizes.end());
+
+    const simd::Level levels[] = {simd::Level::SCALAR, simd::Level::SSE2, simd::Level::AVX2};
+    simd::Level best = simd::level();
+
+    for (simd::Level lvl : levels) {
+        if (lvl > best) break;
+        simd::setLevel(lvl);
+        std::printf("%s\n", simd::levelName());
+
+        for (size_t size : sizes) {
+            std::string text = makeText(size);
+            const std::string needle = "session cache miss!";  // absent: scans the whole text
+
+            report("contains", text.size(),
+                   timeMs([&] { sink = text.find(needle); }, text.size()),
+                   timeMs([&] { sink = simd::find(text.data(), text.size(), needle.data(), needle.size()); }, text.size()));
+            report("split", text.size(),
+                   timeMs([&] { sink = oldSplit(text, "\n").size(); }, text.size()),
+                   timeMs([&] { sink = newSplit(text, '\n').size(); }, text.size()));
+            // The old replace shifts the tail on every match (quadratic), so
+            // it is only timed up to 1 MB
+            double oldReplaceMs = size <= (1u << 20)
+                ? timeMs([&] { sink = oldReplace(text, "cache", "CACHE!").size(); }, text.size())
+                : 0;
+            report("replace", text.size(), oldReplaceMs,
+                   timeMs([&] { sink = simd::replaceAll(text.data(), text.size(), "cache", 5, "CACHE!", 6).size(); }, text.size()));
+            report("upper", text.size(),
+                   timeMs([&] { sink = oldUpper(text).size(); }, text.size()),
+                   timeMs([&] { sink = newUpper(text).size(); }, text.size()));
+            report("trim", text.size(),
+                   timeMs([&] { sink = oldTrim(text).size(); }, text.size()),
+                   timeMs([&] { sink = newTrim(text).size(); }, text.size()));
+        }
+    }
+    simd::setLevel(best);
+    return 0;
+}
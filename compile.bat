@@ -1,6 +1,6 @@
 @echo off
 echo Compiling EZ Interpreter...
-g++ -std=c++17 -o ez.exe src\main.cpp src\Lexer.cpp src\Parser.cpp src\Interpreter.cpp src\Builtins.cpp -lsqlite3 -lcurl -lws2_32 -lpthread
+g++ -std=c++17 -o ez.exe src\main.cpp src\Lexer.cpp src\Parser.cpp src\Interpreter.cpp src\Builtins.cpp src\Simd.cpp src\Generator.cpp src\MappedFile.cpp src\Json.cpp src\Output.cpp src\Profiler.cpp src\CallTracer.cpp src\Trace.cpp src\Bench.cpp src\Memory.cpp src\HotLines.cpp src\Metrics.cpp src\Log.cpp src\Platform.cpp -lsqlite3 -lcurl -lws2_32 -lpthread
 if %errorlevel% neq 0 (
     echo Compilation failed!
     exit /b %errorlevel%
@@ -143,6 +143,7 @@ struct LambdaExpr {
     std::vector<std::string> params;
     ExprPtr body;  // Expression body for single-expression lambdas
     std::vector<StmtPtr> stmtBody;  // Statement body for multi-statement lambdas
+    bool isGenerator = false;       // Statement body contains 'yield'
     
     LambdaExpr(std::vector<std::string> params, ExprPtr body)
         : params(std::move(params)), body(std::move(body)) {}
@@ -202,6 +203,7 @@ struct RepeatStmt;
 struct GetStmt;
 struct TaskStmt;
 struct GiveStmt;
+struct YieldStmt;
 struct EscapeStmt;
 struct SkipStmt;
 struct ModelStmt;
@@ -222,6 +224,7 @@ using StmtVariant = std::variant<
     std::shared_ptr<GetStmt>,
     std::shared_ptr<TaskStmt>,
     std::shared_ptr<GiveStmt>,
+    std::shared_ptr<YieldStmt>,
     std::shared_ptr<EscapeStmt>,
     std::shared_ptr<SkipStmt>,
     std::shared_ptr<ModelStmt>,
@@ -313,9 +316,11 @@ struct TaskStmt {
     std::string name;
     std::vector<std::string> params;
     std::vector<StmtPtr> body;
+    bool isGenerator;  // Body contains 'yield'
     
-    TaskStmt(const std::string& name, std::vector<std::string> params, std::vector<StmtPtr> body)
-        : name(name), params(std::move(params)), body(std::move(body)) {}
+    TaskStmt(const std::string& name, std::vector<std::string> params, std::vector<StmtPtr> body,
+             bool isGenerator = false)
+        : name(name), params(std::move(params)), body(std::move(body)), isGenerator(isGenerator) {}
 };
 
 // Return statement (give)
@@ -325,6 +330,13 @@ struct GiveStmt {
     explicit GiveStmt(ExprPtr val = nullptr) : value(std::move(val)) {}
 };
 
+// Yield statement - hands one value to whoever is iterating the generator
+struct YieldStmt {
+    ExprPtr value; // May be nullptr for bare 'yield'
+    
+    explicit YieldStmt(ExprPtr val = nullptr) : value(std::move(val)) {}
+};
+
 // Break statement (escape)
 struct EscapeStmt {};
 
@@ -345,6 +357,7 @@ struct ModelMember {
     ExprPtr initializer;  // For properties
     std::vector<std::string> params;  // For methods
     std::vector<StmtPtr> body;  // For methods
+    bool isGenerator = false;   // Method body contains 'yield'
 };
 
 // Model (class) definition
@@ -449,8 +462,11 @@ inline ExprPtr makeLambdaExpr(int line, std::vector<std::string> params, ExprPtr
     return std::make_shared<Expr>(line, std::make_shared<LambdaExpr>(std::move(params), std::move(body)));
 }
 
-inline ExprPtr makeLambdaExpr(int line, std::vector<std::string> params, std::vector<StmtPtr> stmtBody) {
-    return std::make_shared<Expr>(line, std::make_shared<LambdaExpr>(std::move(params), std::move(stmtBody)));
+inline ExprPtr makeLambdaExpr(int line, std::vector<std::string> params, std::vector<StmtPtr> stmtBody,
+                              bool isGenerator = false) {
+    auto lambda = std::make_shared<LambdaExpr>(std::move(params), std::move(stmtBody));
+    lambda->isGenerator = isGenerator;
+    return std::make_shared<Expr>(line, lambda);
 }
 
 // Helper functions to create statements
@@ -486,14 +502,19 @@ inline StmtPtr makeGetStmt(int line, const std::string& var, ExprPtr iter, StmtP
     return std::make_shared<Stmt>(line, std::make_shared<GetStmt>(var, std::move(iter), std::move(body)));
 }
 
-inline StmtPtr makeTaskStmt(int line, const std::string& name, std::vector<std::string> params, std::vector<StmtPtr> body) {
-    return std::make_shared<Stmt>(line, std::make_shared<TaskStmt>(name, std::move(params), std::move(body)));
+inline StmtPtr makeTaskStmt(int line, const std::string& name, std::vector<std::string> params, std::vector<StmtPtr> body,
+                            bool isGenerator = false) {
+    return std::make_shared<Stmt>(line, std::make_shared<TaskStmt>(name, std::move(params), std::move(body), isGenerator));
 }
 
 inline StmtPtr makeGiveStmt(int line, ExprPtr val = nullptr) {
     return std::make_shared<Stmt>(line, std::make_shared<GiveStmt>(std::move(val)));
 }
 
+inline StmtPtr makeYieldStmt(int line, ExprPtr val = nullptr) {
+    return std::make_shared<Stmt>(line, std::make_shared<YieldStmt>(std::move(val)));
+}
+
 inline StmtPtr makeEscapeStmt(int line) {
     return std::make_shared<Stmt>(line, std::make_shared<EscapeStmt>());
 }
@@ -0,0 +1,248 @@
+#include "Bench.h"
+#include "Interpreter.h"
+#include "Json.h"
+#include "Lexer.h"
+#include "Memory.h"
+#include "Output.h"
+#include "Parser.h"
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    size_t samples = 0;
+    double mean = 0;  // all times in ns per call
+    double ci95 = 0;
+    double median = 0;
+    double p99Batch = 0;  // p99 of the batch means, not of single calls
+    double stddev = 0;
+    double allocsPerCall = 0;
+};
+
+double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Two-sided 95% critical value of Student's t for df degrees of freedom
+double tCritical(size_t df) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0) return 0;
+    if (df <= 30) return table[df - 1];
+    return df <= 60 ? 2.000 : df <= 120 ? 1.980 : 1.960;
+}
+
+std::string formatTime(double ns) {
+    char buf[32];
+    if (ns < 1e3) std::snprintf(buf, sizeof(buf), "%.1f ns", ns);
+    else if (ns < 1e6) std::snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
+    else if (ns < 1e9) std::snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+    else std::snprintf(buf, sizeof(buf), "%.3f s", ns / 1e9);
+    return buf;
+}
+
+void print(const std::string& text) {
+    Output::instance().write(text);
+    Output::instance().flush();
+}
+
+Result measure(Interpreter& interp, const std::string& name, const Value& task, const BenchOptions& options) {
+    const std::vector<Value> noArgs;
+    const double budget = options.seconds * 1e9;
+
+    // Warmup, also estimating the cost of one call
+    uint64_t warmCalls = 0;
+    Clock::time_point warmStart = Clock::now();
+    do {
+        interp.callFunction(task, noArgs, 0);
+        warmCalls++;
+    } while (nanosSince(warmStart) < budget / 10);
+    double perCall = nanosSince(warmStart) / static_cast<double>(warmCalls);
+
+    uint64_t batch = std::max<uint64_t>(1, static_cast<uint64_t>(BenchRunner::BATCH_MS * 1e6 / std::max(perCall, 1.0)));
+    std::vector<double> samples;
+    uint64_t iterations = 0;
+    double elapsed = 0;
+    uint64_t allocsBefore = memory::threadAllocations();
+    while ((elapsed < budget || samples.size() < BenchRunner::MIN_SAMPLES) &&
+           elapsed < budget * BenchRunner::MAX_BUDGETS) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) interp.callFunction(task, noArgs, 0);
+        double ns = nanosSince(start);
+        samples.push_back(ns / static_cast<double>(batch));
+        iterations += batch;
+        elapsed += ns;
+    }
+    uint64_t allocs = memory::threadAllocations() - allocsBefore;
+
+    Result r;
+    r.name = name;
+    r.iterations = iterations;
+    r.samples = samples.size();
+    r.allocsPerCall = static_cast<double>(allocs) / static_cast<double>(iterations);
+    double sum = 0;
+    for (double s : samples) sum += s;
+    r.mean = sum / static_cast<double>(samples.size());
+    double squares = 0;
+    for (double s : samples) squares += (s - r.mean) * (s - r.mean);
+    r.stddev = samples.size() > 1 ? std::sqrt(squares / static_cast<double>(samples.size() - 1)) : 0;
+    r.ci95 = tCritical(samples.size() - 1) * r.stddev / std::sqrt(static_cast<double>(samples.size()));
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    r.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+    r.p99Batch = samples[std::min(samples.size() - 1, static_cast<size_t>(std::ceil(0.99 * samples.size())) - 1)];
+    return r;
+}
+
+void writeJson(const std::string& path, const std::string& script, const std::vector<Result>& results) {
+    std::vector<Value> items;
+    for (const Result& r : results) {
+        Value item = Value::makeDictionary();
+        auto& map = item.asDictionary().map;
+        map["name"] = Value(r.name);
+        map["iterations"] = Value(static_cast<double>(r.iterations));
+        map["samples"] = Value(static_cast<double>(r.samples));
+        map["mean_ns"] = Value(r.mean);
+        map["ci95_ns"] = Value(r.ci95);
+        map["median_ns"] = Value(r.median);
+        map["p99_batch_mean_ns"] = Value(r.p99Batch);
+        map["stddev_ns"] = Value(r.stddev);
+        map["allocs_per_call"] = Value(r.allocsPerCall);
+        items.push_back(item);
+    }
+    Value root = Value::makeDictionary();
+    auto& map = root.asDictionary().map;
+    map["script"] = Value(script);
+    map["simd"] = Value(std::string(simd::levelName()));
+    map["benchmarks"] = Value::makeArray(items);
+
+    std::string text;
+    json::write(root, text, true);
+    text += '\n';
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "bench: could not write '%s'\n", path.c_str());
+        return;
+    }
+    std::fwrite(text.data(), 1, text.size(), out);
+    std::fclose(out);
+}
+
+// Prints each benchmark against the same name in a file written by --json.
+// A difference smaller than the two confidence intervals combined is
+// reported as noise.
+void compare(const std::string& path, const std::vector<Result>& results) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "bench: could not open '" << path << "'" << std::endl;
+        return;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::unordered_map<std::string, std::pair<double, double>> baseline;  // name -> (mean, ci95)
+    try {
+        Value root = json::parse(buffer.str());
+        const Value& list = root.asDictionary().map.at("benchmarks");
+        for (const Value& item : list.asArray()) {
+            const auto& map = item.asDictionary().map;
+            baseline[map.at("name").toString()] = {map.at("mean_ns").asNumber(), map.at("ci95_ns").asNumber()};
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bench: '" << path << "' is not a bench result file (" << e.what() << ")" << std::endl;
+        return;
+    }
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "\nCompared with %s\n%-28s %12s %12s %8s\n", path.c_str(), "benchmark", "before",
+                  "after", "speedup");
+    print(line);
+    for (const Result& r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) continue;
+        double before = it->second.first;
+        bool noise = std::fabs(before - r.mean) <= it->second.second + r.ci95;
+        std::snprintf(line, sizeof(line), "%-28s %12s %12s %7.2fx%s\n", r.name.c_str(), formatTime(before).c_str(),
+                      formatTime(r.mean).c_str(), before / r.mean, noise ? "  (within noise)" : "");
+        print(line);
+    }
+}
+
+} // namespace
+
+int BenchRunner::run(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
+        return 65;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string source = buffer.str();
+
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.tokenize();
+    if (lexer.hasError()) return 65;
+    Parser parser(tokens);
+    std::vector<StmtPtr> statements = parser.parse();
+    if (parser.hasError()) return 65;
+
+    std::vector<std::string> names;
+    for (const auto& stmt : statements) {
+        if (auto task = std::get_if<std::shared_ptr<TaskStmt>>(&stmt->variant)) {
+            const std::string& name = (*task)->name;
+            if (name.rfind("bench_", 0) == 0 && (*task)->params.empty() &&
+                name.find(options.filter) != std::string::npos) {
+                names.push_back(name);
+            }
+        }
+    }
+    if (names.empty()) {
+        std::cerr << "bench: no bench_* tasks without parameters in '" << path << "'" << std::endl;
+        return 1;
+    }
+
+    Interpreter interp;
+    interp.interpret(statements);
+
+    char line[200];
+    std::snprintf(line, sizeof(line), "%-28s %10s %12s %8s %12s %12s %12s\n", "benchmark", "calls", "mean", "+/-95%",
+                  "median", "p99 batch", "allocs/call");
+    print(line);
+
+    std::vector<Result> results;
+    int status = 0;
+    for (const std::string& name : names) {
+        try {
+            Value task = interp.getGlobalEnv()->get(name);
+            Result r = measure(interp, name, task, options);
+            std::snprintf(line, sizeof(line), "%-28s %10llu %12s %7.1f%% %12s %12s %12.1f\n", name.c_str(),
+                          static_cast<unsigned long long>(r.iterations), formatTime(r.mean).c_str(),
+                          r.mean > 0 ? 100.0 * r.ci95 / r.mean : 0.0, formatTime(r.median).c_str(),
+                          formatTime(r.p99Batch).c_str(), r.allocsPerCall);
+            print(line);
+            results.push_back(r);
+        } catch (const RuntimeError& e) {
+            Output::instance().flush();
+            std::cerr << name << ": [Line " << e.line << "] Runtime Error: " << e.what() << std::endl;
+            status = 1;
+        }
+    }
+
+    if (!options.jsonOut.empty()) writeJson(options.jsonOut, path, results);
+    if (!options.comparePath.empty()) compare(options.comparePath, results);
+    return status;
+}
@@ -0,0 +1,46 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+
+// Microbenchmark runner behind `ez bench file.ez`.
+//
+// The script's top level runs once; then every task named bench_* (in the
+// order it is declared, taking no arguments) is benchmarked:
+//
+//   1. warmup: called repeatedly for a tenth of the time budget, which also
+//      estimates the cost of one call;
+//   2. the call is repeated in batches sized to take about BATCH_MS each,
+//      so timer overhead stays negligible even for sub-microsecond bodies;
+//   3. batches are collected until the time budget is used up (at least
+//      MIN_SAMPLES of them, at most MAX_BUDGETS budgets for slow benches).
+//
+// Each batch yields one per-call sample, the batch's mean. The report gives
+// the mean with a 95% confidence interval (Student's t), the median, the
+// p99 of the batch means (which smooths out single slow calls rather than
+// showing a per-call tail) and heap allocations per call. --json writes the same as JSON, and --compare reads
+// such a file back to print the speedup of each benchmark.
+struct BenchOptions {
+    double seconds = 1.0;     // time budget per benchmark
+    std::string filter;       // only names containing this
+    std::string jsonOut;      // results file, if any
+    std::string comparePath;  // baseline results, if any
+};
+
+class BenchRunner {
+public:
+    static constexpr double BATCH_MS = 5.0;
+    static constexpr size_t MIN_SAMPLES = 10;
+    static constexpr double MAX_BUDGETS = 5.0;
+
+    explicit BenchRunner(BenchOptions options) : options(std::move(options)) {}
+
+    // Returns the process exit code: 0, 1 if a benchmark failed, 65 if the
+    // script cannot be read or parsed
+    int run(const std::string& path);
+
+private:
+    BenchOptions options;
+};
+
+#endif // BENCH_H
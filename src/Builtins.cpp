@@ -1,1695 +1,2417 @@
-#include "Builtins.h"
-#include "Interpreter.h"
-#include <iostream>
-#include <cmath>
-#include <cstdlib>
-#include <ctime>
-#include <algorithm>
-#include <string>
-#include <vector>
-#include <fstream>
-#include <sstream>
-#include <map>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <conio.h>
-#include "MiniJson.h"
-
-
-#include <sqlite3.h>
-#include <chrono>
-#include <curl/curl.h>
-#include <thread>
-#include <future>
-
-void registerBuiltins(Interpreter& interp) {
-    // clock() - returns milliseconds since epoch
-    interp.defineGlobal("clock", Value::makeNativeFunction("clock", 0,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            auto now = std::chrono::system_clock::now();
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now.time_since_epoch()
-            ).count();
-            return Value((double)ms);
-        }));
-
-    // Input function
-    interp.defineGlobal("__input__", Value::makeNativeFunction("input", 0, 
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            std::string line;
-            std::getline(std::cin, line);
-            return Value(line);
-        }));
-    
-    // len(x) - length of string or array
-    interp.defineGlobal("len", Value::makeNativeFunction("len", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args[0].isString()) {
-                return Value(static_cast<double>(args[0].asString().length()));
-            }
-            if (args[0].isArray()) {
-                return Value(static_cast<double>(args[0].asArray().size()));
-            }
-            if (args[0].isDictionary()) {
-                return Value(static_cast<double>(args[0].asDictionary().map.size()));
-            }
-            throw RuntimeError("len() expects string or array");
-        }));
-    
-    // push(arr, val) - add element to array
-    interp.defineGlobal("push", Value::makeNativeFunction("push", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("push() expects array as first argument");
-            }
-            auto arr = args[0].asArrayPtr();
-            arr->push_back(args[1]);
-            return Value(arr);
-        }));
-    
-    // pop(arr) - remove and return last element
-    interp.defineGlobal("pop", Value::makeNativeFunction("pop", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("pop() expects array");
-            }
-            auto& arr = *args[0].asArrayPtr();
-            if (arr.empty()) {
-                throw RuntimeError("pop() on empty array");
-            }
-            Value last = arr.back();
-            arr.pop_back();
-            return last;
-        }));
-    
-    // str(x) - convert to string
-    interp.defineGlobal("str", Value::makeNativeFunction("str", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            return Value(args[0].toString());
-        }));
-    
-    // num(x) - convert to number
-    interp.defineGlobal("num", Value::makeNativeFunction("num", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args[0].isNumber()) return args[0];
-            if (args[0].isString()) {
-                try {
-                    return Value(std::stod(args[0].asString()));
-                } catch (...) {
-                    throw RuntimeError("Cannot convert '" + args[0].asString() + "' to number");
-                }
-            }
-            if (args[0].isBool()) {
-                return Value(args[0].asBool() ? 1.0 : 0.0);
-            }
-            throw RuntimeError("Cannot convert " + args[0].typeName() + " to number");
-        }));
-    
-    // type(x) - get type name
-    interp.defineGlobal("type", Value::makeNativeFunction("type", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            return Value(args[0].typeName());
-        }));
-    
-    // substr(s, start, len) - get substring
-    interp.defineGlobal("substr", Value::makeNativeFunction("substr", 3,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("substr() expects string as first argument");
-            }
-            if (!args[1].isNumber() || !args[2].isNumber()) {
-                throw RuntimeError("substr() expects numbers for start and length");
-            }
-            const std::string& str = args[0].asString();
-            int start = static_cast<int>(args[1].asNumber());
-            int len = static_cast<int>(args[2].asNumber());
-            
-            if (start < 0) start = 0;
-            if (start >= static_cast<int>(str.length())) return Value("");
-            if (len < 0) len = 0;
-            
-            return Value(str.substr(start, len));
-        }));
-    
-    // split(s, delim) - split string into array
-    interp.defineGlobal("split", Value::makeNativeFunction("split", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString() || !args[1].isString()) {
-                throw RuntimeError("split() expects two strings");
-            }
-            
-            const std::string& str = args[0].asString();
-            const std::string& delim = args[1].asString();
-            
-            std::vector<Value> result;
-            
-            if (delim.empty()) {
-                for (char c : str) {
-                    result.push_back(Value(std::string(1, c)));
-                }
-            } else {
-                size_t start = 0;
-                size_t end = str.find(delim);
-                
-                while (end != std::string::npos) {
-                    result.push_back(Value(str.substr(start, end - start)));
-                    start = end + delim.length();
-                    end = str.find(delim, start);
-                }
-                result.push_back(Value(str.substr(start)));
-            }
-            
-            return Value::makeArray(result);
-        }));
-    
-    // join(arr, delim) - join array into string
-    interp.defineGlobal("join", Value::makeNativeFunction("join", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("join() expects array as first argument");
-            }
-            if (!args[1].isString()) {
-                throw RuntimeError("join() expects string as delimiter");
-            }
-            
-            const auto& arr = args[0].asArray();
-            const std::string& delim = args[1].asString();
-            
-            std::string result;
-            for (size_t i = 0; i < arr.size(); i++) {
-                if (i > 0) result += delim;
-                result += arr[i].toString();
-            }
-            
-            return Value(result);
-        }));
-    
-    // floor(x)
-    interp.defineGlobal("floor", Value::makeNativeFunction("floor", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) {
-                throw RuntimeError("floor() expects number");
-            }
-            return Value(std::floor(args[0].asNumber()));
-        }));
-    
-    // ceil(x)
-    interp.defineGlobal("ceil", Value::makeNativeFunction("ceil", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) {
-                throw RuntimeError("ceil() expects number");
-            }
-            return Value(std::ceil(args[0].asNumber()));
-        }));
-    
-    // abs(x)
-    interp.defineGlobal("abs", Value::makeNativeFunction("abs", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) {
-                throw RuntimeError("abs() expects number");
-            }
-            return Value(std::abs(args[0].asNumber()));
-        }));
-    
-    // sqrt(x)
-    interp.defineGlobal("sqrt", Value::makeNativeFunction("sqrt", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) {
-                throw RuntimeError("sqrt() expects number");
-            }
-            double val = args[0].asNumber();
-            if (val < 0) {
-                throw RuntimeError("sqrt() of negative number");
-            }
-            return Value(std::sqrt(val));
-        }));
-    
-    // pow(base, exp)
-    interp.defineGlobal("pow", Value::makeNativeFunction("pow", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) {
-                throw RuntimeError("pow() expects two numbers");
-            }
-            return Value(std::pow(args[0].asNumber(), args[1].asNumber()));
-        }));
-    
-    // rand() - random number 0-1
-    interp.defineGlobal("rand", Value::makeNativeFunction("rand", 0,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            return Value(static_cast<double>(std::rand()) / RAND_MAX);
-        }));
-    
-    // randint(min, max) - random integer in range
-    interp.defineGlobal("randint", Value::makeNativeFunction("randint", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) {
-                throw RuntimeError("randint() expects two numbers");
-            }
-            int min = static_cast<int>(args[0].asNumber());
-            int max = static_cast<int>(args[1].asNumber());
-            return Value(static_cast<double>(min + std::rand() % (max - min + 1)));
-        }));
-    
-    // round(x)
-    interp.defineGlobal("round", Value::makeNativeFunction("round", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) {
-                throw RuntimeError("round() expects number");
-            }
-            return Value(std::round(args[0].asNumber()));
-        }));
-    
-    // min(a, b)
-    interp.defineGlobal("min", Value::makeNativeFunction("min", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) {
-                throw RuntimeError("min() expects two numbers");
-            }
-            return Value(std::min(args[0].asNumber(), args[1].asNumber()));
-        }));
-    
-    // max(a, b)
-    interp.defineGlobal("max", Value::makeNativeFunction("max", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) {
-                throw RuntimeError("max() expects two numbers");
-            }
-            return Value(std::max(args[0].asNumber(), args[1].asNumber()));
-        }));
-    
-    // contains(str/arr, item) - check if string/array contains item
-    interp.defineGlobal("contains", Value::makeNativeFunction("contains", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args[0].isString()) {
-                if (!args[1].isString()) {
-                    throw RuntimeError("contains() with string expects string to search for");
-                }
-                return Value(args[0].asString().find(args[1].asString()) != std::string::npos);
-            }
-            if (args[0].isArray()) {
-                const auto& arr = args[0].asArray();
-                for (const auto& elem : arr) {
-                    if (elem.equals(args[1])) {
-                        return Value(true);
-                    }
-                }
-                return Value(false);
-            }
-            if (args[0].isDictionary()) {
-                std::string key = args[1].toString();
-                const auto& dict = args[0].asDictionary();
-                return Value(dict.map.find(key) != dict.map.end());
-            }
-            throw RuntimeError("contains() expects string, array, or dictionary");
-        }));
-    
-    // indexOf(str/arr, item) - find index of item
-    interp.defineGlobal("indexOf", Value::makeNativeFunction("indexOf", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args[0].isString()) {
-                if (!args[1].isString()) {
-                    throw RuntimeError("indexOf() with string expects string to search for");
-                }
-                size_t pos = args[0].asString().find(args[1].asString());
-                if (pos == std::string::npos) return Value(-1.0);
-                return Value(static_cast<double>(pos));
-            }
-            if (args[0].isArray()) {
-                const auto& arr = args[0].asArray();
-                for (size_t i = 0; i < arr.size(); i++) {
-                    if (arr[i].equals(args[1])) {
-                        return Value(static_cast<double>(i));
-                    }
-                }
-                return Value(-1.0);
-            }
-            throw RuntimeError("indexOf() expects string or array");
-        }));
-    
-    // reverse(arr/str) - reverse array or string
-    interp.defineGlobal("reverse", Value::makeNativeFunction("reverse", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args[0].isString()) {
-                std::string s = args[0].asString();
-                std::reverse(s.begin(), s.end());
-                return Value(s);
-            }
-            if (args[0].isArray()) {
-                auto arr = args[0].asArray();
-                std::reverse(arr.begin(), arr.end());
-                return Value::makeArray(arr);
-            }
-            throw RuntimeError("reverse() expects string or array");
-        }));
-    
-    // sort(arr) - sort array
-    interp.defineGlobal("sort", Value::makeNativeFunction("sort", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("sort() expects array");
-            }
-            auto arr = args[0].asArray();
-            std::sort(arr.begin(), arr.end(), [](const Value& a, const Value& b) {
-                if (a.isNumber() && b.isNumber()) {
-                    return a.asNumber() < b.asNumber();
-                }
-                return a.toString() < b.toString();
-            });
-            return Value::makeArray(arr);
-        }));
-    
-    // upper(str) - uppercase
-    interp.defineGlobal("upper", Value::makeNativeFunction("upper", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("upper() expects string");
-            }
-            std::string s = args[0].asString();
-            std::transform(s.begin(), s.end(), s.begin(), ::toupper);
-            return Value(s);
-        }));
-    
-    // lower(str) - lowercase
-    interp.defineGlobal("lower", Value::makeNativeFunction("lower", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("lower() expects string");
-            }
-            std::string s = args[0].asString();
-            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-            return Value(s);
-        }));
-    
-    // trim(str) - trim whitespace
-    interp.defineGlobal("trim", Value::makeNativeFunction("trim", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("trim() expects string");
-            }
-            std::string s = args[0].asString();
-            s.erase(0, s.find_first_not_of(" \t\n\r"));
-            s.erase(s.find_last_not_of(" \t\n\r") + 1);
-            return Value(s);
-        }));
-    
-    // replace(str, old, new) - replace substring
-    interp.defineGlobal("replace", Value::makeNativeFunction("replace", 3,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString() || !args[1].isString() || !args[2].isString()) {
-                throw RuntimeError("replace() expects three strings");
-            }
-            std::string s = args[0].asString();
-            const std::string& from = args[1].asString();
-            const std::string& to = args[2].asString();
-            
-            if (from.empty()) return Value(s);
-            
-            size_t pos = 0;
-            while ((pos = s.find(from, pos)) != std::string::npos) {
-                s.replace(pos, from.length(), to);
-                pos += to.length();
-            }
-            return Value(s);
-        }));
-    
-    // slice(arr/str, start, end) - get slice
-    interp.defineGlobal("slice", Value::makeNativeFunction("slice", 3,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[1].isNumber() || !args[2].isNumber()) {
-                throw RuntimeError("slice() expects numbers for start and end");
-            }
-            int start = static_cast<int>(args[1].asNumber());
-            int end = static_cast<int>(args[2].asNumber());
-            
-            if (args[0].isString()) {
-                const std::string& s = args[0].asString();
-                int len = static_cast<int>(s.length());
-                if (start < 0) start = std::max(0, len + start);
-                if (end < 0) end = std::max(0, len + end);
-                if (start >= len) return Value("");
-                if (end > len) end = len;
-                if (start >= end) return Value("");
-                return Value(s.substr(start, end - start));
-            }
-            if (args[0].isArray()) {
-                const auto& arr = args[0].asArray();
-                int len = static_cast<int>(arr.size());
-                if (start < 0) start = std::max(0, len + start);
-                if (end < 0) end = std::max(0, len + end);
-                if (start >= len) return Value::makeArray({});
-                if (end > len) end = len;
-                if (start >= end) return Value::makeArray({});
-                return Value::makeArray(std::vector<Value>(arr.begin() + start, arr.begin() + end));
-            }
-            throw RuntimeError("slice() expects string or array");
-        }));
-    
-    // print (alias for out but as function)
-    interp.defineGlobal("print", Value::makeNativeFunction("print", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            for (size_t i = 0; i < args.size(); i++) {
-                if (i > 0) std::cout << " ";
-                std::cout << args[i].toString();
-            }
-            std::cout << std::endl;
-            return Value();
-        }));
-    
-    // input(prompt) - input with optional prompt
-    interp.defineGlobal("input", Value::makeNativeFunction("input", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args.empty()) {
-                std::cout << args[0].toString();
-            }
-            std::string line;
-            std::getline(std::cin, line);
-            return Value(line);
-        }));
-    
-    // range(end) or range(start, end) - create array from range
-    interp.defineGlobal("range", Value::makeNativeFunction("range", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.empty() || args.size() > 2) {
-                throw RuntimeError("range() expects 1 or 2 arguments");
-            }
-            
-            int start = 0, end = 0;
-            if (args.size() == 1) {
-                if (!args[0].isNumber()) throw RuntimeError("range() expects number");
-                end = static_cast<int>(args[0].asNumber());
-            } else {
-                if (!args[0].isNumber() || !args[1].isNumber()) {
-                    throw RuntimeError("range() expects numbers");
-                }
-                start = static_cast<int>(args[0].asNumber());
-                end = static_cast<int>(args[1].asNumber());
-            }
-            
-            std::vector<Value> result;
-            for (int i = start; i < end; i++) {
-                result.push_back(Value(static_cast<double>(i)));
-            }
-            return Value::makeArray(result);
-        }));
-    
-    // map(arr, fn) - apply function to each element
-    interp.defineGlobal("map", Value::makeNativeFunction("map", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("map() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("map() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            std::vector<Value> result;
-            
-            for (const auto& elem : arr) {
-                result.push_back(interp.callFunction(args[1], {elem}, 0));
-            }
-            
-            return Value::makeArray(result);
-        }));
-    
-    // filter(arr, fn) - filter elements where fn returns truthy
-    interp.defineGlobal("filter", Value::makeNativeFunction("filter", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("filter() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("filter() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            std::vector<Value> result;
-            
-            for (const auto& elem : arr) {
-                Value test = interp.callFunction(args[1], {elem}, 0);
-                if (test.isTruthy()) {
-                    result.push_back(elem);
-                }
-            }
-            
-            return Value::makeArray(result);
-        }));
-    
-    // reduce(arr, fn, initial) - reduce array to single value
-    interp.defineGlobal("reduce", Value::makeNativeFunction("reduce", 3,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("reduce() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("reduce() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            Value acc = args[2];
-            
-            for (const auto& elem : arr) {
-                acc = interp.callFunction(args[1], {acc, elem}, 0);
-            }
-            
-            return acc;
-        }));
-    
-    // forEach(arr, fn) - apply function to each element (no return)
-    interp.defineGlobal("forEach", Value::makeNativeFunction("forEach", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("forEach() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("forEach() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            
-            for (const auto& elem : arr) {
-                interp.callFunction(args[1], {elem}, 0);
-            }
-            
-            return Value();
-        }));
-    
-    // find(arr, fn) - find first element where fn returns truthy
-    interp.defineGlobal("find", Value::makeNativeFunction("find", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("find() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("find() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            
-            for (const auto& elem : arr) {
-                Value test = interp.callFunction(args[1], {elem}, 0);
-                if (test.isTruthy()) {
-                    return elem;
-                }
-            }
-            
-            return Value();  // nil if not found
-        }));
-    
-    // every(arr, fn) - true if fn returns truthy for all elements
-    interp.defineGlobal("every", Value::makeNativeFunction("every", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("every() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("every() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            
-            for (const auto& elem : arr) {
-                Value test = interp.callFunction(args[1], {elem}, 0);
-                if (!test.isTruthy()) {
-                    return Value(false);
-                }
-            }
-            
-            return Value(true);
-        }));
-    
-    // some(arr, fn) - true if fn returns truthy for at least one element
-    interp.defineGlobal("some", Value::makeNativeFunction("some", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) {
-                throw RuntimeError("some() expects array as first argument");
-            }
-            if (!args[1].isCallable()) {
-                throw RuntimeError("some() expects function as second argument");
-            }
-            
-            const auto& arr = args[0].asArray();
-            
-            for (const auto& elem : arr) {
-                Value test = interp.callFunction(args[1], {elem}, 0);
-                if (test.isTruthy()) {
-                    return Value(true);
-                }
-            }
-            
-            return Value(false);
-        }));
-    
-    // readFile(path) - read file content as string
-    interp.defineGlobal("readFile", Value::makeNativeFunction("readFile", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("readFile() expects string path");
-            }
-            std::string path = args[0].asString();
-            std::ifstream file(path);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "'");
-            }
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            return Value(buffer.str());
-        }));
-    
-    // writeFile(path, content) - write string to file
-    interp.defineGlobal("writeFile", Value::makeNativeFunction("writeFile", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("writeFile() expects string path");
-            }
-            if (!args[1].isString()) {
-                throw RuntimeError("writeFile() expects string content");
-            }
-            std::string path = args[0].asString();
-            std::string content = args[1].asString();
-            
-            std::ofstream file(path);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "' for writing");
-            }
-            file << content;
-            return Value(true);
-        }));
-    
-    // appendFile(path, content) - append string to file
-    interp.defineGlobal("appendFile", Value::makeNativeFunction("appendFile", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("appendFile() expects string path");
-            }
-            if (!args[1].isString()) {
-                throw RuntimeError("appendFile() expects string content");
-            }
-            std::string path = args[0].asString();
-            std::string content = args[1].asString();
-            
-            std::ofstream file(path, std::ios::app);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "' for appending");
-            }
-            file << content;
-            return Value(true);
-        }));
-    
-    // readLines(path) - read file into array of lines
-    interp.defineGlobal("readLines", Value::makeNativeFunction("readLines", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("readLines() expects string path");
-            }
-            std::string path = args[0].asString();
-            std::ifstream file(path);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "'");
-            }
-            std::vector<Value> lines;
-            std::string line;
-            while (std::getline(file, line)) {
-                lines.push_back(Value(line));
-            }
-            return Value::makeArray(lines);
-        }));
-    
-    // writeLine(path, content) - write string with newline to file
-    interp.defineGlobal("writeLine", Value::makeNativeFunction("writeLine", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("writeLine() expects string path");
-            }
-            if (!args[1].isString()) {
-                throw RuntimeError("writeLine() expects string content");
-            }
-            std::string path = args[0].asString();
-            std::string content = args[1].asString();
-            
-            std::ofstream file(path);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "' for writing");
-            }
-            file << content << std::endl;
-            return Value(true);
-        }));
-    
-    // appendLine(path, content) - append string with newline to file
-    interp.defineGlobal("appendLine", Value::makeNativeFunction("appendLine", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) {
-                throw RuntimeError("appendLine() expects string path");
-            }
-            if (!args[1].isString()) {
-                throw RuntimeError("appendLine() expects string content");
-            }
-            std::string path = args[0].asString();
-            std::string content = args[1].asString();
-            
-            std::ofstream file(path, std::ios::app);
-            if (!file.is_open()) {
-                throw RuntimeError("Could not open file '" + path + "' for appending");
-            }
-            file << content << std::endl;
-            return Value(true);
-        }));
-    
-    // keys(dict)
-    interp.defineGlobal("keys", Value::makeNativeFunction("keys", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isDictionary()) throw RuntimeError("keys() expects dictionary");
-            const auto& map = args[0].asDictionary().map;
-            std::vector<Value> keys;
-            for (const auto& kv : map) {
-                keys.push_back(Value(kv.first));
-            }
-            return Value::makeArray(keys);
-        }));
-    
-    // values(dict)
-    interp.defineGlobal("values", Value::makeNativeFunction("values", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isDictionary()) throw RuntimeError("values() expects dictionary");
-            const auto& map = args[0].asDictionary().map;
-            std::vector<Value> vals;
-            for (const auto& kv : map) {
-                vals.push_back(kv.second);
-            }
-            return Value::makeArray(vals);
-        }));
-
-#ifdef _WIN32
-    // server(port, handler) - Windows-only web server
-    interp.defineGlobal("server", Value::makeNativeFunction("server", 2,
-        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("server() port must be a number");
-            if (!args[1].isFunction()) throw RuntimeError("server() handler must be a function");
-            
-            int port = static_cast<int>(args[0].asNumber());
-            Value handler = args[1];
-
-            WSADATA wsaData;
-            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-                throw RuntimeError("WSAStartup failed");
-            }
-
-            SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-            if (listenSocket == INVALID_SOCKET) {
-                WSACleanup();
-                throw RuntimeError("Socket creation failed");
-            }
-
-            sockaddr_in serverAddr;
-            serverAddr.sin_family = AF_INET;
-            serverAddr.sin_addr.s_addr = INADDR_ANY;
-            serverAddr.sin_port = htons(port);
-
-            if (bind(listenSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-                closesocket(listenSocket);
-                WSACleanup();
-                throw RuntimeError("Bind failed");
-            }
-
-            if (listen(listenSocket, SOMAXCONN) == SOCKET_ERROR) {
-                closesocket(listenSocket);
-                WSACleanup();
-                throw RuntimeError("Listen failed");
-            }
-
-            while (true) {
-                SOCKET clientSocket = accept(listenSocket, nullptr, nullptr);
-                if (clientSocket == INVALID_SOCKET) break;
-
-                // Capture globalEnv to share with the new thread's interpreter
-                auto globalEnv = interp.getGlobalEnv();
-                
-                // Spawn a detached thread for each client
-                std::thread([clientSocket, handler, globalEnv]() {
-                    // OPTIMIZATION: Create a child environment for this request
-                    // and use the lightweight constructor to skip overhead
-                    auto requestEnv = globalEnv->createChild();
-                    Interpreter threadInterp(requestEnv);
-
-                    // Read headers
-                    std::string request;
-                    char buffer[4096];
-                    bool headersComplete = false;
-                    size_t contentLen = 0;
-                    
-                    while (!headersComplete) {
-                        int bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
-                        if (bytesRead <= 0) break;
-                        request.append(buffer, bytesRead);
-                        
-                        size_t headerEnd = request.find("\r\n\r\n");
-                        if (headerEnd != std::string::npos) {
-                            headersComplete = true;
-                            
-                            // Parse Content-Length
-                            size_t clPos = request.find("Content-Length: ");
-                            if (clPos != std::string::npos) {
-                                size_t start = clPos + 16;
-                                size_t end = request.find("\r\n", start);
-                                if (end != std::string::npos) {
-                                    contentLen = std::stoi(request.substr(start, end - start));
-                                }
-                            }
-                        }
-                    }
-
-                    if (headersComplete) {
-                        // Check if we have the full body
-                        size_t headerEnd = request.find("\r\n\r\n");
-                        size_t bodyStart = headerEnd + 4;
-                        
-                        while (request.length() - bodyStart < contentLen) {
-                            int bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
-                            if (bytesRead <= 0) break;
-                            request.append(buffer, bytesRead);
-                        }
-                        
-                        std::string method, fullPath, version, body;
-                        std::unordered_map<std::string, Value> headers;
-                        std::unordered_map<std::string, Value> query;
-
-                        // Parse Request Line
-                        size_t firstSpace = request.find(' ');
-                        if (firstSpace != std::string::npos) {
-                            method = request.substr(0, firstSpace);
-                            size_t secondSpace = request.find(' ', firstSpace + 1);
-                            if (secondSpace != std::string::npos) {
-                                fullPath = request.substr(firstSpace + 1, secondSpace - (firstSpace + 1));
-                                version = request.substr(secondSpace + 1, headerEnd - (secondSpace + 1)); // Approximate
-                            }
-                        }
-
-                        // Parse Path and Query Params
-                        std::string path = fullPath;
-                        size_t qPos = fullPath.find('?');
-                        if (qPos != std::string::npos) {
-                            path = fullPath.substr(0, qPos);
-                            std::string qStr = fullPath.substr(qPos + 1);
-                            size_t start = 0;
-                            while (start < qStr.length()) {
-                                size_t amPos = qStr.find('&', start);
-                                std::string pair = qStr.substr(start, amPos == std::string::npos ? amPos : amPos - start);
-                                size_t eqPos = pair.find('=');
-                                if (eqPos != std::string::npos) {
-                                    query[pair.substr(0, eqPos)] = Value(pair.substr(eqPos + 1));
-                                } else if (!pair.empty()) {
-                                    query[pair] = Value(true);
-                                }
-                                if (amPos == std::string::npos) break;
-                                start = amPos + 1;
-                            }
-                        }
-                        
-                        // Body
-                        if (request.length() > bodyStart) {
-                            body = request.substr(bodyStart);
-                        }
-                        
-                        // Parse Headers
-                        size_t pos = request.find("\r\n") + 2;
-                        while (pos < headerEnd) {
-                            size_t nextLine = request.find("\r\n", pos);
-                            if (nextLine == std::string::npos || nextLine > headerEnd) break;
-                            
-                            std::string line = request.substr(pos, nextLine - pos);
-                            size_t colon = line.find(':');
-                            if (colon != std::string::npos) {
-                                std::string k = line.substr(0, colon);
-                                std::string v = line.substr(colon + 1);
-                                v.erase(0, v.find_first_not_of(" "));
-                                headers[k] = Value(v);
-                            }
-                            pos = nextLine + 2;
-                        }
-
-                        // Create request object
-                        Value reqArg = Value::makeDictionary();
-                        auto& reqMap = reqArg.asDictionary().map;
-                        reqMap["method"] = Value(method);
-                        reqMap["path"] = Value(path);
-                        reqMap["fullPath"] = Value(fullPath);
-                        reqMap["version"] = Value(version);
-                        reqMap["body"] = Value(body);
-
-                        Value queryDict = Value::makeDictionary();
-                        queryDict.asDictionary().map = std::move(query);
-                        reqMap["query"] = queryDict;
-
-                        Value headerDict = Value::makeDictionary();
-                        headerDict.asDictionary().map = std::move(headers);
-                        reqMap["headers"] = headerDict;
-
-                        std::vector<Value> callbackArgs = {reqArg};
-                        try {
-                            Value result = threadInterp.callFunction(handler, callbackArgs, 0);
-                            std::string respStr;
-                            
-                            if (result.isDictionary()) {
-                                auto& d = result.asDictionary().map;
-                                int status = d.count("status") ? (int)d.at("status").asNumber() : 200;
-                                std::string b = d.count("body") ? d.at("body").toString() : "";
-                                
-                                respStr = "HTTP/1.1 " + std::to_string(status) + " OK\r\n";
-                                if (d.count("headers") && d.at("headers").isDictionary()) {
-                                    for (auto& kv : d.at("headers").asDictionary().map) {
-                                        respStr += kv.first + ": " + kv.second.toString() + "\r\n";
-                                    }
-                                } else {
-                                    respStr += "Content-Type: text/html\r\n";
-                                }
-                                respStr += "Content-Length: " + std::to_string(b.length()) + "\r\n";
-                                respStr += "\r\n";
-                                respStr += b;
-                            } else {
-                                respStr = result.toString();
-                                if (respStr.find("HTTP/") != 0) {
-                                    std::string b = respStr;
-                                    respStr = "HTTP/1.1 200 OK\r\n";
-                                    respStr += "Content-Type: text/html\r\n";
-                                    respStr += "Content-Length: " + std::to_string(b.length()) + "\r\n";
-                                    respStr += "\r\n";
-                                    respStr += b;
-                                }
-                            }
-                            
-                            send(clientSocket, respStr.c_str(), (int)respStr.length(), 0);
-                        } catch (const std::exception& e) {
-                            std::string errResp = "HTTP/1.1 500 Internal Server Error\r\n\r\nServer Error: " + std::string(e.what());
-                            send(clientSocket, errResp.c_str(), (int)errResp.length(), 0);
-                        }
-                    }
-                    closesocket(clientSocket);
-                }).detach();
-            }
-
-            closesocket(listenSocket);
-            WSACleanup();
-            return Value();
-        }));
-#else
-    interp.defineGlobal("server", Value::makeNativeFunction("server", 2,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            throw RuntimeError("server() is only supported on Windows");
-        }));
-#endif
-
-    // serveFile(path) - helper to serve a file with correct headers
-    interp.defineGlobal("serveFile", Value::makeNativeFunction("serveFile", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("serveFile() expects string path");
-            std::string path = args[0].asString();
-            
-            std::ifstream file(path, std::ios::binary);
-            if (!file.is_open()) {
-                Value resp = Value::makeDictionary();
-                resp.asDictionary().map["status"] = Value(404.0);
-                resp.asDictionary().map["body"] = Value("File not found: " + path);
-                return resp;
-            }
-            
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            std::string body = buffer.str();
-            
-            std::string ext = "";
-            size_t dot = path.find_last_of('.');
-            if (dot != std::string::npos) ext = path.substr(dot + 1);
-            
-            std::string mime = "text/plain";
-            if (ext == "html" || ext == "htm") mime = "text/html";
-            else if (ext == "css") mime = "text/css";
-            else if (ext == "js") mime = "text/javascript";
-            else if (ext == "png") mime = "image/png";
-            else if (ext == "jpg" || ext == "jpeg") mime = "image/jpeg";
-            else if (ext == "json") mime = "application/json";
-            
-            Value resp = Value::makeDictionary();
-            auto& d = resp.asDictionary().map;
-            d["status"] = Value(200.0);
-            
-            Value headers = Value::makeDictionary();
-            headers.asDictionary().map["Content-Type"] = Value(mime);
-            d["headers"] = headers;
-            
-            d["body"] = Value(body);
-            return resp;
-        }));
-
-    // Database functions
-    static std::unordered_map<int, sqlite3*> dbConnections;
-    static int nextDbHandle = 1;
-
-    // dbOpen(path)
-    interp.defineGlobal("dbOpen", Value::makeNativeFunction("dbOpen", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("dbOpen() expects string path");
-            std::string path = args[0].asString();
-            
-            sqlite3* db;
-            int rc = sqlite3_open(path.c_str(), &db);
-            if (rc != SQLITE_OK) {
-                std::string err = sqlite3_errmsg(db);
-                sqlite3_close(db);
-                throw RuntimeError("sqlite3_open failed: " + err);
-            }
-            
-            int handle = nextDbHandle++;
-            dbConnections[handle] = db;
-            return Value((double)handle);
-        }));
-
-    // dbExec(handle, sql, [params])
-    interp.defineGlobal("dbExec", Value::makeNativeFunction("dbExec", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.size() < 2) throw RuntimeError("dbExec() expects at least 2 arguments");
-            if (!args[0].isNumber()) throw RuntimeError("dbExec() expects number handle");
-            if (!args[1].isString()) throw RuntimeError("dbExec() expects string SQL");
-            
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) {
-                throw RuntimeError("Invalid database handle");
-            }
-            
-            sqlite3* db = dbConnections[handle];
-            sqlite3_stmt* stmt;
-            if (sqlite3_prepare_v2(db, args[1].asString().c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-                throw RuntimeError("sqlite3_prepare_v2 failed: " + std::string(sqlite3_errmsg(db)));
-            }
-            
-            // Bind parameters
-            if (args.size() > 2 && args[2].isArray()) {
-                const auto& params = args[2].asArray();
-                for (int i = 0; i < (int)params.size(); i++) {
-                    const auto& p = params[i];
-                    int idx = i + 1;
-                    if (p.isNil()) sqlite3_bind_null(stmt, idx);
-                    else if (p.isBool()) sqlite3_bind_int(stmt, idx, p.asBool() ? 1 : 0);
-                    else if (p.isNumber()) sqlite3_bind_double(stmt, idx, p.asNumber());
-                    else if (p.isString()) sqlite3_bind_text(stmt, idx, p.asString().c_str(), -1, SQLITE_TRANSIENT);
-                    else sqlite3_bind_text(stmt, idx, p.toString().c_str(), -1, SQLITE_TRANSIENT);
-                }
-            }
-            
-            int rc = sqlite3_step(stmt);
-            sqlite3_finalize(stmt);
-            
-            if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
-                throw RuntimeError("sqlite3_step failed: " + std::string(sqlite3_errmsg(db)));
-            }
-            
-            return Value(true);
-        }));
-
-    // dbQuery(handle, sql, [params])
-    interp.defineGlobal("dbQuery", Value::makeNativeFunction("dbQuery", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.size() < 2) throw RuntimeError("dbQuery() expects at least 2 arguments");
-            if (!args[0].isNumber()) throw RuntimeError("dbQuery() expects number handle");
-            if (!args[1].isString()) throw RuntimeError("dbQuery() expects string SQL");
-            
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) {
-                throw RuntimeError("Invalid database handle");
-            }
-            
-            sqlite3* db = dbConnections[handle];
-            sqlite3_stmt* stmt;
-            if (sqlite3_prepare_v2(db, args[1].asString().c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-                throw RuntimeError("sqlite3_prepare_v2 failed: " + std::string(sqlite3_errmsg(db)));
-            }
-            
-            // Bind parameters
-            if (args.size() > 2 && args[2].isArray()) {
-                const auto& params = args[2].asArray();
-                for (int i = 0; i < (int)params.size(); i++) {
-                    const auto& p = params[i];
-                    int idx = i + 1;
-                    if (p.isNil()) sqlite3_bind_null(stmt, idx);
-                    else if (p.isBool()) sqlite3_bind_int(stmt, idx, p.asBool() ? 1 : 0);
-                    else if (p.isNumber()) sqlite3_bind_double(stmt, idx, p.asNumber());
-                    else if (p.isString()) sqlite3_bind_text(stmt, idx, p.asString().c_str(), -1, SQLITE_TRANSIENT);
-                    else sqlite3_bind_text(stmt, idx, p.toString().c_str(), -1, SQLITE_TRANSIENT);
-                }
-            }
-            
-            std::vector<Value> results;
-            int colCount = sqlite3_column_count(stmt);
-            
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                Value row = Value::makeDictionary();
-                auto& rowMap = row.asDictionary().map;
-                
-                for (int i = 0; i < colCount; i++) {
-                    const char* name = sqlite3_column_name(stmt, i);
-                    std::string colName = name ? name : "col_" + std::to_string(i);
-                    int type = sqlite3_column_type(stmt, i);
-                    
-                    if (type == SQLITE_INTEGER) {
-                        rowMap[colName] = Value((double)sqlite3_column_int64(stmt, i));
-                    } else if (type == SQLITE_FLOAT) {
-                        rowMap[colName] = Value(sqlite3_column_double(stmt, i));
-                    } else if (type == SQLITE_TEXT) {
-                        const char* text = (const char*)sqlite3_column_text(stmt, i);
-                        rowMap[colName] = Value(text ? text : "");
-                    } else if (type == SQLITE_NULL) {
-                        rowMap[colName] = Value();
-                    } else {
-                        const char* text = (const char*)sqlite3_column_text(stmt, i);
-                        rowMap[colName] = Value(text ? text : "");
-                    }
-                }
-                results.push_back(row);
-            }
-            
-            sqlite3_finalize(stmt);
-            return Value::makeArray(results);
-        }));
-
-    // dbClose(handle)
-    interp.defineGlobal("dbClose", Value::makeNativeFunction("dbClose", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("dbClose() expects number handle");
-            
-            int handle = (int)args[0].asNumber();
-            auto it = dbConnections.find(handle);
-            if (it != dbConnections.end()) {
-                sqlite3_close(it->second);
-                dbConnections.erase(it);
-            }
-            return Value(true);
-        }));
-
-    // dbLastInsertId(handle)
-    interp.defineGlobal("dbLastInsertId", Value::makeNativeFunction("dbLastInsertId", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("dbLastInsertId() expects number handle");
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
-            return Value((double)sqlite3_last_insert_rowid(dbConnections[handle]));
-        }));
-
-    // dbBegin(handle)
-    interp.defineGlobal("dbBegin", Value::makeNativeFunction("dbBegin", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("dbBegin() expects number handle");
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
-            sqlite3_exec(dbConnections[handle], "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
-            return Value(true);
-        }));
-
-    // dbCommit(handle)
-    interp.defineGlobal("dbCommit", Value::makeNativeFunction("dbCommit", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("dbCommit() expects number handle");
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
-            sqlite3_exec(dbConnections[handle], "COMMIT", nullptr, nullptr, nullptr);
-            return Value(true);
-        }));
-
-    // dbRollback(handle)
-    interp.defineGlobal("dbRollback", Value::makeNativeFunction("dbRollback", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("dbRollback() expects number handle");
-            int handle = (int)args[0].asNumber();
-            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
-            sqlite3_exec(dbConnections[handle], "ROLLBACK", nullptr, nullptr, nullptr);
-            return Value(true);
-        }));
-
-    // ord(str) - returns ASCII value of first char
-    interp.defineGlobal("ord", Value::makeNativeFunction("ord", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("ord() expects string");
-            std::string s = args[0].asString();
-            if (s.empty()) return Value(0.0);
-            return Value((double)(unsigned char)s[0]);
-        }));
-
-    // chr(num) - returns char from ASCII value
-    interp.defineGlobal("chr", Value::makeNativeFunction("chr", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("chr() expects number");
-            char c = (char)(int)args[0].asNumber();
-            return Value(std::string(1, c));
-        }));
-
-    // xor(a, b) - bitwise XOR
-    interp.defineGlobal("xor", Value::makeNativeFunction("xor", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) throw RuntimeError("xor() expects numbers");
-            int a = (int)args[0].asNumber();
-            int b = (int)args[1].asNumber();
-            return Value((double)(a ^ b));
-        }));
-
-    // substring(str, start, [len])
-    interp.defineGlobal("substring", Value::makeNativeFunction("substring", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.size() < 2 || args.size() > 3) throw RuntimeError("substring() expects 2 or 3 arguments");
-            if (!args[0].isString()) throw RuntimeError("substring() first arg must be string");
-            if (!args[1].isNumber()) throw RuntimeError("substring() start must be number");
-            
-            std::string s = args[0].asString();
-            int start = (int)args[1].asNumber();
-            int len = (args.size() == 3 && args[2].isNumber()) ? (int)args[2].asNumber() : (int)s.length() - start;
-            
-            if (start < 0) start = 0;
-            if (start > (int)s.length()) return Value("");
-            if (len < 0) len = 0;
-            
-            return Value(s.substr(start, len));
-        }));
-
-    // split(str, delimiter)
-    interp.defineGlobal("split", Value::makeNativeFunction("split", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString() || !args[1].isString()) throw RuntimeError("split() expects strings");
-            std::string s = args[0].asString();
-            std::string delim = args[1].asString();
-            std::vector<Value> results;
-            
-            if (delim.empty()) {
-                for (char c : s) results.push_back(Value(std::string(1, c)));
-            } else {
-                size_t start = 0;
-                size_t end = s.find(delim);
-                while (end != std::string::npos) {
-                    results.push_back(Value(s.substr(start, end - start)));
-                    start = end + delim.length();
-                    end = s.find(delim, start);
-                }
-                results.push_back(Value(s.substr(start)));
-            }
-            return Value::makeArray(results);
-        }));
-
-    // join(array, delimiter)
-    interp.defineGlobal("join", Value::makeNativeFunction("join", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) throw RuntimeError("join() expects array as first arg");
-            if (!args[1].isString()) throw RuntimeError("join() expects string delimiter");
-            
-            const auto& arr = args[0].asArray();
-            std::string delim = args[1].asString();
-            std::string result = "";
-            for (size_t i = 0; i < arr.size(); i++) {
-                if (i > 0) result += delim;
-                result += arr[i].toString();
-            }
-            return Value(result);
-        }));
-
-    // push(array, value)
-    interp.defineGlobal("push", Value::makeNativeFunction("push", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) throw RuntimeError("push() expects array");
-            args[0].asArrayPtr()->push_back(args[1]);
-            return args[1];
-        }));
-
-    // pop(array)
-    interp.defineGlobal("pop", Value::makeNativeFunction("pop", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isArray()) throw RuntimeError("pop() expects array");
-            auto arrPtr = args[0].asArrayPtr();
-            if (arrPtr->empty()) return Value();
-            Value val = arrPtr->back();
-            arrPtr->pop_back();
-            return val;
-        }));
-
-    // toLower(str)
-    interp.defineGlobal("toLower", Value::makeNativeFunction("toLower", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("toLower() expects string");
-            std::string s = args[0].asString();
-            for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-            return Value(s);
-        }));
-
-    // toUpper(str)
-    interp.defineGlobal("toUpper", Value::makeNativeFunction("toUpper", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("toUpper() expects string");
-            std::string s = args[0].asString();
-            for (auto& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-            return Value(s);
-        }));
-
-    // typeOf(val)
-    interp.defineGlobal("typeOf", Value::makeNativeFunction("typeOf", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            return Value(args[0].typeName());
-        }));
-
-    // dictRemove(dict, key)
-    interp.defineGlobal("dictRemove", Value::makeNativeFunction("dictRemove", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isDictionary()) throw RuntimeError("dictRemove() expects dictionary");
-            std::string key = args[1].toString();
-            args[0].asDictionaryPtr()->map.erase(key);
-            return args[0];
-        }));
-
-    // --- Added Missing Functions ---
-
-    // stop(ms) - Sleep for specified milliseconds
-    interp.defineGlobal("stop", Value::makeNativeFunction("stop", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("stop() expects number");
-            std::this_thread::sleep_for(std::chrono::milliseconds((int)args[0].asNumber()));
-            return Value();
-        }));
-
-    // parse_json(str) - Convert JSON string to EZ value
-    interp.defineGlobal("parse_json", Value::makeNativeFunction("parse_json", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isString()) throw RuntimeError("parse_json() expects string");
-            MiniJson::Value root;
-            MiniJson::Reader reader;
-            if (!reader.parse(args[0].asString(), root)) {
-                throw RuntimeError("Failed to parse JSON");
-            }
-            
-            std::function<Value(const MiniJson::Value&)> convert;
-            convert = [&](const MiniJson::Value& mv) -> Value {
-                if (mv.type == MiniJson::OBJECT) {
-                    Value dv = Value::makeDictionary();
-                    auto& map = dv.asDictionary().map;
-                    for (const auto& name : mv.getMemberNames()) {
-                        map[name] = convert(mv[name]);
-                    }
-                    return dv;
-                } else if (mv.type == MiniJson::ARRAY) {
-                    std::vector<Value> av;
-                    for (const auto& item : mv.items) av.push_back(convert(item));
-                    return Value::makeArray(av);
-                } else {
-                    std::string s = mv.asString();
-                    if (s == "true") return Value(true);
-                    if (s == "false") return Value(false);
-                    if (s == "null") return Value();
-                    // Try number
-                    if (!s.empty() && (isdigit(s[0]) || s[0] == '-' || s[0] == '.')) {
-                        try {
-                            size_t pos;
-                            double d = std::stod(s, &pos);
-                            if (pos == s.length()) return Value(d);
-                        } catch (...) {}
-                    }
-                    return Value(s);
-                }
-            };
-            return convert(root);
-        }));
-
-    // to_json(val) - Convert EZ value to JSON string
-    interp.defineGlobal("to_json", Value::makeNativeFunction("to_json", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            std::function<MiniJson::Value(const Value&)> convert;
-            convert = [&](const Value& v) -> MiniJson::Value {
-                if (v.isDictionary()) {
-                    MiniJson::Value mv(MiniJson::OBJECT);
-                    for (const auto& kv : v.asDictionary().map) mv[kv.first] = convert(kv.second);
-                    return mv;
-                } else if (v.isArray()) {
-                    MiniJson::Value mv(MiniJson::ARRAY);
-                    for (const auto& item : v.asArray()) mv.append(convert(item));
-                    return mv;
-                } else if (v.isString()) return MiniJson::Value(v.asString());
-                else if (v.isNumber()) {
-                    double d = v.asNumber();
-                    if (d == (int)d) return MiniJson::Value(std::to_string((int)d));
-                    return MiniJson::Value(std::to_string(d));
-                }
-                else if (v.isBool()) return MiniJson::Value(v.asBool() ? "true" : "false");
-                return MiniJson::Value("null");
-            };
-            MiniJson::Value root = convert(args[0]);
-            std::stringstream ss;
-            MiniJson::StreamWriter writer;
-            writer.write(root, &ss);
-            return Value(ss.str());
-        }));
-
-    // --- Terminal Built-ins ---
-
-    // term_clear() - Clears the terminal screen (Windows)
-    interp.defineGlobal("clear", Value::makeNativeFunction("clear", 0,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            system("cls");
-            return Value();
-        }));
-
-    // term_color(code) - Sets terminal text color (Windows)
-    // 0-15: Standard Windows colors
-    interp.defineGlobal("color", Value::makeNativeFunction("color", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber()) throw RuntimeError("color() expects a number code (0-15)");
-            int code = (int)args[0].asNumber();
-            HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-            SetConsoleTextAttribute(hConsole, (WORD)code);
-            return Value();
-        }));
-
-    // term_reset() - Resets terminal color to default
-    interp.defineGlobal("reset", Value::makeNativeFunction("reset", 0,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-            SetConsoleTextAttribute(hConsole, 7); // Default light gray/white
-            return Value();
-        }));
-
-    // gotoxy(x, y) - Moves terminal cursor to coordinates
-    interp.defineGlobal("gotoxy", Value::makeNativeFunction("gotoxy", 2,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (!args[0].isNumber() || !args[1].isNumber()) 
-                throw RuntimeError("gotoxy() expects two numbers (x, y)");
-            int x = (int)args[0].asNumber();
-            int y = (int)args[1].asNumber();
-            HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-            COORD pos = { (SHORT)x, (SHORT)y };
-            SetConsoleCursorPosition(hConsole, pos);
-            return Value();
-        }));
-
-    // getch() - Waits for and returns a single character
-    interp.defineGlobal("getch", Value::makeNativeFunction("getch", 0,
-        [](Interpreter&, const std::vector<Value>&) -> Value {
-            int c = _getch();
-            return Value(std::string(1, (char)c));
-        }));
-
-    // url_encode(str)
-    static int curl_init_checker = []() { curl_global_init(CURL_GLOBAL_DEFAULT); return 0; }();
-    (void)curl_init_checker;
-    interp.defineGlobal("url_encode", Value::makeNativeFunction("url_encode", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            std::string s = args[0].toString();
-            CURL* curl = curl_easy_init();
-            char* output = curl_easy_escape(curl, s.c_str(), (int)s.length());
-            std::string res(output);
-            curl_free(output);
-            curl_easy_cleanup(curl);
-            return Value(res);
-        }));
-
-    // url_decode(str)
-    interp.defineGlobal("url_decode", Value::makeNativeFunction("url_decode", 1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            std::string s = args[0].toString();
-            CURL* curl = curl_easy_init();
-            int outlen;
-            char* output = curl_easy_unescape(curl, s.c_str(), (int)s.length(), &outlen);
-            std::string res(output, outlen);
-            curl_free(output);
-            curl_easy_cleanup(curl);
-            return Value(res);
-        }));
-
-    // HTTP Helpers
-    static auto HttpWriteCallback = [](void* contents, size_t size, size_t nmemb, void* userp) -> size_t {
-        ((std::string*)userp)->append((char*)contents, size * nmemb);
-        return size * nmemb;
-    };
-
-    // http_get(url, [headers])
-    interp.defineGlobal("http_get", Value::makeNativeFunction("http_get", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.empty()) throw RuntimeError("http_get() expects URL");
-            std::string url = args[0].toString();
-            CURL* curl = curl_easy_init();
-            if (!curl) throw RuntimeError("CURL init failed");
-            std::string res;
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))HttpWriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res);
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            struct curl_slist* headers = nullptr;
-            if (args.size() > 1 && args[1].isDictionary()) {
-                for (auto& kv : args[1].asDictionary().map) {
-                    std::string h = kv.first + ": " + kv.second.toString();
-                    headers = curl_slist_append(headers, h.c_str());
-                }
-                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            }
-            CURLcode code = curl_easy_perform(curl);
-            if (headers) curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
-            if (code != CURLE_OK) throw RuntimeError("http_get failed: " + std::string(curl_easy_strerror(code)));
-            return Value(res);
-        }));
-
-    // http_post(url, body, [headers])
-    interp.defineGlobal("http_post", Value::makeNativeFunction("http_post", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.size() < 2) throw RuntimeError("http_post() expects URL and body");
-            std::string url = args[0].toString();
-            std::string body = args[1].toString();
-            CURL* curl = curl_easy_init();
-            if (!curl) throw RuntimeError("CURL init failed");
-            std::string res;
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))HttpWriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res);
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L); // Bypass for local environments
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L); // 30 second timeout
-            
-            struct curl_slist* headers = nullptr;
-            bool hasCT = false;
-            if (args.size() > 2 && args[2].isDictionary()) {
-                for (auto& kv : args[2].asDictionary().map) {
-                    std::string k = kv.first;
-                    std::string h = k + ": " + kv.second.toString();
-                    headers = curl_slist_append(headers, h.c_str());
-                    if (k == "Content-Type") hasCT = true;
-                }
-            }
-            if (!hasCT && !body.empty() && (body[0] == '{' || body[0] == '[')) {
-                headers = curl_slist_append(headers, "Content-Type: application/json");
-            }
-            if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            CURLcode code = curl_easy_perform(curl);
-            if (headers) curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
-            if (code != CURLE_OK) throw RuntimeError("http_post failed: " + std::string(curl_easy_strerror(code)));
-            return Value(res);
-        }));
-
-    // Database Aliases
-    auto globalEnv = interp.getGlobalEnv();
-    interp.defineGlobal("db_open", globalEnv->get("dbOpen", 0));
-    interp.defineGlobal("db_execute", globalEnv->get("dbExec", 0));
-    interp.defineGlobal("db_query", globalEnv->get("dbQuery", 0));
-    interp.defineGlobal("db_close", globalEnv->get("dbClose", 0));
-    interp.defineGlobal("db_last_insert_id", globalEnv->get("dbLastInsertId", 0));
-    interp.defineGlobal("db_begin", globalEnv->get("dbBegin", 0));
-    interp.defineGlobal("db_commit", globalEnv->get("dbCommit", 0));
-    interp.defineGlobal("db_rollback", globalEnv->get("dbRollback", 0));
-    // --- Async / Multithreading ---
-
-    // spawn(fn, args...)
-    interp.defineGlobal("spawn", Value::makeNativeFunction("spawn", -1,
-        [](Interpreter& parentInterp, const std::vector<Value>& args) -> Value {
-            if (args.empty() || !args[0].isCallable()) throw RuntimeError("spawn() expects function");
-            
-            Value func = args[0];
-            std::vector<Value> fnArgs(args.begin() + 1, args.end());
-            auto globalEnv = parentInterp.getGlobalEnv();
-            
-            // Launch async task
-            std::shared_future<Value> fut = std::async(std::launch::async, 
-                [globalEnv, func, fnArgs]() -> Value {
-                    Interpreter threadInterp;
-                    threadInterp.setGlobalEnv(globalEnv);
-                    return threadInterp.callFunction(func, fnArgs, 0);
-                }).share();
-                
-            return Value::makeFuture(fut);
-        }));
-
-    // await(future)
-    auto awaitFn = [](Interpreter&, const std::vector<Value>& args) -> Value {
-        if (!args[0].isFuture()) throw RuntimeError("await() expects future");
-        auto fut = args[0].asFuture();
-        fut->wait();
-        return fut->get();
-    };
-    interp.defineGlobal("await", Value::makeNativeFunction("await", 1, awaitFn));
-    interp.defineGlobal("sync", Value::makeNativeFunction("sync", 1, awaitFn));
-
-    // fetch(url, [options])
-    interp.defineGlobal("fetch", Value::makeNativeFunction("fetch", -1,
-        [](Interpreter&, const std::vector<Value>& args) -> Value {
-            if (args.empty()) throw RuntimeError("fetch() expects URL");
-            std::string url = args[0].toString();
-            Value options;
-            if (args.size() > 1) options = args[1];
-            
-            // Capture args by value for thread
-            std::shared_future<Value> fut = std::async(std::launch::async, 
-                [url, options]() -> Value {
-                    CURL* curl = curl_easy_init();
-                    if (!curl) throw RuntimeError("CURL init failed");
-                    
-                    std::string response;
-                    std::string method = "GET";
-                    std::string body;
-                    struct curl_slist* headers = nullptr;
-                    
-                    if (options.isDictionary()) {
-                        const auto& opts = options.asDictionary().map;
-                        if (opts.count("method")) method = opts.at("method").toString();
-                        if (opts.count("body")) body = opts.at("body").toString();
-                        if (opts.count("headers") && opts.at("headers").isDictionary()) {
-                            for (const auto& kv : opts.at("headers").asDictionary().map) {
-                                std::string h = kv.first + ": " + kv.second.toString();
-                                headers = curl_slist_append(headers, h.c_str());
-                            }
-                        }
-                    }
-                    
-                    auto writeCb = [](void* contents, size_t size, size_t nmemb, void* userp) -> size_t {
-                        ((std::string*)userp)->append((char*)contents, size * nmemb);
-                        return size * nmemb;
-                    };
-
-                    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-                    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))writeCb);
-                    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-                    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-                    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-                    
-                    if (method == "POST") {
-                        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-                        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-                    } else if (method != "GET") {
-                        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
-                    }
-                    
-                    if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-                    
-                    CURLcode res = curl_easy_perform(curl);
-                    if (headers) curl_slist_free_all(headers);
-                    curl_easy_cleanup(curl);
-                    
-                    if (res != CURLE_OK) {
-                         throw RuntimeError("Fetch failed: " + std::string(curl_easy_strerror(res)));
-                    }
-                    
-                    return Value(response);
-                }).share();
-                
-            return Value::makeFuture(fut);
-        }));
-
-}
+#include "Builtins.h"
+#include "Interpreter.h"
+#include <iostream>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include "MiniJson.h"
+#include "Json.h"
+#include "Simd.h"
+#include "MappedFile.h"
+#include "Output.h"
+#include "Trace.h"
+#include "Memory.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "Platform.h"
+
+
+#include <sqlite3.h>
+#include <chrono>
+#ifndef EZ_NO_CURL
+#include <curl/curl.h>
+#endif
+#include <thread>
+#include <future>
+
+// IntArray(n)/FloatArray(n) past this many elements is a mistake, not a request
+static constexpr size_t MAX_TYPED_LENGTH = size_t(1) << 32;
+// histogram() bin counts stay within what the SIMD kernels index
+static constexpr size_t MAX_HISTOGRAM_BINS = size_t(1) << 24;
+
+static void throwNotInt(const std::string& fn) {
+    throw RuntimeError(fn + "() IntArray elements must be finite numbers within the 64-bit integer range");
+}
+
+// Builds a FloatArray/IntArray from a length, a plain array of numbers or another typed array
+static Value makeTypedArray(EZTypedArray::Kind kind, const Value& src, const std::string& fn) {
+    if (src.isNumber()) {
+        double n = src.asNumber();
+        if (!(n >= 0)) throw RuntimeError(fn + "() length must be a non-negative number");
+        if (n > static_cast<double>(MAX_TYPED_LENGTH)) {
+            throw RuntimeError(fn + "() length " + Value(n).toString() + " is too large");
+        }
+        Interpreter::checkHeapLimit(static_cast<uint64_t>(n) * sizeof(double));
+        return Value(memory::make<EZTypedArray>(kind, static_cast<size_t>(n)));
+    }
+    if (src.isArray()) {
+        const auto& arr = src.asArray();
+        Interpreter::checkHeapLimit(arr.size() * sizeof(double));
+        auto ta = memory::make<EZTypedArray>(kind, arr.size());
+        for (size_t i = 0; i < arr.size(); i++) {
+            if (!arr[i].isNumber()) throw RuntimeError(fn + "() expects an array of numbers");
+            if (!ta->set(i, arr[i].asNumber())) throwNotInt(fn);
+        }
+        return Value(ta);
+    }
+    if (src.isRange()) {
+        const EZRange& range = *src.asRange();
+        Interpreter::checkHeapLimit(range.size() * sizeof(double));
+        auto ta = memory::make<EZTypedArray>(kind, range.size());
+        for (size_t i = 0; i < range.size(); i++) ta->set(i, range.at(i));
+        return Value(ta);
+    }
+    if (src.isTypedArray()) {
+        const EZTypedArray& from = *src.asTypedArray();
+        Interpreter::checkHeapLimit(from.size() * sizeof(double));
+        auto ta = memory::make<EZTypedArray>(kind);
+        if (kind == EZTypedArray::Kind::FLOAT) {
+            if (from.isFloat()) ta->floats = from.floats;
+            else ta->floats.assign(from.ints.begin(), from.ints.end());
+        } else {
+            if (from.isFloat()) {
+                ta->ints.resize(from.floats.size());
+                for (size_t i = 0; i < from.floats.size(); i++) {
+                    if (!EZTypedArray::fitsInt(from.floats[i])) throwNotInt(fn);
+                    ta->ints[i] = static_cast<int64_t>(from.floats[i]);
+                }
+            } else {
+                ta->ints = from.ints;
+            }
+        }
+        return Value(ta);
+    }
+    throw RuntimeError(fn + "() expects a length, an array, a range or a typed array");
+}
+
+static const EZTypedArray& expectTypedArray(const Value& v, const std::string& fn) {
+    if (!v.isTypedArray()) throw RuntimeError(fn + "() expects FloatArray or IntArray");
+    return *v.asTypedArray();
+}
+
+// Smallest or largest element of an array or typed array
+static Value reduceMinMax(const Value& v, bool wantMax, const std::string& fn) {
+    if (v.isTypedArray()) {
+        const EZTypedArray& ta = *v.asTypedArray();
+        if (ta.size() == 0) throw RuntimeError(fn + "() of an empty array");
+        if (ta.isFloat()) {
+            double lo, hi;
+            simd::minMax(ta.floats.data(), ta.floats.size(), lo, hi);
+            return Value(wantMax ? hi : lo);
+        }
+        int64_t lo, hi;
+        simd::minMax(ta.ints.data(), ta.ints.size(), lo, hi);
+        return Value(static_cast<double>(wantMax ? hi : lo));
+    }
+    if (v.isArray()) {
+        const auto& arr = v.asArray();
+        if (arr.empty()) throw RuntimeError(fn + "() of an empty array");
+        double best = 0;
+        for (size_t i = 0; i < arr.size(); i++) {
+            if (!arr[i].isNumber()) throw RuntimeError(fn + "() expects an array of numbers");
+            double d = arr[i].asNumber();
+            if (i == 0 || (wantMax ? d > best : d < best)) best = d;
+        }
+        return Value(best);
+    }
+    throw RuntimeError(fn + "() expects two numbers or an array");
+}
+
+static void checkReadable(const EZFile& file, const std::string& fn) {
+    if (!file.isOpen()) throw RuntimeError(fn + "(): file '" + file.path + "' is closed");
+    if (!file.canRead()) throw RuntimeError(fn + "(): file '" + file.path + "' is not open for reading");
+}
+
+static void checkWritable(const EZFile& file, const std::string& fn) {
+    if (!file.isOpen()) throw RuntimeError(fn + "(): file '" + file.path + "' is closed");
+    if (!file.canWrite()) throw RuntimeError(fn + "(): file '" + file.path + "' is not open for writing");
+}
+
+// Buffered write to an open handle; a short write (disk full, I/O error) is an error
+static void writeChecked(EZFile& file, const char* data, size_t len, const char* fn) {
+    if (!file.write(data, len)) {
+        throw RuntimeError(std::string(fn) + "(): could not write to '" + file.path + "': " + std::strerror(errno));
+    }
+}
+
+// Binds db_execute/db_query parameters. Whole numbers bind as integers, so
+// INTEGER columns get integers and TEXT columns get "42" rather than "42.0"
+static void bindParams(sqlite3_stmt* stmt, const std::vector<Value>& params) {
+    for (int i = 0; i < (int)params.size(); i++) {
+        const auto& p = params[i];
+        int idx = i + 1;
+        if (p.isNil()) sqlite3_bind_null(stmt, idx);
+        else if (p.isBool()) sqlite3_bind_int(stmt, idx, p.asBool() ? 1 : 0);
+        else if (p.isNumber()) {
+            double d = p.asNumber();
+            if (d == std::trunc(d) && std::fabs(d) < MAX_EXACT_INTEGER) sqlite3_bind_int64(stmt, idx, static_cast<sqlite3_int64>(d));
+            else sqlite3_bind_double(stmt, idx, d);
+        } else if (p.isString()) {
+            std::string_view text = p.asStringView();
+            sqlite3_bind_text(stmt, idx, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+        } else {
+            sqlite3_bind_text(stmt, idx, p.toString().c_str(), -1, SQLITE_TRANSIENT);
+        }
+    }
+}
+
+// Shared by join() and its later redefinition. Numbers and strings are
+// appended in place instead of through a temporary toString()
+static Value joinValues(const std::vector<Value>& arr, std::string_view delim) {
+    std::string result;
+    for (size_t i = 0; i < arr.size(); i++) {
+        if (i > 0) result += delim;
+        const Value& v = arr[i];
+        if (v.isNumber()) appendNumber(result, v.asNumber());
+        else if (v.isString()) result += v.asStringView();
+        else result += v.toString();
+    }
+    return Value(std::move(result));
+}
+
+// Ranges are read-only sequences. The array builtins that only read their
+// argument take one too and work on elements [from, to) copied out here
+static std::vector<Value> rangeElements(const EZRange& range, size_t from, size_t to) {
+    std::vector<Value> result;
+    Interpreter::checkHeapLimit((to > from ? to - from : 0) * sizeof(Value));
+    result.reserve(to > from ? to - from : 0);
+    for (size_t i = from; i < to; i++) result.emplace_back(range.at(i));
+    return result;
+}
+
+static std::vector<Value> rangeElements(const EZRange& range) {
+    return rangeElements(range, 0, range.size());
+}
+
+static RuntimeError rangeIsReadOnly(const std::string& fn) {
+    return RuntimeError(fn + "() cannot change a range; toArray(range) makes an array that can");
+}
+
+// Shared by split() and its later redefinition. Delimiter positions are found
+// with the SIMD kernels, and the pieces are slices of the input
+static Value splitString(const Value::StringPtr& input, std::string_view delim) {
+    const EZString& str = *input;
+    std::vector<Value> result;
+    if (delim.empty()) {
+        Interpreter::checkHeapLimit(str.size() * sizeof(Value));
+        result.reserve(str.size());
+        for (size_t i = 0; i < str.size(); i++) {
+            result.push_back(Value(EZString::ofChar(static_cast<unsigned char>(str.data()[i]))));
+        }
+        return Value::makeArray(result);
+    }
+
+    std::vector<size_t> positions;
+    if (delim.size() == 1) {
+        // Counting first sizes the position list and lets --max-heap refuse
+        // a split that would not fit before anything is allocated
+        size_t count = static_cast<size_t>(std::count(str.data(), str.data() + str.size(), delim[0]));
+        Interpreter::checkHeapLimit(count * (sizeof(size_t) + sizeof(Value)));
+        positions.reserve(count);
+        simd::splitByte(str.data(), str.size(), delim[0], positions);
+    } else {
+        for (size_t pos = simd::find(str.data(), str.size(), delim.data(), delim.size());
+             pos != simd::NPOS;
+             pos = simd::find(str.data(), str.size(), delim.data(), delim.size(), pos + delim.size())) {
+            Interpreter::checkHeapLimit();
+            positions.push_back(pos);
+        }
+    }
+
+    auto piece = [&](size_t from, size_t length) {
+        return Value(length == 0 ? memory::make<EZString>() : EZString::slice(input, from, length));
+    };
+    Interpreter::checkHeapLimit((positions.size() + 1) * sizeof(Value));
+    result.reserve(positions.size() + 1);
+    size_t start = 0;
+    for (size_t pos : positions) {
+        Interpreter::checkHeapLimit();
+        result.push_back(piece(start, pos - start));
+        start = pos + delim.size();
+    }
+    result.push_back(piece(start, str.size() - start));
+    return Value::makeArray(result);
+}
+
+// `length` bytes from `start`, clamped to the string like std::string::substr
+static Value substringOf(const Value::StringPtr& s, int start, int length) {
+    if (start < 0) start = 0;
+    if (start >= static_cast<int>(s->size()) || length <= 0) return Value("");
+    size_t len = std::min(static_cast<size_t>(length), s->size() - start);
+    return Value(EZString::slice(s, start, len));
+}
+
+static Value caseMapped(std::string_view str, bool upper) {
+    std::string out(str.size(), '\0');
+    if (upper) {
+        simd::toUpperAscii(str.data(), &out[0], str.size());
+    } else {
+        simd::toLowerAscii(str.data(), &out[0], str.size());
+    }
+    return Value(std::move(out));
+}
+
+void registerBuiltins(Interpreter& interp) {
+    // clock() - returns milliseconds since epoch
+    interp.defineGlobal("clock", Value::makeNativeFunction("clock", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            auto now = std::chrono::system_clock::now();
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now.time_since_epoch()
+            ).count();
+            return Value((double)ms);
+        }));
+
+    // memstats() - heap and per-kind object counts for the whole process
+    interp.defineGlobal("memstats", Value::makeNativeFunction("memstats", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            memory::Snapshot snap = memory::snapshot();
+            auto totals = [](const memory::Totals& t) {
+                Value d = Value::makeDictionary();
+                auto& map = d.asDictionary().map;
+                map["live"] = Value(static_cast<double>(t.live()));
+                map["live_bytes"] = Value(static_cast<double>(t.liveBytes()));
+                map["total"] = Value(static_cast<double>(t.allocations));
+                map["total_bytes"] = Value(static_cast<double>(t.bytes));
+                return d;
+            };
+            Value result = Value::makeDictionary();
+            auto& map = result.asDictionary().map;
+            map["heap"] = totals(snap.heap);
+            map["heap"].asDictionary().map["limit"] = Value(static_cast<double>(memory::heapLimit()));
+            for (size_t k = 0; k < memory::KINDS; k++) {
+                map[memory::kindName(static_cast<memory::Kind>(k))] = totals(snap.kinds[k]);
+            }
+            return result;
+        }));
+
+    // log(level, msg, [fields]) - structured record, written by a background thread
+    interp.defineGlobal("log", Value::makeNativeFunction("log", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2 || args.size() > 3) throw RuntimeError("log() expects 2 or 3 arguments");
+            Logger::Level level;
+            if (!args[0].isString() || !Logger::parseLevel(args[0].asStringView(), level) || level == Logger::Level::OFF) {
+                throw RuntimeError("log() level must be \"debug\", \"info\", \"warn\" or \"error\"");
+            }
+            Logger& logger = Logger::instance();
+            if (!logger.wants(level)) return Value();
+            const Value* fields = nullptr;
+            if (args.size() > 2 && !args[2].isNil()) {
+                if (!args[2].isDictionary()) throw RuntimeError("log() fields must be a dictionary");
+                fields = &args[2];
+            }
+            if (args[1].isString()) {
+                logger.log(level, args[1].asStringView(), fields);
+            } else {
+                logger.log(level, args[1].toString(), fields);
+            }
+            return Value();
+        }));
+
+    // logConfig(options) - level, format ("json"/"logfmt"), file, max_size, keep
+    interp.defineGlobal("logConfig", Value::makeNativeFunction("logConfig", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isDictionary()) throw RuntimeError("logConfig() expects a dictionary");
+            Logger::Options options = Logger::instance().options();
+            for (const auto& kv : args[0].asDictionary().map) {
+                const std::string& key = kv.first;
+                const Value& v = kv.second;
+                if (key == "level") {
+                    if (!v.isString() || !Logger::parseLevel(v.asStringView(), options.level)) {
+                        throw RuntimeError("logConfig() level must be \"debug\", \"info\", \"warn\", \"error\" or \"off\"");
+                    }
+                } else if (key == "format") {
+                    if (v.isString() && v.asStringView() == "json") options.format = Logger::Format::JSON;
+                    else if (v.isString() && v.asStringView() == "logfmt") options.format = Logger::Format::LOGFMT;
+                    else throw RuntimeError("logConfig() format must be \"json\" or \"logfmt\"");
+                } else if (key == "file") {
+                    if (!v.isString()) throw RuntimeError("logConfig() file must be a string path");
+                    options.path = v.asString();
+                } else if (key == "max_size") {
+                    if (v.isNumber() && v.asNumber() >= 0) options.maxBytes = static_cast<uint64_t>(v.asNumber());
+                    else if (!v.isString() || !memory::parseSize(v.asString().c_str(), options.maxBytes)) {
+                        throw RuntimeError("logConfig() max_size must be a byte count such as 10485760 or \"10M\"");
+                    }
+                } else if (key == "keep") {
+                    if (!v.isNumber() || v.asNumber() < 0) throw RuntimeError("logConfig() keep must be a non-negative number");
+                    options.keep = static_cast<int>(v.asNumber());
+                } else {
+                    throw RuntimeError("logConfig() unknown option '" + key + "'");
+                }
+            }
+            Logger::instance().configure(options);
+            return Value();
+        }));
+
+    // logStats() - records written, dropped (ring full) and file rotations
+    interp.defineGlobal("logStats", Value::makeNativeFunction("logStats", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            Logger::instance().flush();
+            Logger& logger = Logger::instance();
+            Value result = Value::makeDictionary();
+            auto& map = result.asDictionary().map;
+            map["written"] = Value(static_cast<double>(logger.written()));
+            map["dropped"] = Value(static_cast<double>(logger.dropped()));
+            map["rotations"] = Value(static_cast<double>(logger.rotations()));
+            return result;
+        }));
+
+    // Input function
+    interp.defineGlobal("__input__", Value::makeNativeFunction("input", 0, 
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            Output::instance().flush();
+            std::string line;
+            std::getline(std::cin, line);
+            return Value(line);
+        }));
+    
+    // len(x) - length of string or array
+    interp.defineGlobal("len", Value::makeNativeFunction("len", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isString()) {
+                return Value(static_cast<double>(args[0].asStringPtr()->size()));
+            }
+            if (args[0].isArray()) {
+                return Value(static_cast<double>(args[0].asArray().size()));
+            }
+            if (args[0].isDictionary()) {
+                return Value(static_cast<double>(args[0].asDictionary().map.size()));
+            }
+            if (args[0].isStringBuilder()) {
+                return Value(static_cast<double>(args[0].asStringBuilder()->buffer.length()));
+            }
+            if (args[0].isTypedArray()) {
+                return Value(static_cast<double>(args[0].asTypedArray()->size()));
+            }
+            if (args[0].isRange()) {
+                return Value(static_cast<double>(args[0].asRange()->size()));
+            }
+            throw RuntimeError("len() expects string or array");
+        }));
+    
+    // push(arr, val) - add element to array
+    interp.defineGlobal("push", Value::makeNativeFunction("push", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isRange()) throw rangeIsReadOnly("push");
+            if (!args[0].isArray()) {
+                throw RuntimeError("push() expects array as first argument");
+            }
+            auto arr = args[0].asArrayPtr();
+            arr->push_back(args[1]);
+            return Value(arr);
+        }));
+    
+    // pop(arr) - remove and return last element
+    interp.defineGlobal("pop", Value::makeNativeFunction("pop", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isRange()) throw rangeIsReadOnly("pop");
+            if (!args[0].isArray()) {
+                throw RuntimeError("pop() expects array");
+            }
+            auto& arr = *args[0].asArrayPtr();
+            if (arr.empty()) {
+                throw RuntimeError("pop() on empty array");
+            }
+            Value last = arr.back();
+            arr.pop_back();
+            return last;
+        }));
+    
+    // str(x) - convert to string
+    interp.defineGlobal("str", Value::makeNativeFunction("str", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            return Value(args[0].toString());
+        }));
+    
+    // num(x) - convert to number
+    interp.defineGlobal("num", Value::makeNativeFunction("num", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isNumber()) return args[0];
+            if (args[0].isString()) {
+                double d = 0;
+                if (!parseNumber(args[0].asStringView(), d)) {
+                    throw RuntimeError("Cannot convert '" + args[0].asString() + "' to number");
+                }
+                return Value(d);
+            }
+            if (args[0].isBool()) {
+                return Value(args[0].asBool() ? 1.0 : 0.0);
+            }
+            throw RuntimeError("Cannot convert " + args[0].typeName() + " to number");
+        }));
+    
+    // type(x) - get type name
+    interp.defineGlobal("type", Value::makeNativeFunction("type", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            return Value(args[0].typeName());
+        }));
+    
+    // substr(s, start, len) - get substring
+    interp.defineGlobal("substr", Value::makeNativeFunction("substr", 3,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("substr() expects string as first argument");
+            }
+            if (!args[1].isNumber() || !args[2].isNumber()) {
+                throw RuntimeError("substr() expects numbers for start and length");
+            }
+            return substringOf(args[0].asStringPtr(), static_cast<int>(args[1].asNumber()),
+                               static_cast<int>(args[2].asNumber()));
+        }));
+    
+    // split(s, delim) - split string into array
+    interp.defineGlobal("split", Value::makeNativeFunction("split", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString() || !args[1].isString()) {
+                throw RuntimeError("split() expects two strings");
+            }
+            
+            return splitString(args[0].asStringPtr(), args[1].asStringView());
+        }));
+    
+    // join(arr, delim) - join array into string
+    interp.defineGlobal("join", Value::makeNativeFunction("join", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray() && !args[0].isRange()) {
+                throw RuntimeError("join() expects array as first argument");
+            }
+            if (!args[1].isString()) {
+                throw RuntimeError("join() expects string as delimiter");
+            }
+            
+            if (args[0].isRange()) return joinValues(rangeElements(*args[0].asRange()), args[1].asStringView());
+            return joinValues(args[0].asArray(), args[1].asStringView());
+        }));
+    
+    // floor(x)
+    interp.defineGlobal("floor", Value::makeNativeFunction("floor", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) {
+                throw RuntimeError("floor() expects number");
+            }
+            return Value(std::floor(args[0].asNumber()));
+        }));
+    
+    // ceil(x)
+    interp.defineGlobal("ceil", Value::makeNativeFunction("ceil", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) {
+                throw RuntimeError("ceil() expects number");
+            }
+            return Value(std::ceil(args[0].asNumber()));
+        }));
+    
+    // abs(x)
+    interp.defineGlobal("abs", Value::makeNativeFunction("abs", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) {
+                throw RuntimeError("abs() expects number");
+            }
+            return Value(std::abs(args[0].asNumber()));
+        }));
+    
+    // sqrt(x)
+    interp.defineGlobal("sqrt", Value::makeNativeFunction("sqrt", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) {
+                throw RuntimeError("sqrt() expects number");
+            }
+            double val = args[0].asNumber();
+            if (val < 0) {
+                throw RuntimeError("sqrt() of negative number");
+            }
+            return Value(std::sqrt(val));
+        }));
+    
+    // pow(base, exp)
+    interp.defineGlobal("pow", Value::makeNativeFunction("pow", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber() || !args[1].isNumber()) {
+                throw RuntimeError("pow() expects two numbers");
+            }
+            return Value(std::pow(args[0].asNumber(), args[1].asNumber()));
+        }));
+    
+    // rand() - random number 0-1
+    interp.defineGlobal("rand", Value::makeNativeFunction("rand", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            return Value(static_cast<double>(std::rand()) / RAND_MAX);
+        }));
+    
+    // randint(min, max) - random integer in range
+    interp.defineGlobal("randint", Value::makeNativeFunction("randint", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber() || !args[1].isNumber()) {
+                throw RuntimeError("randint() expects two numbers");
+            }
+            int min = static_cast<int>(args[0].asNumber());
+            int max = static_cast<int>(args[1].asNumber());
+            return Value(static_cast<double>(min + std::rand() % (max - min + 1)));
+        }));
+    
+    // round(x)
+    interp.defineGlobal("round", Value::makeNativeFunction("round", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) {
+                throw RuntimeError("round() expects number");
+            }
+            return Value(std::round(args[0].asNumber()));
+        }));
+    
+    // min(a, b) or min(arr)
+    interp.defineGlobal("min", Value::makeNativeFunction("min", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() == 1) return reduceMinMax(args[0], false, "min");
+            if (args.size() != 2 || !args[0].isNumber() || !args[1].isNumber()) {
+                throw RuntimeError("min() expects two numbers");
+            }
+            return Value(std::min(args[0].asNumber(), args[1].asNumber()));
+        }));
+    
+    // max(a, b) or max(arr)
+    interp.defineGlobal("max", Value::makeNativeFunction("max", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() == 1) return reduceMinMax(args[0], true, "max");
+            if (args.size() != 2 || !args[0].isNumber() || !args[1].isNumber()) {
+                throw RuntimeError("max() expects two numbers");
+            }
+            return Value(std::max(args[0].asNumber(), args[1].asNumber()));
+        }));
+    
+    // --- Typed Arrays ---
+    
+    // FloatArray(n | arr) - packed array of doubles
+    interp.defineGlobal("FloatArray", Value::makeNativeFunction("FloatArray", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            return makeTypedArray(EZTypedArray::Kind::FLOAT, args[0], "FloatArray");
+        }));
+    
+    // IntArray(n | arr) - packed array of 64-bit integers (values are truncated)
+    interp.defineGlobal("IntArray", Value::makeNativeFunction("IntArray", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            return makeTypedArray(EZTypedArray::Kind::INT, args[0], "IntArray");
+        }));
+    
+    // toArray(iterable) - collect a typed array, range or iterator into a plain array
+    interp.defineGlobal("toArray", Value::makeNativeFunction("toArray", 1,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            auto arr = memory::make<Value::ArrayType>();
+            size_t known = args[0].isTypedArray() ? args[0].asTypedArray()->size()
+                         : args[0].isRange()      ? args[0].asRange()->size()
+                                                  : 0;
+            Interpreter::checkHeapLimit(known * sizeof(Value));
+            arr->reserve(known);
+            auto iter = interp.makeIterator(args[0], 0);
+            Value elem;
+            while (iter->next(interp, elem)) {
+                Interpreter::checkHeapLimit();
+                arr->push_back(elem);
+            }
+            return Value(arr);
+        }));
+    
+    // sum(arr) - total of a typed array or an array of numbers
+    interp.defineGlobal("sum", Value::makeNativeFunction("sum", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isTypedArray()) {
+                const EZTypedArray& ta = *args[0].asTypedArray();
+                if (ta.isFloat()) return Value(simd::sum(ta.floats.data(), ta.floats.size()));
+                int64_t total;
+                if (!simd::sum(ta.ints.data(), ta.ints.size(), total)) {
+                    throw RuntimeError("sum() of this IntArray is outside the 64-bit integer range");
+                }
+                return Value(static_cast<double>(total));
+            }
+            if (args[0].isArray()) {
+                double total = 0;
+                for (const auto& item : args[0].asArray()) {
+                    if (!item.isNumber()) throw RuntimeError("sum() expects an array of numbers");
+                    total += item.asNumber();
+                }
+                return Value(total);
+            }
+            throw RuntimeError("sum() expects an array");
+        }));
+    
+    // dot(a, b) - dot product of two typed arrays of the same kind and length
+    interp.defineGlobal("dot", Value::makeNativeFunction("dot", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            const EZTypedArray& a = expectTypedArray(args[0], "dot");
+            const EZTypedArray& b = expectTypedArray(args[1], "dot");
+            if (a.kind != b.kind || a.size() != b.size()) {
+                throw RuntimeError("dot() expects two typed arrays of the same kind and length");
+            }
+            if (a.isFloat()) return Value(simd::dot(a.floats.data(), b.floats.data(), a.size()));
+            int64_t total;
+            if (!simd::dot(a.ints.data(), b.ints.data(), a.size(), total)) {
+                throw RuntimeError("dot() of these IntArrays is outside the 64-bit integer range");
+            }
+            return Value(static_cast<double>(total));
+        }));
+    
+    // scale(a, k) - new typed array with every element multiplied by k
+    interp.defineGlobal("scale", Value::makeNativeFunction("scale", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            const EZTypedArray& a = expectTypedArray(args[0], "scale");
+            if (!args[1].isNumber()) throw RuntimeError("scale() expects a number factor");
+            double k = args[1].asNumber();
+            // An IntArray scaled by a fraction (or by NaN, infinity or a factor
+            // past the 64-bit integer range) becomes a FloatArray
+            if (a.isFloat() || k != std::floor(k) || !EZTypedArray::fitsInt(k)) {
+                Value src = a.isFloat() ? args[0] : makeTypedArray(EZTypedArray::Kind::FLOAT, args[0], "scale");
+                const EZTypedArray& in = *src.asTypedArray();
+                auto out = memory::make<EZTypedArray>(EZTypedArray::Kind::FLOAT, in.size());
+                simd::scale(in.floats.data(), k, out->floats.data(), in.size());
+                return Value(out);
+            }
+            auto out = memory::make<EZTypedArray>(EZTypedArray::Kind::INT, a.size());
+            if (!simd::scale(a.ints.data(), static_cast<int64_t>(k), out->ints.data(), a.size())) {
+                throw RuntimeError("scale() result is outside the 64-bit integer range");
+            }
+            return Value(out);
+        }));
+    
+    // add(a, b) - element-wise sum of two typed arrays of the same kind and length
+    interp.defineGlobal("add", Value::makeNativeFunction("add", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            const EZTypedArray& a = expectTypedArray(args[0], "add");
+            const EZTypedArray& b = expectTypedArray(args[1], "add");
+            if (a.kind != b.kind || a.size() != b.size()) {
+                throw RuntimeError("add() expects two typed arrays of the same kind and length");
+            }
+            auto out = memory::make<EZTypedArray>(a.kind, a.size());
+            if (a.isFloat()) simd::add(a.floats.data(), b.floats.data(), out->floats.data(), a.size());
+            else if (!simd::add(a.ints.data(), b.ints.data(), out->ints.data(), a.size())) {
+                throw RuntimeError("add() result is outside the 64-bit integer range");
+            }
+            return Value(out);
+        }));
+    
+    // prefixSum(a) - running totals, same kind as a
+    interp.defineGlobal("prefixSum", Value::makeNativeFunction("prefixSum", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            const EZTypedArray& a = expectTypedArray(args[0], "prefixSum");
+            auto out = memory::make<EZTypedArray>(a.kind, a.size());
+            if (a.isFloat()) simd::prefixSum(a.floats.data(), out->floats.data(), a.size());
+            else if (!simd::prefixSum(a.ints.data(), out->ints.data(), a.size())) {
+                throw RuntimeError("prefixSum() result is outside the 64-bit integer range");
+            }
+            return Value(out);
+        }));
+    
+    // argsort(a) - IntArray of indices that would sort a (stable)
+    interp.defineGlobal("argsort", Value::makeNativeFunction("argsort", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            const EZTypedArray& a = expectTypedArray(args[0], "argsort");
+            auto out = memory::make<EZTypedArray>(EZTypedArray::Kind::INT, a.size());
+            auto& idx = out->ints;
+            for (size_t i = 0; i < idx.size(); i++) idx[i] = static_cast<int64_t>(i);
+            if (a.isFloat()) {
+                const double* d = a.floats.data();
+                std::stable_sort(idx.begin(), idx.end(), [d](int64_t x, int64_t y) { return d[x] < d[y]; });
+            } else {
+                const int64_t* d = a.ints.data();
+                std::stable_sort(idx.begin(), idx.end(), [d](int64_t x, int64_t y) { return d[x] < d[y]; });
+            }
+            return Value(out);
+        }));
+    
+    // histogram(a, bins, [lo, hi]) - IntArray of bucket counts; range defaults to min..max
+    interp.defineGlobal("histogram", Value::makeNativeFunction("histogram", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() != 2 && args.size() != 4) {
+                throw RuntimeError("histogram() expects (array, bins) or (array, bins, lo, hi)");
+            }
+            Value src = args[0].isTypedArray() && args[0].asTypedArray()->isFloat()
+                ? args[0] : makeTypedArray(EZTypedArray::Kind::FLOAT, args[0], "histogram");
+            const EZTypedArray& a = *src.asTypedArray();
+            if (!args[1].isNumber() || !(args[1].asNumber() >= 1 && args[1].asNumber() <= MAX_HISTOGRAM_BINS)) {
+                throw RuntimeError("histogram() expects a bin count from 1 to " + std::to_string(MAX_HISTOGRAM_BINS));
+            }
+            size_t bins = static_cast<size_t>(args[1].asNumber());
+            double lo = 0, hi = 0;
+            if (args.size() == 4) {
+                if (!args[2].isNumber() || !args[3].isNumber()) throw RuntimeError("histogram() range must be numbers");
+                lo = args[2].asNumber();
+                hi = args[3].asNumber();
+            } else if (a.size() > 0) {
+                simd::minMax(a.floats.data(), a.size(), lo, hi);
+            }
+            if (!std::isfinite(lo) || !std::isfinite(hi)) {
+                throw RuntimeError("histogram() range must be finite; pass lo and hi when the data holds NaN or infinity");
+            }
+            auto out = memory::make<EZTypedArray>(EZTypedArray::Kind::INT, bins);
+            if (hi > lo) {
+                simd::histogram(a.floats.data(), a.size(), lo, hi, bins, out->ints.data());
+            } else if (a.size() > 0 && args.size() == 2) {
+                out->ints[0] = static_cast<int64_t>(a.size());  // every value is the same
+            }
+            return Value(out);
+        }));
+    
+    // contains(str/arr, item) - check if string/array contains item
+    interp.defineGlobal("contains", Value::makeNativeFunction("contains", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isString()) {
+                if (!args[1].isString()) {
+                    throw RuntimeError("contains() with string expects string to search for");
+                }
+                std::string_view hay = args[0].asStringView();
+                std::string_view needle = args[1].asStringView();
+                return Value(simd::find(hay.data(), hay.size(), needle.data(), needle.size()) != simd::NPOS);
+            }
+            if (args[0].isArray()) {
+                const auto& arr = args[0].asArray();
+                for (const auto& elem : arr) {
+                    if (elem.equals(args[1])) {
+                        return Value(true);
+                    }
+                }
+                return Value(false);
+            }
+            if (args[0].isRange()) {
+                return Value(args[1].isNumber() && args[0].asRange()->contains(args[1].asNumber()));
+            }
+            if (args[0].isDictionary()) {
+                std::string key = args[1].toString();
+                const auto& dict = args[0].asDictionary();
+                return Value(dict.map.find(key) != dict.map.end());
+            }
+            throw RuntimeError("contains() expects string, array, range or dictionary");
+        }));
+    
+    // indexOf(str/arr, item) - find index of item
+    interp.defineGlobal("indexOf", Value::makeNativeFunction("indexOf", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isString()) {
+                if (!args[1].isString()) {
+                    throw RuntimeError("indexOf() with string expects string to search for");
+                }
+                std::string_view hay = args[0].asStringView();
+                std::string_view needle = args[1].asStringView();
+                size_t pos = simd::find(hay.data(), hay.size(), needle.data(), needle.size());
+                if (pos == simd::NPOS) return Value(-1.0);
+                return Value(static_cast<double>(pos));
+            }
+            if (args[0].isArray()) {
+                const auto& arr = args[0].asArray();
+                for (size_t i = 0; i < arr.size(); i++) {
+                    if (arr[i].equals(args[1])) {
+                        return Value(static_cast<double>(i));
+                    }
+                }
+                return Value(-1.0);
+            }
+            if (args[0].isRange()) {
+                const EZRange& range = *args[0].asRange();
+                if (!args[1].isNumber() || !range.contains(args[1].asNumber())) return Value(-1.0);
+                return Value(static_cast<double>((static_cast<int64_t>(args[1].asNumber()) - range.start) / range.step));
+            }
+            throw RuntimeError("indexOf() expects string, array or range");
+        }));
+    
+    // reverse(arr/str) - reverse array or string
+    interp.defineGlobal("reverse", Value::makeNativeFunction("reverse", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isString()) {
+                std::string s(args[0].asStringView());
+                std::reverse(s.begin(), s.end());
+                return Value(s);
+            }
+            if (args[0].isArray()) {
+                auto arr = args[0].asArray();
+                std::reverse(arr.begin(), arr.end());
+                return Value::makeArray(arr);
+            }
+            if (args[0].isRange()) {
+                auto arr = rangeElements(*args[0].asRange());
+                std::reverse(arr.begin(), arr.end());
+                return Value::makeArray(arr);
+            }
+            throw RuntimeError("reverse() expects string, array or range");
+        }));
+    
+    // sort(arr) - sort array
+    interp.defineGlobal("sort", Value::makeNativeFunction("sort", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray() && !args[0].isRange()) {
+                throw RuntimeError("sort() expects array or range");
+            }
+            auto arr = args[0].isRange() ? rangeElements(*args[0].asRange()) : args[0].asArray();
+            std::sort(arr.begin(), arr.end(), [](const Value& a, const Value& b) {
+                if (a.isNumber() && b.isNumber()) {
+                    return a.asNumber() < b.asNumber();
+                }
+                if (a.isString() && b.isString()) return a.asStringView() < b.asStringView();
+                return a.toString() < b.toString();
+            });
+            return Value::makeArray(arr);
+        }));
+    
+    // upper(str) - uppercase
+    interp.defineGlobal("upper", Value::makeNativeFunction("upper", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("upper() expects string");
+            }
+            return caseMapped(args[0].asStringView(), true);
+        }));
+    
+    // lower(str) - lowercase
+    interp.defineGlobal("lower", Value::makeNativeFunction("lower", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("lower() expects string");
+            }
+            return caseMapped(args[0].asStringView(), false);
+        }));
+    
+    // trim(str) - trim whitespace
+    interp.defineGlobal("trim", Value::makeNativeFunction("trim", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("trim() expects string");
+            }
+            const auto& s = args[0].asStringPtr();
+            size_t begin, end;
+            simd::trimBounds(s->data(), s->size(), begin, end);
+            if (begin == end) return Value("");
+            return Value(EZString::slice(s, begin, end - begin));
+        }));
+    
+    // replace(str, old, new) - replace substring
+    interp.defineGlobal("replace", Value::makeNativeFunction("replace", 3,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString() || !args[1].isString() || !args[2].isString()) {
+                throw RuntimeError("replace() expects three strings");
+            }
+            std::string_view s = args[0].asStringView();
+            std::string_view from = args[1].asStringView();
+            std::string_view to = args[2].asStringView();
+            return Value(simd::replaceAll(s.data(), s.size(), from.data(), from.size(), to.data(), to.size()));
+        }));
+    
+    // slice(arr/str, start, end) - get slice
+    interp.defineGlobal("slice", Value::makeNativeFunction("slice", 3,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[1].isNumber() || !args[2].isNumber()) {
+                throw RuntimeError("slice() expects numbers for start and end");
+            }
+            int start = static_cast<int>(args[1].asNumber());
+            int end = static_cast<int>(args[2].asNumber());
+            
+            if (args[0].isString()) {
+                const auto& s = args[0].asStringPtr();
+                int len = static_cast<int>(s->size());
+                if (start < 0) start = std::max(0, len + start);
+                if (end < 0) end = std::max(0, len + end);
+                if (start >= len) return Value("");
+                if (end > len) end = len;
+                if (start >= end) return Value("");
+                return Value(EZString::slice(s, start, end - start));
+            }
+            if (args[0].isArray()) {
+                const auto& arr = args[0].asArray();
+                int len = static_cast<int>(arr.size());
+                if (start < 0) start = std::max(0, len + start);
+                if (end < 0) end = std::max(0, len + end);
+                if (start >= len) return Value::makeArray({});
+                if (end > len) end = len;
+                if (start >= end) return Value::makeArray({});
+                return Value::makeArray(std::vector<Value>(arr.begin() + start, arr.begin() + end));
+            }
+            if (args[0].isRange()) {
+                // Only the sliced elements are materialized
+                const EZRange& range = *args[0].asRange();
+                int len = static_cast<int>(std::min<size_t>(range.size(), INT32_MAX));
+                if (start < 0) start = std::max(0, len + start);
+                if (end < 0) end = std::max(0, len + end);
+                if (end > len) end = len;
+                if (start >= end) return Value::makeArray({});
+                return Value::makeArray(rangeElements(range, start, end));
+            }
+            throw RuntimeError("slice() expects string, array or range");
+        }));
+    
+    // StringBuilder([initial]) - mutable buffer for building large strings
+    interp.defineGlobal("StringBuilder", Value::makeNativeFunction("StringBuilder", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() > 1) throw RuntimeError("StringBuilder() expects at most 1 argument");
+            auto sb = std::make_shared<EZStringBuilder>();
+            if (!args.empty()) {
+                if (args[0].isString()) sb->buffer = args[0].asStringView();
+                else sb->buffer = args[0].toString();
+            }
+            return Value(sb);
+        }));
+    
+    // append(sb, values...) - append values to a StringBuilder, returns it
+    interp.defineGlobal("append", Value::makeNativeFunction("append", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty() || !args[0].isStringBuilder()) {
+                throw RuntimeError("append() expects StringBuilder as first argument");
+            }
+            auto& buffer = args[0].asStringBuilder()->buffer;
+            for (size_t i = 1; i < args.size(); i++) {
+                if (args[i].isString()) buffer += args[i].asStringView();
+                else buffer += args[i].toString();
+            }
+            return args[0];
+        }));
+    
+    // build(sb) - get the built string
+    interp.defineGlobal("build", Value::makeNativeFunction("build", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isStringBuilder()) throw RuntimeError("build() expects StringBuilder");
+            return Value(args[0].asStringBuilder()->buffer);
+        }));
+    
+    // print (alias for out but as function)
+    interp.defineGlobal("print", Value::makeNativeFunction("print", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            std::string text;
+            for (size_t i = 0; i < args.size(); i++) {
+                if (i > 0) text += ' ';
+                if (args[i].isString()) text += args[i].asStringView();
+                else text += args[i].toString();
+            }
+            text += '\n';
+            Output::instance().write(text);
+            return Value();
+        }));
+    
+    // input(prompt) - input with optional prompt
+    interp.defineGlobal("input", Value::makeNativeFunction("input", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args.empty()) {
+                Output::instance().write(args[0].toString());
+            }
+            Output::instance().flush();
+            std::string line;
+            std::getline(std::cin, line);
+            return Value(line);
+        }));
+    
+    // range(end), range(start, end) or range(start, end, step) - lazy integer sequence
+    interp.defineGlobal("range", Value::makeNativeFunction("range", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty() || args.size() > 3) {
+                throw RuntimeError("range() expects 1 to 3 arguments");
+            }
+            // Within +-2^53 every bound is an exact integer and size() cannot overflow
+            for (const auto& arg : args) {
+                if (!arg.isNumber()) throw RuntimeError("range() expects numbers");
+                if (!(std::fabs(arg.asNumber()) <= 9007199254740992.0)) {
+                    throw RuntimeError("range() bounds and step must be finite and within +-2^53");
+                }
+            }
+            
+            int64_t start = 0, end = 0, step = 1;
+            if (args.size() == 1) {
+                end = static_cast<int64_t>(args[0].asNumber());
+            } else {
+                start = static_cast<int64_t>(args[0].asNumber());
+                end = static_cast<int64_t>(args[1].asNumber());
+            }
+            if (args.size() == 3) {
+                step = static_cast<int64_t>(args[2].asNumber());
+                if (step == 0) throw RuntimeError("range() step must not be zero");
+            }
+            return Value(std::make_shared<EZRange>(start, end, step));
+        }));
+    
+    // iter(x) - iterator over anything `get x in` accepts
+    interp.defineGlobal("iter", Value::makeNativeFunction("iter", 1,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            return Value(interp.makeIterator(args[0], 0));
+        }));
+    
+    // next(it, [default]) - advance an iterator; default (or nil) once exhausted
+    interp.defineGlobal("next", Value::makeNativeFunction("next", -1,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (args.empty() || args.size() > 2 || !args[0].isIterator()) {
+                throw RuntimeError("next() expects an iterator and an optional default");
+            }
+            Value out;
+            if (args[0].asIterator()->next(interp, out)) return out;
+            return args.size() == 2 ? args[1] : Value();
+        }));
+    
+    // map(iterable, fn) - apply function to each element
+    interp.defineGlobal("map", Value::makeNativeFunction("map", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[1].isCallable()) {
+                throw RuntimeError("map() expects function as second argument");
+            }
+            
+            auto iter = interp.makeIterator(args[0], 0);
+            std::vector<Value> result;
+            if (args[0].isRange()) {
+                Interpreter::checkHeapLimit(args[0].asRange()->size() * sizeof(Value));
+                result.reserve(args[0].asRange()->size());
+            }
+            
+            Value elem;
+            while (iter->next(interp, elem)) {
+                Interpreter::checkHeapLimit();
+                result.push_back(interp.callFunction(args[1], {elem}, 0));
+            }
+            
+            return Value::makeArray(result);
+        }));
+    
+    // filter(iterable, fn) - filter elements where fn returns truthy
+    interp.defineGlobal("filter", Value::makeNativeFunction("filter", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[1].isCallable()) {
+                throw RuntimeError("filter() expects function as second argument");
+            }
+            
+            auto iter = interp.makeIterator(args[0], 0);
+            std::vector<Value> result;
+            
+            Value elem;
+            while (iter->next(interp, elem)) {
+                Interpreter::checkHeapLimit();
+                Value test = interp.callFunction(args[1], {elem}, 0);
+                if (test.isTruthy()) {
+                    result.push_back(elem);
+                }
+            }
+            
+            return Value::makeArray(result);
+        }));
+    
+    // reduce(iterable, fn, initial) - reduce to single value
+    interp.defineGlobal("reduce", Value::makeNativeFunction("reduce", 3,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[1].isCallable()) {
+                throw RuntimeError("reduce() expects function as second argument");
+            }
+            
+            auto iter = interp.makeIterator(args[0], 0);
+            Value acc = args[2];
+            
+            Value elem;
+            while (iter->next(interp, elem)) {
+                acc = interp.callFunction(args[1], {acc, elem}, 0);
+            }
+            
+            return acc;
+        }));
+    
+    // forEach(iterable, fn) - apply function to each element (no return)
+    interp.defineGlobal("forEach", Value::makeNativeFunction("forEach", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[1].isCallable()) {
+                throw RuntimeError("forEach() expects function as second argument");
+            }
+            
+            auto iter = interp.makeIterator(args[0], 0);
+            Value elem;
+            while (iter->next(interp, elem)) {
+                interp.callFunction(args[1], {elem}, 0);
+            }
+            
+            return Value();
+        }));
+    
+    // find(arr, fn) - find first element where fn returns truthy
+    interp.defineGlobal("find", Value::makeNativeFunction("find", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray()) {
+                throw RuntimeError("find() expects array as first argument");
+            }
+            if (!args[1].isCallable()) {
+                throw RuntimeError("find() expects function as second argument");
+            }
+            
+            const auto& arr = args[0].asArray();
+            
+            for (const auto& elem : arr) {
+                Value test = interp.callFunction(args[1], {elem}, 0);
+                if (test.isTruthy()) {
+                    return elem;
+                }
+            }
+            
+            return Value();  // nil if not found
+        }));
+    
+    // every(arr, fn) - true if fn returns truthy for all elements
+    interp.defineGlobal("every", Value::makeNativeFunction("every", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray()) {
+                throw RuntimeError("every() expects array as first argument");
+            }
+            if (!args[1].isCallable()) {
+                throw RuntimeError("every() expects function as second argument");
+            }
+            
+            const auto& arr = args[0].asArray();
+            
+            for (const auto& elem : arr) {
+                Value test = interp.callFunction(args[1], {elem}, 0);
+                if (!test.isTruthy()) {
+                    return Value(false);
+                }
+            }
+            
+            return Value(true);
+        }));
+    
+    // some(arr, fn) - true if fn returns truthy for at least one element
+    interp.defineGlobal("some", Value::makeNativeFunction("some", 2,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray()) {
+                throw RuntimeError("some() expects array as first argument");
+            }
+            if (!args[1].isCallable()) {
+                throw RuntimeError("some() expects function as second argument");
+            }
+            
+            const auto& arr = args[0].asArray();
+            
+            for (const auto& elem : arr) {
+                Value test = interp.callFunction(args[1], {elem}, 0);
+                if (test.isTruthy()) {
+                    return Value(true);
+                }
+            }
+            
+            return Value(false);
+        }));
+    
+    // readFile(path) - read file content as string
+    interp.defineGlobal("readFile", Value::makeNativeFunction("readFile", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("readFile() expects string path");
+            }
+            std::string path = args[0].asString();
+            MappedFile file;
+            if (!file.open(path)) {
+                throw RuntimeError("Could not open file '" + path + "'");
+            }
+            Interpreter::checkHeapLimit(file.size());
+            return Value(std::string(file.data(), file.size()));
+        }));
+    
+    // writeFile(path, content) - write string to file
+    interp.defineGlobal("writeFile", Value::makeNativeFunction("writeFile", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("writeFile() expects string path");
+            }
+            if (!args[1].isString()) {
+                throw RuntimeError("writeFile() expects string content");
+            }
+            std::string path = args[0].asString();
+            std::string_view content = args[1].asStringView();
+            
+            std::ofstream file(path);
+            if (!file.is_open()) {
+                throw RuntimeError("Could not open file '" + path + "' for writing");
+            }
+            file << content;
+            return Value(true);
+        }));
+    
+    // appendFile(path, content) - append string to file
+    interp.defineGlobal("appendFile", Value::makeNativeFunction("appendFile", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("appendFile() expects string path");
+            }
+            if (!args[1].isString()) {
+                throw RuntimeError("appendFile() expects string content");
+            }
+            std::string path = args[0].asString();
+            std::string_view content = args[1].asStringView();
+            
+            std::ofstream file(path, std::ios::app);
+            if (!file.is_open()) {
+                throw RuntimeError("Could not open file '" + path + "' for appending");
+            }
+            file << content;
+            return Value(true);
+        }));
+    
+    // readLines(path) - read file into array of lines
+    interp.defineGlobal("readLines", Value::makeNativeFunction("readLines", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("readLines() expects string path");
+            }
+            std::string path = args[0].asString();
+            MappedFile file;
+            if (!file.open(path)) {
+                throw RuntimeError("Could not open file '" + path + "'");
+            }
+            
+            // Copy the file into one string and scan it with memchr; the lines
+            // are slices of it. A trailing newline does not start an extra
+            // empty line
+            Interpreter::checkHeapLimit(file.size());
+            auto text = memory::make<EZString>(std::string(file.data(), file.size()));
+            auto lines = memory::make<Value::ArrayType>();
+            const char* base = text->data();
+            const char* p = base;
+            const char* end = p + text->size();
+            while (p < end) {
+                Interpreter::checkHeapLimit();
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                const char* lineEnd = nl ? nl : end;
+                size_t len = lineEnd - p;
+                if (len > 0 && p[len - 1] == '\r') len--;
+                lines->push_back(Value(len == 0 ? memory::make<EZString>() : EZString::slice(text, p - base, len)));
+                p = nl ? nl + 1 : end;
+            }
+            return Value(lines);
+        }));
+    
+    // writeLine(path, content) - write string with newline to file
+    // writeLine(fh, value) - buffered write of value plus newline to an open handle
+    interp.defineGlobal("writeLine", Value::makeNativeFunction("writeLine", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isFile()) {
+                auto file = args[0].asFile();
+                std::lock_guard<std::mutex> lock(file->mutex);
+                checkWritable(*file, "writeLine");
+                if (args[1].isString()) {
+                    std::string_view s = args[1].asStringView();
+                    writeChecked(*file, s.data(), s.size(), "writeLine");
+                } else {
+                    std::string s = args[1].toString();
+                    writeChecked(*file, s.data(), s.size(), "writeLine");
+                }
+                writeChecked(*file, "\n", 1, "writeLine");
+                return args[0];
+            }
+            if (!args[0].isString()) {
+                throw RuntimeError("writeLine() expects string path");
+            }
+            if (!args[1].isString()) {
+                throw RuntimeError("writeLine() expects string content");
+            }
+            std::string path = args[0].asString();
+            std::string_view content = args[1].asStringView();
+            
+            std::ofstream file(path);
+            if (!file.is_open()) {
+                throw RuntimeError("Could not open file '" + path + "' for writing");
+            }
+            file << content << '\n';
+            return Value(true);
+        }));
+    
+    // appendLine(path, content) - append string with newline to file
+    interp.defineGlobal("appendLine", Value::makeNativeFunction("appendLine", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) {
+                throw RuntimeError("appendLine() expects string path");
+            }
+            if (!args[1].isString()) {
+                throw RuntimeError("appendLine() expects string content");
+            }
+            std::string path = args[0].asString();
+            std::string_view content = args[1].asStringView();
+            
+            std::ofstream file(path, std::ios::app);
+            if (!file.is_open()) {
+                throw RuntimeError("Could not open file '" + path + "' for appending");
+            }
+            file << content << '\n';
+            return Value(true);
+        }));
+    
+    // --- File Handles ---
+    
+    // open(path, [mode]) - open a buffered file handle; mode is r, w, a, r+, w+ or a+
+    interp.defineGlobal("open", Value::makeNativeFunction("open", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty() || args.size() > 2 || !args[0].isString()) {
+                throw RuntimeError("open() expects a path and an optional mode");
+            }
+            std::string mode = args.size() == 2 ? args[1].toString() : "r";
+            auto file = std::make_shared<EZFile>(args[0].asString(), mode);
+            if (!file->open()) {
+                throw RuntimeError("Could not open file '" + file->path + "' with mode '" + mode + "'");
+            }
+            return Value(file);
+        }));
+    
+    // write(fh, values...) - write values to a file handle without a newline
+    interp.defineGlobal("write", Value::makeNativeFunction("write", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty() || !args[0].isFile()) throw RuntimeError("write() expects a file handle");
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            checkWritable(*file, "write");
+            for (size_t i = 1; i < args.size(); i++) {
+                if (args[i].isString()) {
+                    std::string_view s = args[i].asStringView();
+                    writeChecked(*file, s.data(), s.size(), "write");
+                } else {
+                    std::string s = args[i].toString();
+                    writeChecked(*file, s.data(), s.size(), "write");
+                }
+            }
+            return args[0];
+        }));
+    
+    // readLine(fh) - next line without its newline, or nil at end of file
+    interp.defineGlobal("readLine", Value::makeNativeFunction("readLine", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isFile()) throw RuntimeError("readLine() expects a file handle");
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            checkReadable(*file, "readLine");
+            std::string line;
+            if (!file->readLine(line)) return Value();
+            return Value(line);
+        }));
+    
+    // readChunk(fh, n) - up to n bytes, or nil at end of file
+    interp.defineGlobal("readChunk", Value::makeNativeFunction("readChunk", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isFile() || !args[1].isNumber() || args[1].asNumber() < 1) {
+                throw RuntimeError("readChunk() expects a file handle and a positive size");
+            }
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            checkReadable(*file, "readChunk");
+            std::string chunk = file->readChunk(static_cast<size_t>(args[1].asNumber()));
+            if (chunk.empty()) return Value();
+            return Value(chunk);
+        }));
+    
+    // flush([fh]) - push buffered writes to the OS; stdout when called without arguments
+    interp.defineGlobal("flush", Value::makeNativeFunction("flush", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty()) {
+                Output::instance().flush();
+                return Value();
+            }
+            if (!args[0].isFile()) throw RuntimeError("flush() expects a file handle");
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            if (!file->isOpen()) throw RuntimeError("File '" + file->path + "' is closed");
+            if (!file->flush()) throw RuntimeError("Could not flush '" + file->path + "'");
+            return Value();
+        }));
+    
+    // close(fh) - flush and close; closing twice is harmless
+    interp.defineGlobal("close", Value::makeNativeFunction("close", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isFile()) throw RuntimeError("close() expects a file handle");
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            // Buffered data that cannot be written out is reported here
+            if (!file->close()) {
+                throw RuntimeError("close(): could not write buffered data to '" + file->path + "': " +
+                                   std::strerror(errno));
+            }
+            return Value();
+        }));
+    
+    // keys(dict)
+    interp.defineGlobal("keys", Value::makeNativeFunction("keys", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isDictionary()) throw RuntimeError("keys() expects dictionary");
+            const auto& map = args[0].asDictionary().map;
+            std::vector<Value> keys;
+            for (const auto& kv : map) {
+                Interpreter::checkHeapLimit();
+                keys.push_back(Value(kv.first));
+            }
+            return Value::makeArray(keys);
+        }));
+    
+    // values(dict)
+    interp.defineGlobal("values", Value::makeNativeFunction("values", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isDictionary()) throw RuntimeError("values() expects dictionary");
+            const auto& map = args[0].asDictionary().map;
+            std::vector<Value> vals;
+            Interpreter::checkHeapLimit(map.size() * sizeof(Value));
+            for (const auto& kv : map) {
+                vals.push_back(kv.second);
+            }
+            return Value::makeArray(vals);
+        }));
+
+    // server(port, handler, [options]) - multithreaded web server
+    // options: {"metrics": "/__metrics"} - path answered with Prometheus metrics ("" to disable)
+    interp.defineGlobal("server", Value::makeNativeFunction("server", -1,
+        [](Interpreter& interp, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2) throw RuntimeError("server() expects at least 2 arguments");
+            if (!args[0].isNumber()) throw RuntimeError("server() port must be a number");
+            if (!args[1].isFunction()) throw RuntimeError("server() handler must be a function");
+            
+            int port = static_cast<int>(args[0].asNumber());
+            Value handler = args[1];
+            std::string metricsPath = "/__metrics";
+            if (args.size() > 2) {
+                if (!args[2].isDictionary()) throw RuntimeError("server() options must be a dictionary");
+                auto& options = args[2].asDictionary().map;
+                if (options.count("metrics")) {
+                    if (!options.at("metrics").isString()) throw RuntimeError("server() metrics option must be a string path");
+                    metricsPath = options.at("metrics").asString();
+                }
+            }
+
+            if (!platform::startNetwork()) {
+                throw RuntimeError("Network initialization failed");
+            }
+
+            const char* error = nullptr;
+            platform::Socket listenSocket = platform::listenTcp(port, error);
+            if (listenSocket == platform::NO_SOCKET) {
+                platform::stopNetwork();
+                throw RuntimeError(error);
+            }
+
+            while (true) {
+                platform::Socket clientSocket = accept(listenSocket, nullptr, nullptr);
+                if (clientSocket == platform::NO_SOCKET) break;
+                auto accepted = std::chrono::steady_clock::now();
+
+                // Capture globalEnv to share with the new thread's interpreter
+                auto globalEnv = interp.getGlobalEnv();
+                
+                // Spawn a detached thread for each client
+                std::thread([clientSocket, handler, globalEnv, metricsPath, accepted]() {
+                    ServerMetrics& metrics = ServerMetrics::instance();
+                    ServerMetrics::Connection connection;
+                    metrics.queueWait.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - accepted).count()));
+                    if (memory::heapNearLimit()) {
+                        // Shed load close to --max-heap before reading the
+                        // request or building anything for it
+                        const char* busy = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+                        platform::sendAll(clientSocket, busy, strlen(busy));
+                        platform::shutdownSend(clientSocket);
+                        metrics.addBytesOut(strlen(busy));
+                        metrics.recordStatus(503);
+                        platform::closeSocket(clientSocket);
+                        return;
+                    }
+
+                    // OPTIMIZATION: Create a child environment for this request
+                    // and use the lightweight constructor to skip overhead
+                    auto requestEnv = globalEnv->createChild();
+                    Interpreter threadInterp(requestEnv);
+                    threadInterp.setThreadName("<server>");
+
+                    // Read headers
+                    std::string request;
+                    char buffer[4096];
+                    bool headersComplete = false;
+                    size_t contentLen = 0;
+                    
+                    while (!headersComplete) {
+                        int bytesRead = platform::receive(clientSocket, buffer, sizeof(buffer));
+                        if (bytesRead <= 0) break;
+                        metrics.addBytesIn(bytesRead);
+                        request.append(buffer, bytesRead);
+                        
+                        size_t headerEnd = request.find("\r\n\r\n");
+                        if (headerEnd != std::string::npos) {
+                            headersComplete = true;
+                            
+                            // Parse Content-Length
+                            size_t clPos = request.find("Content-Length: ");
+                            if (clPos != std::string::npos) {
+                                size_t start = clPos + 16;
+                                size_t end = request.find("\r\n", start);
+                                if (end != std::string::npos) {
+                                    contentLen = std::stoi(request.substr(start, end - start));
+                                }
+                            }
+                        }
+                    }
+
+                    if (headersComplete) {
+                        // Check if we have the full body
+                        size_t headerEnd = request.find("\r\n\r\n");
+                        size_t bodyStart = headerEnd + 4;
+                        
+                        while (request.length() - bodyStart < contentLen) {
+                            int bytesRead = platform::receive(clientSocket, buffer, sizeof(buffer));
+                            if (bytesRead <= 0) break;
+                            metrics.addBytesIn(bytesRead);
+                            request.append(buffer, bytesRead);
+                        }
+                        
+                        std::string method, fullPath, version, body;
+                        OrderedMap<Value> headers;
+                        OrderedMap<Value> query;
+
+                        // Parse Request Line
+                        size_t firstSpace = request.find(' ');
+                        if (firstSpace != std::string::npos) {
+                            method = request.substr(0, firstSpace);
+                            size_t secondSpace = request.find(' ', firstSpace + 1);
+                            if (secondSpace != std::string::npos) {
+                                fullPath = request.substr(firstSpace + 1, secondSpace - (firstSpace + 1));
+                                version = request.substr(secondSpace + 1, headerEnd - (secondSpace + 1)); // Approximate
+                            }
+                        }
+
+                        // Parse Path and Query Params
+                        std::string path = fullPath;
+                        size_t qPos = fullPath.find('?');
+                        if (qPos != std::string::npos) {
+                            path = fullPath.substr(0, qPos);
+                            std::string qStr = fullPath.substr(qPos + 1);
+                            size_t start = 0;
+                            while (start < qStr.length()) {
+                                size_t amPos = qStr.find('&', start);
+                                std::string pair = qStr.substr(start, amPos == std::string::npos ? amPos : amPos - start);
+                                size_t eqPos = pair.find('=');
+                                if (eqPos != std::string::npos) {
+                                    query[pair.substr(0, eqPos)] = Value(pair.substr(eqPos + 1));
+                                } else if (!pair.empty()) {
+                                    query[pair] = Value(true);
+                                }
+                                if (amPos == std::string::npos) break;
+                                start = amPos + 1;
+                            }
+                        }
+                        
+                        // Metrics are answered here, without entering the EZ handler
+                        if (!metricsPath.empty() && path == metricsPath) {
+                            std::string text = metrics.render();
+                            std::string resp = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                               std::to_string(text.length()) + "\r\n\r\n" + text;
+                            platform::sendAll(clientSocket, resp.c_str(), resp.length());
+                            metrics.addBytesOut(resp.length());
+                            metrics.recordStatus(200);
+                            platform::closeSocket(clientSocket);
+                            return;
+                        }
+
+                        // Body
+                        if (request.length() > bodyStart) {
+                            body = request.substr(bodyStart);
+                        }
+                        
+                        // Parse Headers
+                        size_t pos = request.find("\r\n") + 2;
+                        while (pos < headerEnd) {
+                            size_t nextLine = request.find("\r\n", pos);
+                            if (nextLine == std::string::npos || nextLine > headerEnd) break;
+                            
+                            std::string line = request.substr(pos, nextLine - pos);
+                            size_t colon = line.find(':');
+                            if (colon != std::string::npos) {
+                                std::string k = line.substr(0, colon);
+                                std::string v = line.substr(colon + 1);
+                                v.erase(0, v.find_first_not_of(" "));
+                                headers[k] = Value(v);
+                            }
+                            pos = nextLine + 2;
+                        }
+
+                        // Create request object
+                        Value reqArg = Value::makeDictionary();
+                        auto& reqMap = reqArg.asDictionary().map;
+                        reqMap["method"] = Value(method);
+                        reqMap["path"] = Value(path);
+                        reqMap["fullPath"] = Value(fullPath);
+                        reqMap["version"] = Value(version);
+                        reqMap["body"] = Value(body);
+
+                        Value queryDict = Value::makeDictionary();
+                        queryDict.asDictionary().map = std::move(query);
+                        reqMap["query"] = queryDict;
+
+                        Value headerDict = Value::makeDictionary();
+                        headerDict.asDictionary().map = std::move(headers);
+                        reqMap["headers"] = headerDict;
+
+                        std::vector<Value> callbackArgs = {reqArg};
+                        try {
+                            TraceSpan span("server", method + " " + path);
+                            Value result;
+                            {
+                                ServerMetrics::Histogram::Timer timer(metrics.handlerTime);
+                                result = threadInterp.callFunction(handler, callbackArgs, 0);
+                            }
+                            std::string respStr;
+                            std::string b;  // body, sent after the headers in respStr
+                            int status = 200;
+                            
+                            if (result.isDictionary()) {
+                                auto& d = result.asDictionary().map;
+                                if (d.count("status")) status = (int)d.at("status").asNumber();
+                                // Dictionary and array bodies are serialized straight into the body buffer
+                                bool jsonBody = false;
+                                if (d.count("body")) {
+                                    const Value& body = d.at("body");
+                                    jsonBody = body.isDictionary() || body.isArray() || body.isTypedArray();
+                                    if (jsonBody) json::write(body, b);
+                                    else b = body.toString();
+                                }
+                                
+                                respStr = "HTTP/1.1 " + std::to_string(status) + " OK\r\n";
+                                if (d.count("headers") && d.at("headers").isDictionary()) {
+                                    for (auto& kv : d.at("headers").asDictionary().map) {
+                                        respStr += kv.first + ": " + kv.second.toString() + "\r\n";
+                                    }
+                                } else {
+                                    respStr += jsonBody ? "Content-Type: application/json\r\n" : "Content-Type: text/html\r\n";
+                                }
+                                respStr += "Content-Length: " + std::to_string(b.length()) + "\r\n";
+                                respStr += "\r\n";
+                            } else {
+                                respStr = result.toString();
+                                if (respStr.compare(0, 9, "HTTP/1.1 ") == 0 || respStr.compare(0, 9, "HTTP/1.0 ") == 0) {
+                                    status = std::atoi(respStr.c_str() + 9);
+                                } else if (respStr.find("HTTP/") != 0) {
+                                    b = std::move(respStr);
+                                    respStr = "HTTP/1.1 200 OK\r\n";
+                                    respStr += "Content-Type: text/html\r\n";
+                                    respStr += "Content-Length: " + std::to_string(b.length()) + "\r\n";
+                                    respStr += "\r\n";
+                                }
+                            }
+                            
+                            platform::sendAll(clientSocket, respStr.c_str(), respStr.length());
+                            if (!b.empty()) platform::sendAll(clientSocket, b.c_str(), b.length());
+                            metrics.addBytesOut(respStr.length() + b.length());
+                            metrics.recordStatus(status);
+                        } catch (const std::exception& e) {
+                            std::string errResp = "HTTP/1.1 500 Internal Server Error\r\n\r\nServer Error: " + std::string(e.what());
+                            platform::sendAll(clientSocket, errResp.c_str(), errResp.length());
+                            metrics.addBytesOut(errResp.length());
+                            metrics.recordStatus(500);
+                        }
+                    }
+                    platform::closeSocket(clientSocket);
+                }).detach();
+            }
+
+            platform::closeSocket(listenSocket);
+            platform::stopNetwork();
+            return Value();
+        }));
+
+    // serveFile(path) - helper to serve a file with correct headers
+    interp.defineGlobal("serveFile", Value::makeNativeFunction("serveFile", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("serveFile() expects string path");
+            std::string path = args[0].asString();
+            
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                Value resp = Value::makeDictionary();
+                resp.asDictionary().map["status"] = Value(404.0);
+                resp.asDictionary().map["body"] = Value("File not found: " + path);
+                return resp;
+            }
+            
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            std::string body = buffer.str();
+            
+            std::string ext = "";
+            size_t dot = path.find_last_of('.');
+            if (dot != std::string::npos) ext = path.substr(dot + 1);
+            
+            std::string mime = "text/plain";
+            if (ext == "html" || ext == "htm") mime = "text/html";
+            else if (ext == "css") mime = "text/css";
+            else if (ext == "js") mime = "text/javascript";
+            else if (ext == "png") mime = "image/png";
+            else if (ext == "jpg" || ext == "jpeg") mime = "image/jpeg";
+            else if (ext == "json") mime = "application/json";
+            
+            Value resp = Value::makeDictionary();
+            auto& d = resp.asDictionary().map;
+            d["status"] = Value(200.0);
+            
+            Value headers = Value::makeDictionary();
+            headers.asDictionary().map["Content-Type"] = Value(mime);
+            d["headers"] = headers;
+            
+            d["body"] = Value(body);
+            return resp;
+        }));
+
+    // Database functions
+    static std::unordered_map<int, sqlite3*> dbConnections;
+    static int nextDbHandle = 1;
+
+    // dbOpen(path)
+    interp.defineGlobal("dbOpen", Value::makeNativeFunction("dbOpen", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("dbOpen() expects string path");
+            std::string path = args[0].asString();
+            
+            sqlite3* db;
+            int rc = sqlite3_open(path.c_str(), &db);
+            if (rc != SQLITE_OK) {
+                std::string err = sqlite3_errmsg(db);
+                sqlite3_close(db);
+                throw RuntimeError("sqlite3_open failed: " + err);
+            }
+            
+            int handle = nextDbHandle++;
+            dbConnections[handle] = db;
+            return Value((double)handle);
+        }));
+
+    // dbExec(handle, sql, [params])
+    interp.defineGlobal("dbExec", Value::makeNativeFunction("dbExec", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2) throw RuntimeError("dbExec() expects at least 2 arguments");
+            if (!args[0].isNumber()) throw RuntimeError("dbExec() expects number handle");
+            if (!args[1].isString()) throw RuntimeError("dbExec() expects string SQL");
+            TraceSpan span("db", "dbExec", args[1].asStringView());
+            ServerMetrics::Histogram::Timer timer(ServerMetrics::instance().dbTime);
+            
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) {
+                throw RuntimeError("Invalid database handle");
+            }
+            
+            sqlite3* db = dbConnections[handle];
+            sqlite3_stmt* stmt;
+            std::string_view sql = args[1].asStringView();
+            if (sqlite3_prepare_v2(db, sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+                throw RuntimeError("sqlite3_prepare_v2 failed: " + std::string(sqlite3_errmsg(db)));
+            }
+            
+            if (args.size() > 2 && args[2].isArray()) bindParams(stmt, args[2].asArray());
+            
+            int rc = sqlite3_step(stmt);
+            sqlite3_finalize(stmt);
+            
+            if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+                throw RuntimeError("sqlite3_step failed: " + std::string(sqlite3_errmsg(db)));
+            }
+            
+            return Value(true);
+        }));
+
+    // dbQuery(handle, sql, [params])
+    interp.defineGlobal("dbQuery", Value::makeNativeFunction("dbQuery", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2) throw RuntimeError("dbQuery() expects at least 2 arguments");
+            if (!args[0].isNumber()) throw RuntimeError("dbQuery() expects number handle");
+            if (!args[1].isString()) throw RuntimeError("dbQuery() expects string SQL");
+            TraceSpan span("db", "dbQuery", args[1].asStringView());
+            ServerMetrics::Histogram::Timer timer(ServerMetrics::instance().dbTime);
+            
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) {
+                throw RuntimeError("Invalid database handle");
+            }
+            
+            sqlite3* db = dbConnections[handle];
+            sqlite3_stmt* stmt;
+            std::string_view sql = args[1].asStringView();
+            if (sqlite3_prepare_v2(db, sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+                throw RuntimeError("sqlite3_prepare_v2 failed: " + std::string(sqlite3_errmsg(db)));
+            }
+            
+            if (args.size() > 2 && args[2].isArray()) bindParams(stmt, args[2].asArray());
+            
+            std::vector<Value> results;
+            int colCount = sqlite3_column_count(stmt);
+            
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                Value row = Value::makeDictionary();
+                auto& rowMap = row.asDictionary().map;
+                
+                for (int i = 0; i < colCount; i++) {
+                    const char* name = sqlite3_column_name(stmt, i);
+                    std::string colName = name ? name : "col_" + std::to_string(i);
+                    int type = sqlite3_column_type(stmt, i);
+                    
+                    if (type == SQLITE_INTEGER) {
+                        rowMap[colName] = Value((double)sqlite3_column_int64(stmt, i));
+                    } else if (type == SQLITE_FLOAT) {
+                        rowMap[colName] = Value(sqlite3_column_double(stmt, i));
+                    } else if (type == SQLITE_TEXT) {
+                        const char* text = (const char*)sqlite3_column_text(stmt, i);
+                        rowMap[colName] = Value(text ? text : "");
+                    } else if (type == SQLITE_NULL) {
+                        rowMap[colName] = Value();
+                    } else {
+                        const char* text = (const char*)sqlite3_column_text(stmt, i);
+                        rowMap[colName] = Value(text ? text : "");
+                    }
+                }
+                results.push_back(row);
+            }
+            
+            sqlite3_finalize(stmt);
+            return Value::makeArray(results);
+        }));
+
+    // dbClose(handle)
+    interp.defineGlobal("dbClose", Value::makeNativeFunction("dbClose", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("dbClose() expects number handle");
+            
+            int handle = (int)args[0].asNumber();
+            auto it = dbConnections.find(handle);
+            if (it != dbConnections.end()) {
+                sqlite3_close(it->second);
+                dbConnections.erase(it);
+            }
+            return Value(true);
+        }));
+
+    // dbLastInsertId(handle)
+    interp.defineGlobal("dbLastInsertId", Value::makeNativeFunction("dbLastInsertId", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("dbLastInsertId() expects number handle");
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
+            return Value((double)sqlite3_last_insert_rowid(dbConnections[handle]));
+        }));
+
+    // dbBegin(handle)
+    interp.defineGlobal("dbBegin", Value::makeNativeFunction("dbBegin", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("dbBegin() expects number handle");
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
+            sqlite3_exec(dbConnections[handle], "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+            return Value(true);
+        }));
+
+    // dbCommit(handle)
+    interp.defineGlobal("dbCommit", Value::makeNativeFunction("dbCommit", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("dbCommit() expects number handle");
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
+            sqlite3_exec(dbConnections[handle], "COMMIT", nullptr, nullptr, nullptr);
+            return Value(true);
+        }));
+
+    // dbRollback(handle)
+    interp.defineGlobal("dbRollback", Value::makeNativeFunction("dbRollback", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("dbRollback() expects number handle");
+            int handle = (int)args[0].asNumber();
+            if (dbConnections.find(handle) == dbConnections.end()) throw RuntimeError("Invalid database handle");
+            sqlite3_exec(dbConnections[handle], "ROLLBACK", nullptr, nullptr, nullptr);
+            return Value(true);
+        }));
+
+    // ord(str) - returns ASCII value of first char
+    interp.defineGlobal("ord", Value::makeNativeFunction("ord", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("ord() expects string");
+            std::string_view s = args[0].asStringView();
+            if (s.empty()) return Value(0.0);
+            return Value((double)(unsigned char)s[0]);
+        }));
+
+    // chr(num) - returns char from ASCII value
+    interp.defineGlobal("chr", Value::makeNativeFunction("chr", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("chr() expects number");
+            char c = (char)(int)args[0].asNumber();
+            return Value(std::string(1, c));
+        }));
+
+    // xor(a, b) - bitwise XOR
+    interp.defineGlobal("xor", Value::makeNativeFunction("xor", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber() || !args[1].isNumber()) throw RuntimeError("xor() expects numbers");
+            int a = (int)args[0].asNumber();
+            int b = (int)args[1].asNumber();
+            return Value((double)(a ^ b));
+        }));
+
+    // substring(str, start, [len])
+    interp.defineGlobal("substring", Value::makeNativeFunction("substring", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2 || args.size() > 3) throw RuntimeError("substring() expects 2 or 3 arguments");
+            if (!args[0].isString()) throw RuntimeError("substring() first arg must be string");
+            if (!args[1].isNumber()) throw RuntimeError("substring() start must be number");
+            
+            const auto& s = args[0].asStringPtr();
+            int start = (int)args[1].asNumber();
+            int len = (args.size() == 3 && args[2].isNumber()) ? (int)args[2].asNumber() : (int)s->size() - std::max(start, 0);
+            return substringOf(s, start, len);
+        }));
+
+    // split(str, delimiter)
+    interp.defineGlobal("split", Value::makeNativeFunction("split", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString() || !args[1].isString()) throw RuntimeError("split() expects strings");
+            return splitString(args[0].asStringPtr(), args[1].asStringView());
+        }));
+
+    // join(array, delimiter)
+    interp.defineGlobal("join", Value::makeNativeFunction("join", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isArray() && !args[0].isRange()) throw RuntimeError("join() expects array as first arg");
+            if (!args[1].isString()) throw RuntimeError("join() expects string delimiter");
+            
+            if (args[0].isRange()) return joinValues(rangeElements(*args[0].asRange()), args[1].asStringView());
+            return joinValues(args[0].asArray(), args[1].asStringView());
+        }));
+
+    // push(array, value)
+    interp.defineGlobal("push", Value::makeNativeFunction("push", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isRange()) throw rangeIsReadOnly("push");
+            if (!args[0].isArray()) throw RuntimeError("push() expects array");
+            args[0].asArrayPtr()->push_back(args[1]);
+            return args[1];
+        }));
+
+    // pop(array)
+    interp.defineGlobal("pop", Value::makeNativeFunction("pop", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args[0].isRange()) throw rangeIsReadOnly("pop");
+            if (!args[0].isArray()) throw RuntimeError("pop() expects array");
+            auto arrPtr = args[0].asArrayPtr();
+            if (arrPtr->empty()) return Value();
+            Value val = arrPtr->back();
+            arrPtr->pop_back();
+            return val;
+        }));
+
+    // toLower(str)
+    interp.defineGlobal("toLower", Value::makeNativeFunction("toLower", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("toLower() expects string");
+            return caseMapped(args[0].asStringView(), false);
+        }));
+
+    // toUpper(str)
+    interp.defineGlobal("toUpper", Value::makeNativeFunction("toUpper", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("toUpper() expects string");
+            return caseMapped(args[0].asStringView(), true);
+        }));
+
+    // typeOf(val)
+    interp.defineGlobal("typeOf", Value::makeNativeFunction("typeOf", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            return Value(args[0].typeName());
+        }));
+
+    // dictRemove(dict, key)
+    interp.defineGlobal("dictRemove", Value::makeNativeFunction("dictRemove", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isDictionary()) throw RuntimeError("dictRemove() expects dictionary");
+            std::string key = args[1].toString();
+            args[0].asDictionaryPtr()->map.erase(key);
+            return args[0];
+        }));
+
+    // --- Added Missing Functions ---
+
+    // stop(ms) - Sleep for specified milliseconds
+    interp.defineGlobal("stop", Value::makeNativeFunction("stop", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("stop() expects number");
+            std::this_thread::sleep_for(std::chrono::milliseconds((int)args[0].asNumber()));
+            return Value();
+        }));
+
+    // parse_json(str) - Convert JSON string to EZ value
+    interp.defineGlobal("parse_json", Value::makeNativeFunction("parse_json", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("parse_json() expects string");
+            return json::parse(args[0].asStringView());
+        }));
+
+    // json_doc(str) - Index a JSON text for json_get without converting it
+    interp.defineGlobal("json_doc", Value::makeNativeFunction("json_doc", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("json_doc() expects string");
+            return Value(std::make_shared<json::Document>(args[0].asStringPtr()));
+        }));
+
+    // json_get(doc, path, [default]) - Read one value out of a json_doc
+    interp.defineGlobal("json_get", Value::makeNativeFunction("json_get", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2 || args.size() > 3 || !args[0].isJsonDoc()) {
+                throw RuntimeError("json_get() expects a json_doc, a path and optional default");
+            }
+            std::vector<json::PathStep> path;
+            if (args[1].isString()) {
+                path = json::parsePath(args[1].asStringView());
+            } else if (args[1].isArray()) {
+                // ["a", 0, "key.with.dots"] for keys the string form cannot spell
+                for (const Value& step : args[1].asArray()) {
+                    json::PathStep s;
+                    if (step.isNumber() && step.asNumber() >= 0) s.index = static_cast<int64_t>(step.asNumber());
+                    else if (step.isString()) s.key = step.asString();
+                    else throw RuntimeError("json_get() path steps must be strings or non-negative numbers");
+                    path.push_back(std::move(s));
+                }
+            } else {
+                throw RuntimeError("json_get() expects a string or array path");
+            }
+            Value out;
+            if (!args[0].asJsonDoc()->get(path, out)) return args.size() == 3 ? args[2] : Value();
+            return out;
+        }));
+
+    // to_json(val, [pretty]) - Convert EZ value to JSON string
+    interp.defineGlobal("to_json", Value::makeNativeFunction("to_json", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty() || args.size() > 2) throw RuntimeError("to_json() expects a value and optional pretty flag");
+            bool pretty = args.size() == 2 && args[1].isTruthy();
+            std::string out;
+            json::write(args[0], out, pretty);
+            return Value(std::move(out));
+        }));
+
+    // write_json(fh, val, [pretty]) - Stream JSON to an open file handle
+    interp.defineGlobal("write_json", Value::makeNativeFunction("write_json", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2 || args.size() > 3 || !args[0].isFile()) {
+                throw RuntimeError("write_json() expects a file handle, a value and optional pretty flag");
+            }
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            checkWritable(*file, "write_json");
+            bool pretty = args.size() == 3 && args[2].isTruthy();
+            json::write(args[1], [&](const char* data, size_t len) { writeChecked(*file, data, len, "write_json"); },
+                        pretty);
+            return args[0];
+        }));
+
+    // jsonl_read(path) - Lazily iterate the values of a JSON Lines file
+    interp.defineGlobal("jsonl_read", Value::makeNativeFunction("jsonl_read", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isString()) throw RuntimeError("jsonl_read() expects string path");
+            return Value(std::make_shared<json::LinesReader>(args[0].asString()));
+        }));
+
+    // jsonl_write(fh, val) - Append val as one compact JSON line
+    interp.defineGlobal("jsonl_write", Value::makeNativeFunction("jsonl_write", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isFile()) throw RuntimeError("jsonl_write() expects a file handle and a value");
+            // Serialize outside the lock into a per-thread buffer that keeps
+            // its capacity between calls
+            static thread_local std::string line;
+            line.clear();
+            json::write(args[1], line);
+            line += '\n';
+            auto file = args[0].asFile();
+            std::lock_guard<std::mutex> lock(file->mutex);
+            checkWritable(*file, "jsonl_write");
+            writeChecked(*file, line.data(), line.size(), "jsonl_write");
+            return args[0];
+        }));
+
+    // --- Terminal Built-ins ---
+
+    // term_clear() - Clears the terminal screen
+    interp.defineGlobal("clear", Value::makeNativeFunction("clear", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            Output::instance().flush();
+            platform::clearScreen();
+            return Value();
+        }));
+
+    // term_color(code) - Sets terminal text color
+    // 0-15: Standard Windows colors (mapped to ANSI colors elsewhere)
+    interp.defineGlobal("color", Value::makeNativeFunction("color", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber()) throw RuntimeError("color() expects a number code (0-15)");
+            int code = (int)args[0].asNumber();
+            Output::instance().flush();
+            platform::setTextColor(code);
+            return Value();
+        }));
+
+    // term_reset() - Resets terminal color to default
+    interp.defineGlobal("reset", Value::makeNativeFunction("reset", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            Output::instance().flush();
+            platform::resetTextColor();
+            return Value();
+        }));
+
+    // gotoxy(x, y) - Moves terminal cursor to coordinates
+    interp.defineGlobal("gotoxy", Value::makeNativeFunction("gotoxy", 2,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (!args[0].isNumber() || !args[1].isNumber()) 
+                throw RuntimeError("gotoxy() expects two numbers (x, y)");
+            int x = (int)args[0].asNumber();
+            int y = (int)args[1].asNumber();
+            Output::instance().flush();
+            platform::moveCursor(x, y);
+            return Value();
+        }));
+
+    // getch() - Waits for and returns a single character
+    interp.defineGlobal("getch", Value::makeNativeFunction("getch", 0,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            Output::instance().flush();
+            int c = platform::readKey();
+            return Value(std::string(1, (char)c));
+        }));
+
+    // url_encode(str) - percent-encodes everything but A-Z a-z 0-9 - . _ ~ (as curl_easy_escape)
+    interp.defineGlobal("url_encode", Value::makeNativeFunction("url_encode", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            static const char hex[] = "0123456789ABCDEF";
+            std::string converted;
+            std::string_view s = args[0].isString() ? args[0].asStringView()
+                                                    : std::string_view(converted = args[0].toString());
+            std::string res;
+            res.reserve(s.size());
+            for (unsigned char c : s) {
+                if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+                    res += static_cast<char>(c);
+                } else {
+                    res += '%';
+                    res += hex[c >> 4];
+                    res += hex[c & 15];
+                }
+            }
+            return Value(res);
+        }));
+
+    // url_decode(str) - decodes %XX escapes (as curl_easy_unescape; '+' stays '+')
+    interp.defineGlobal("url_decode", Value::makeNativeFunction("url_decode", 1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            std::string converted;
+            std::string_view s = args[0].isString() ? args[0].asStringView()
+                                                    : std::string_view(converted = args[0].toString());
+            auto hexValue = [](char c) { return std::isdigit((unsigned char)c) ? c - '0' : (std::tolower((unsigned char)c) - 'a' + 10); };
+            std::string res;
+            res.reserve(s.size());
+            for (size_t i = 0; i < s.size(); i++) {
+                if (s[i] == '%' && i + 2 < s.size() && std::isxdigit((unsigned char)s[i + 1]) &&
+                    std::isxdigit((unsigned char)s[i + 2])) {
+                    res += static_cast<char>(hexValue(s[i + 1]) * 16 + hexValue(s[i + 2]));
+                    i += 2;
+                } else {
+                    res += s[i];
+                }
+            }
+            return Value(res);
+        }));
+
+#ifndef EZ_NO_CURL
+    static int curl_init_checker = []() { curl_global_init(CURL_GLOBAL_DEFAULT); return 0; }();
+    (void)curl_init_checker;
+
+    // HTTP Helpers
+    static auto HttpWriteCallback = [](void* contents, size_t size, size_t nmemb, void* userp) -> size_t {
+        ((std::string*)userp)->append((char*)contents, size * nmemb);
+        return size * nmemb;
+    };
+
+    // http_get(url, [headers])
+    interp.defineGlobal("http_get", Value::makeNativeFunction("http_get", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty()) throw RuntimeError("http_get() expects URL");
+            std::string url = args[0].toString();
+            TraceSpan span("http", "http_get", url);
+            CURL* curl = curl_easy_init();
+            if (!curl) throw RuntimeError("CURL init failed");
+            std::string res;
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))HttpWriteCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res);
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            struct curl_slist* headers = nullptr;
+            if (args.size() > 1 && args[1].isDictionary()) {
+                for (auto& kv : args[1].asDictionary().map) {
+                    std::string h = kv.first + ": " + kv.second.toString();
+                    headers = curl_slist_append(headers, h.c_str());
+                }
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+            }
+            CURLcode code = curl_easy_perform(curl);
+            if (headers) curl_slist_free_all(headers);
+            curl_easy_cleanup(curl);
+            if (code != CURLE_OK) throw RuntimeError("http_get failed: " + std::string(curl_easy_strerror(code)));
+            return Value(res);
+        }));
+
+    // http_post(url, body, [headers])
+    interp.defineGlobal("http_post", Value::makeNativeFunction("http_post", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.size() < 2) throw RuntimeError("http_post() expects URL and body");
+            std::string url = args[0].toString();
+            std::string body = args[1].toString();
+            TraceSpan span("http", "http_post", url);
+            CURL* curl = curl_easy_init();
+            if (!curl) throw RuntimeError("CURL init failed");
+            std::string res;
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))HttpWriteCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res);
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L); // Bypass for local environments
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L); // 30 second timeout
+            
+            struct curl_slist* headers = nullptr;
+            bool hasCT = false;
+            if (args.size() > 2 && args[2].isDictionary()) {
+                for (auto& kv : args[2].asDictionary().map) {
+                    std::string k = kv.first;
+                    std::string h = k + ": " + kv.second.toString();
+                    headers = curl_slist_append(headers, h.c_str());
+                    if (k == "Content-Type") hasCT = true;
+                }
+            }
+            if (!hasCT && !body.empty() && (body[0] == '{' || body[0] == '[')) {
+                headers = curl_slist_append(headers, "Content-Type: application/json");
+            }
+            if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+            CURLcode code = curl_easy_perform(curl);
+            if (headers) curl_slist_free_all(headers);
+            curl_easy_cleanup(curl);
+            if (code != CURLE_OK) throw RuntimeError("http_post failed: " + std::string(curl_easy_strerror(code)));
+            return Value(res);
+        }));
+#else
+    for (const char* name : {"http_get", "http_post"}) {
+        interp.defineGlobal(name, Value::makeNativeFunction(name, -1,
+            [name](Interpreter&, const std::vector<Value>&) -> Value {
+                throw RuntimeError(std::string(name) + "() is not available: ez was built without libcurl");
+            }));
+    }
+#endif
+
+    // Database Aliases
+    auto globalEnv = interp.getGlobalEnv();
+    interp.defineGlobal("db_open", globalEnv->get("dbOpen", 0));
+    interp.defineGlobal("db_execute", globalEnv->get("dbExec", 0));
+    interp.defineGlobal("db_query", globalEnv->get("dbQuery", 0));
+    interp.defineGlobal("db_close", globalEnv->get("dbClose", 0));
+    interp.defineGlobal("db_last_insert_id", globalEnv->get("dbLastInsertId", 0));
+    interp.defineGlobal("db_begin", globalEnv->get("dbBegin", 0));
+    interp.defineGlobal("db_commit", globalEnv->get("dbCommit", 0));
+    interp.defineGlobal("db_rollback", globalEnv->get("dbRollback", 0));
+    // --- Async / Multithreading ---
+
+    // spawn(fn, args...)
+    interp.defineGlobal("spawn", Value::makeNativeFunction("spawn", -1,
+        [](Interpreter& parentInterp, const std::vector<Value>& args) -> Value {
+            if (args.empty() || !args[0].isCallable()) throw RuntimeError("spawn() expects function");
+            
+            Value func = args[0];
+            std::vector<Value> fnArgs(args.begin() + 1, args.end());
+            auto globalEnv = parentInterp.getGlobalEnv();
+            
+            // Launch async task
+            std::shared_future<Value> fut = std::async(std::launch::async, 
+                [globalEnv, func, fnArgs]() -> Value {
+                    Interpreter threadInterp;
+                    threadInterp.setGlobalEnv(globalEnv);
+                    threadInterp.setThreadName("<spawn>");
+                    TraceSpan span("task", func.isFunction() ? func.asFunction()->name : "spawn");
+                    return threadInterp.callFunction(func, fnArgs, 0);
+                }).share();
+                
+            return Value::makeFuture(fut);
+        }));
+
+    // await(future)
+    auto awaitFn = [](Interpreter&, const std::vector<Value>& args) -> Value {
+        if (!args[0].isFuture()) throw RuntimeError("await() expects future");
+        auto fut = args[0].asFuture();
+        TraceSpan span("await", "await");
+        fut->wait();
+        return fut->get();
+    };
+    interp.defineGlobal("await", Value::makeNativeFunction("await", 1, awaitFn));
+    interp.defineGlobal("sync", Value::makeNativeFunction("sync", 1, awaitFn));
+
+#ifndef EZ_NO_CURL
+    // fetch(url, [options])
+    interp.defineGlobal("fetch", Value::makeNativeFunction("fetch", -1,
+        [](Interpreter&, const std::vector<Value>& args) -> Value {
+            if (args.empty()) throw RuntimeError("fetch() expects URL");
+            std::string url = args[0].toString();
+            Value options;
+            if (args.size() > 1) options = args[1];
+            
+            // Capture args by value for thread
+            std::shared_future<Value> fut = std::async(std::launch::async, 
+                [url, options]() -> Value {
+                    Trace::instance().nameThread("<fetch>");
+                    TraceSpan span("http", "fetch", url);
+                    CURL* curl = curl_easy_init();
+                    if (!curl) throw RuntimeError("CURL init failed");
+                    
+                    std::string response;
+                    std::string method = "GET";
+                    std::string body;
+                    struct curl_slist* headers = nullptr;
+                    
+                    if (options.isDictionary()) {
+                        const auto& opts = options.asDictionary().map;
+                        if (opts.count("method")) method = opts.at("method").toString();
+                        if (opts.count("body")) body = opts.at("body").toString();
+                        if (opts.count("headers") && opts.at("headers").isDictionary()) {
+                            for (const auto& kv : opts.at("headers").asDictionary().map) {
+                                std::string h = kv.first + ": " + kv.second.toString();
+                                headers = curl_slist_append(headers, h.c_str());
+                            }
+                        }
+                    }
+                    
+                    auto writeCb = [](void* contents, size_t size, size_t nmemb, void* userp) -> size_t {
+                        ((std::string*)userp)->append((char*)contents, size * nmemb);
+                        return size * nmemb;
+                    };
+
+                    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+                    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (size_t(*)(void*,size_t,size_t,void*))writeCb);
+                    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+                    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+                    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+                    
+                    if (method == "POST") {
+                        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+                        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+                    } else if (method != "GET") {
+                        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+                    }
+                    
+                    if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+                    
+                    CURLcode res = curl_easy_perform(curl);
+                    if (headers) curl_slist_free_all(headers);
+                    curl_easy_cleanup(curl);
+                    
+                    if (res != CURLE_OK) {
+                         throw RuntimeError("Fetch failed: " + std::string(curl_easy_strerror(res)));
+                    }
+                    
+                    return Value(response);
+                }).share();
+                
+            return Value::makeFuture(fut);
+        }));
+#else
+    interp.defineGlobal("fetch", Value::makeNativeFunction("fetch", -1,
+        [](Interpreter&, const std::vector<Value>&) -> Value {
+            throw RuntimeError("fetch() is not available: ez was built without libcurl");
+        }));
+#endif
+
+}
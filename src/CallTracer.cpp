@@ -0,0 +1,136 @@
+#include "CallTracer.h"
+#include "Json.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+bool CallTracer::enabled = false;
+
+CallTracer::ThreadTable& CallTracer::threadTable() {
+    struct Holder {
+        std::shared_ptr<ThreadTable> table;
+        Holder() : table(std::make_shared<ThreadTable>()) {
+            table->active.reserve(64);
+            CallTracer& tracer = instance();
+            std::lock_guard<std::mutex> lock(tracer.mutex);
+            tracer.tables.push_back(table);
+        }
+        ~Holder() { instance().retire(table); }
+    };
+    thread_local Holder holder;
+    return *holder.table;
+}
+
+void CallTracer::merge(StatsMap& into, const StatsMap& from) {
+    for (const auto& entry : from) {
+        Stats& m = into[entry.first];
+        m.kind = entry.second.kind;
+        m.calls += entry.second.calls;
+        m.total += entry.second.total;
+        m.self += entry.second.self;
+    }
+}
+
+void CallTracer::retire(const std::shared_ptr<ThreadTable>& table) {
+    std::lock_guard<std::mutex> lock(mutex);
+    {
+        std::lock_guard<std::mutex> tableLock(table->mutex);
+        merge(finished, table->stats);
+    }
+    tables.erase(std::remove(tables.begin(), tables.end(), table), tables.end());
+}
+
+CallTracer::Scope::Scope(std::string_view owner, std::string_view name, Kind kind) {
+    ThreadTable& table = threadTable();
+    std::string key;
+    key.reserve(owner.size() + name.size() + 1);
+    if (!owner.empty()) {
+        key += owner;
+        key += '.';
+    }
+    key += name;
+
+    std::lock_guard<std::mutex> lock(table.mutex);
+    Stats& stats = table.stats[key];
+    stats.kind = kind;
+    stats.calls++;
+    stats.active++;
+    table.active.push_back(ActiveCall{&stats, Clock::now()});
+}
+
+CallTracer::Scope::~Scope() {
+    Clock::time_point end = Clock::now();
+    ThreadTable& table = threadTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    ActiveCall call = table.active.back();
+    table.active.pop_back();
+
+    Clock::duration elapsed = end - call.start;
+    call.stats->self += elapsed - call.children;
+    if (--call.stats->active == 0) call.stats->total += elapsed;
+    if (!table.active.empty()) table.active.back().children += elapsed;
+}
+
+void CallTracer::start(const std::string& path) {
+    jsonPath = path;
+    enabled = true;
+    started = true;
+    std::atexit([] { CallTracer::instance().stop(); });
+}
+
+void CallTracer::stop() {
+    // Merge the tables of exited threads with those still running
+    StatsMap merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) return;
+        started = false;
+        enabled = false;
+        merged = finished;
+        for (const auto& table : tables) {
+            std::lock_guard<std::mutex> tableLock(table->mutex);
+            merge(merged, table->stats);
+        }
+    }
+
+    std::vector<std::pair<std::string, Stats>> rows(merged.begin(), merged.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.self != b.second.self ? a.second.self > b.second.self : a.first < b.first;
+    });
+
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::fprintf(stderr, "\nCalls (all threads, sorted by self time)\n");
+    std::fprintf(stderr, "  %10s  %11s  %11s  %10s  %-6s  %s\n", "calls", "total ms", "self ms", "avg us", "kind", "function");
+    for (const auto& row : rows) {
+        const Stats& s = row.second;
+        std::fprintf(stderr, "  %10llu  %11.3f  %11.3f  %10.2f  %-6s  %s\n",
+                     static_cast<unsigned long long>(s.calls), ms(s.total), ms(s.self),
+                     s.calls ? ms(s.total) * 1000.0 / static_cast<double>(s.calls) : 0.0,
+                     s.kind == Kind::NATIVE ? "native" : "task", row.first.c_str());
+    }
+
+    if (jsonPath.empty()) return;
+    std::vector<Value> items;
+    for (const auto& row : rows) {
+        const Stats& s = row.second;
+        Value item = Value::makeDictionary();
+        auto& map = item.asDictionary().map;
+        map["function"] = Value(row.first);
+        map["kind"] = Value(s.kind == Kind::NATIVE ? "native" : "task");
+        map["calls"] = Value(static_cast<double>(s.calls));
+        map["total_ms"] = Value(ms(s.total));
+        map["self_ms"] = Value(ms(s.self));
+        items.push_back(item);
+    }
+    std::string text;
+    json::write(Value::makeArray(items), text, true);
+    text += '\n';
+    FILE* out = std::fopen(jsonPath.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "trace-calls: could not write '%s'\n", jsonPath.c_str());
+        return;
+    }
+    std::fwrite(text.data(), 1, text.size(), out);
+    std::fclose(out);
+}
@@ -0,0 +1,91 @@
+#ifndef CALLTRACER_H
+#define CALLTRACER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Instrumenting profiler behind `ez --trace-calls`.
+//
+// Interpreter::callFunction opens a CallTracer::Scope around every call
+// while enabled, which counts calls and measures inclusive (total) and
+// exclusive (self) time per task, lambda, model method and builtin. When
+// disabled the cost is the one `if (CallTracer::enabled)` branch.
+//
+// Each thread records into its own table (guarded by a mutex that only the
+// report ever contends for), so spawn tasks and server handlers are
+// included. A thread's table is folded into a shared total when the thread
+// exits, so a server keeps one table per live connection, not one per
+// connection ever served. Recursive calls count toward total time only at the outermost
+// level, so a function's total never exceeds the wall time it was active.
+class CallTracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Set before any script code runs; read without synchronization
+    static bool enabled;
+
+    enum class Kind { TASK, NATIVE };
+
+    struct Stats {
+        Kind kind = Kind::TASK;
+        uint64_t calls = 0;
+        Clock::duration total{0};
+        Clock::duration self{0};
+        int active = 0;  // recursion depth right now
+    };
+
+    // Times one call for as long as it is in scope
+    class Scope {
+    public:
+        Scope(std::string_view owner, std::string_view name, Kind kind);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    static CallTracer& instance() {
+        static CallTracer tracer;
+        return tracer;
+    }
+
+    // jsonPath may be empty: then only the text table is printed
+    void start(const std::string& jsonPath);
+    // Prints the table to stderr and writes the JSON file; runs once
+    void stop();
+
+private:
+    CallTracer() = default;
+
+    struct ActiveCall {
+        Stats* stats;
+        Clock::time_point start;
+        Clock::duration children{0};
+    };
+
+    struct ThreadTable {
+        std::mutex mutex;
+        std::unordered_map<std::string, Stats> stats;
+        std::vector<ActiveCall> active;
+    };
+
+    using StatsMap = std::unordered_map<std::string, Stats>;
+
+    static ThreadTable& threadTable();
+    static void merge(StatsMap& into, const StatsMap& from);
+    // Folds an exiting thread's table into `finished` and drops it
+    void retire(const std::shared_ptr<ThreadTable>& table);
+
+    std::mutex mutex;  // guards tables, finished and started
+    std::vector<std::shared_ptr<ThreadTable>> tables;
+    StatsMap finished;
+    std::string jsonPath;
+    bool started = false;
+};
+
+#endif // CALLTRACER_H
@@ -0,0 +1,82 @@
+#ifndef EZSTRING_H
+#define EZSTRING_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "Memory.h"
+
+// Immutable string value.
+//
+// An EZString either owns its bytes or is a view of a range inside another,
+// owning EZString (the root), which the view keeps alive. substr, slice,
+// split, readLines and string indexing go through slice(), so taking a large
+// piece of a string shares the parent's buffer instead of copying it.
+//
+// Pieces shorter than INLINE_LIMIT are copied anyway: they fit in
+// std::string's inline buffer, so the copy costs no extra allocation, and a
+// tiny piece should not pin a large parent. Single characters come from a
+// shared table, so `str[i]` and `get c in str` do not allocate at all.
+class EZString {
+public:
+    static constexpr size_t INLINE_LIMIT = 16;
+
+    EZString() = default;
+    explicit EZString(std::string s) : owned(std::move(s)) {}
+
+    // View of `length` bytes at `at` inside root (which must be owning)
+    EZString(std::shared_ptr<const EZString> root, const char* at, size_t length)
+        : root(std::move(root)), viewData(at), viewSize(length) {}
+
+    EZString(const EZString&) = delete;
+    EZString& operator=(const EZString&) = delete;
+
+    const char* data() const { return root ? viewData : owned.data(); }
+    size_t size() const { return root ? viewSize : owned.size(); }
+    bool empty() const { return size() == 0; }
+    std::string_view view() const { return std::string_view(data(), size()); }
+    bool isView() const { return root != nullptr; }
+
+    // The contents as a std::string. A view copies its bytes out the first
+    // time this is called; prefer view() where a string_view will do.
+    const std::string& str() const {
+        if (root) {
+            std::call_once(materialized, [this] { owned.assign(viewData, viewSize); });
+        }
+        return owned;
+    }
+
+    // In-place append for the `s += x` fast path. Only valid on an owning
+    // string that no other value can see (use_count() == 1).
+    void append(std::string_view more) { owned.append(more.data(), more.size()); }
+
+    // Bytes [offset, offset + length) of s; the caller checks the bounds
+    static std::shared_ptr<EZString> slice(const std::shared_ptr<EZString>& s, size_t offset, size_t length) {
+        if (length == 1) return ofChar(static_cast<unsigned char>(s->data()[offset]));
+        if (offset == 0 && length == s->size()) return s;
+        if (length < INLINE_LIMIT) return memory::make<EZString>(std::string(s->data() + offset, length));
+        std::shared_ptr<const EZString> owner = s->root ? s->root : s;
+        return memory::make<EZString>(std::move(owner), s->data() + offset, length);
+    }
+
+    // Shared one-character string
+    static const std::shared_ptr<EZString>& ofChar(unsigned char c) {
+        static const auto table = [] {
+            std::unique_ptr<std::shared_ptr<EZString>[]> t(new std::shared_ptr<EZString>[256]);
+            for (int i = 0; i < 256; i++) t[i] = memory::make<EZString>(std::string(1, static_cast<char>(i)));
+            return t;
+        }();
+        return table[c];
+    }
+
+private:
+    mutable std::string owned;                 // contents, or a view's copy once str() was called
+    std::shared_ptr<const EZString> root;      // set for views
+    const char* viewData = nullptr;
+    size_t viewSize = 0;
+    mutable std::once_flag materialized;
+};
+
+#endif // EZSTRING_H
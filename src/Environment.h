@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <shared_mutex>
 #include "Value.h"
+#include "Trace.h"
 
 class RuntimeError : public std::runtime_error {
 public:
@@ -26,13 +27,13 @@ public:
     
     // Define a new variable in current scope
     void define(const std::string& name, const Value& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         variables[name] = value;
     }
     
     // Get a variable (walks up parent chain)
     Value get(const std::string& name, int line = 0) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         auto it = variables.find(name);
         if (it != variables.end()) {
             return it->second;
@@ -45,9 +46,37 @@ public:
         throw RuntimeError("Undefined variable '" + name + "'", line);
     }
     
+    // Copies a variable's value into out (walks up parent chain); false if
+    // it is not defined
+    bool tryGet(const std::string& name, Value& out) const {
+        auto lock = readLock();
+        auto it = variables.find(name);
+        if (it != variables.end()) {
+            out = it->second;
+            return true;
+        }
+        lock.unlock();
+        return parent && parent->tryGet(name, out);
+    }
+    
+    // Runs f(value) on a variable under its scope's write lock (walks up
+    // parent chain), so a read-modify-write cannot interleave with another
+    // thread's. f must not touch any Environment. False if not defined.
+    template <typename F>
+    bool update(const std::string& name, F&& f) {
+        auto lock = writeLock();
+        auto it = variables.find(name);
+        if (it != variables.end()) {
+            f(it->second);
+            return true;
+        }
+        lock.unlock();
+        return parent && parent->update(name, std::forward<F>(f));
+    }
+    
     // Check if variable exists
     bool contains(const std::string& name) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         if (variables.find(name) != variables.end()) {
             return true;
         }
@@ -59,7 +88,7 @@ public:
     
     // Assign to existing variable (walks up parent chain)
     void assign(const std::string& name, const Value& value, int line = 0) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         auto it = variables.find(name);
         if (it != variables.end()) {
             it->second = value;
@@ -97,7 +126,7 @@ public:
     // Mutex doesn't protect the pointer after return.
     // Keeping as is but noting risk.
     Value* getPtr(const std::string& name) {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         auto it = variables.find(name);
         if (it != variables.end()) {
             return &it->second;
@@ -112,7 +141,29 @@ public:
     
     // Create a child scope
     std::shared_ptr<Environment> createChild() {
-        return std::make_shared<Environment>(shared_from_this());
+        return memory::make<Environment>(shared_from_this());
+    }
+
+private:
+    // Under --trace, a lock that is already held is waited for inside a
+    // "lock" span, so convoys on a shared scope show up on the timeline
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        if (!Trace::enabled) return std::unique_lock<std::shared_mutex>(mutex);
+        std::unique_lock<std::shared_mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            TraceSpan span("lock", "Environment write");
+            lock.lock();
+        }
+        return lock;
+    }
+    std::shared_lock<std::shared_mutex> readLock() const {
+        if (!Trace::enabled) return std::shared_lock<std::shared_mutex>(mutex);
+        std::shared_lock<std::shared_mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            TraceSpan span("lock", "Environment read");
+            lock.lock();
+        }
+        return lock;
     }
 };
 
@@ -0,0 +1,96 @@
+#ifndef FILEHANDLE_H
+#define FILEHANDLE_H
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Open file returned by open(path, mode).
+//
+// Wraps a stdio FILE with a 1 MB buffer, so many small write()/writeLine()
+// calls turn into a few large write syscalls instead of one open/write/close
+// per call. Files are opened in binary mode: writeLine always writes "\n",
+// and readLine accepts both "\n" and "\r\n". The mutex lets a handle be
+// shared with spawned tasks.
+struct EZFile {
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    std::string path;
+    std::string mode;
+    FILE* fp = nullptr;
+    std::vector<char> buffer;
+    std::mutex mutex;
+
+    EZFile(const std::string& path, const std::string& mode) : path(path), mode(mode) {}
+    ~EZFile() { close(); }
+
+    EZFile(const EZFile&) = delete;
+    EZFile& operator=(const EZFile&) = delete;
+
+    // Accepts r, w, a, r+, w+, a+; returns false if the file cannot be opened
+    bool open() {
+        static const char* const modes[] = {"r", "w", "a", "r+", "w+", "a+"};
+        bool known = false;
+        for (const char* m : modes) known = known || mode == m;
+        if (!known) return false;
+
+        std::string stdioMode = mode;
+        stdioMode.insert(1, "b");
+        fp = std::fopen(path.c_str(), stdioMode.c_str());
+        if (!fp) return false;
+        buffer.resize(BUFFER_SIZE);
+        std::setvbuf(fp, buffer.data(), _IOFBF, buffer.size());
+        return true;
+    }
+
+    bool isOpen() const { return fp != nullptr; }
+    bool canRead() const { return mode[0] == 'r' || mode.find('+') != std::string::npos; }
+    bool canWrite() const { return mode[0] != 'r' || mode.find('+') != std::string::npos; }
+
+    bool write(const char* data, size_t len) {
+        return std::fwrite(data, 1, len, fp) == len;
+    }
+
+    // Next line without its terminator; false at end of file
+    bool readLine(std::string& out) {
+        out.clear();
+        char chunk[4096];
+        bool any = false;
+        while (std::fgets(chunk, sizeof(chunk), fp)) {
+            any = true;
+            size_t len = std::strlen(chunk);
+            if (len > 0 && chunk[len - 1] == '\n') {
+                out.append(chunk, len - 1);
+                if (!out.empty() && out.back() == '\r') out.pop_back();
+                return true;
+            }
+            out.append(chunk, len);
+        }
+        return any;
+    }
+
+    // Up to `n` bytes; empty at end of file
+    std::string readChunk(size_t n) {
+        std::string out(n, '\0');
+        size_t got = std::fread(&out[0], 1, n, fp);
+        out.resize(got);
+        return out;
+    }
+
+    bool flush() { return std::fflush(fp) == 0; }
+
+    // False if buffered data could not be written out (the handle is
+    // closed either way); closing a closed handle succeeds
+    bool close() {
+        if (!fp) return true;
+        bool ok = std::fclose(fp) == 0;
+        fp = nullptr;
+        buffer.clear();
+        buffer.shrink_to_fit();
+        return ok;
+    }
+};
+
+#endif // FILEHANDLE_H
@@ -64,12 +64,12 @@ private:
 
 // Helper to create GC-tracked string
 inline Value::StringPtr makeGCString(const std::string& str) {
-    return GarbageCollector::instance().track(std::make_shared<std::string>(str));
+    return GarbageCollector::instance().track(memory::make<EZString>(str));
 }
 
 // Helper to create GC-tracked array
 inline Value::ArrayPtr makeGCArray(const std::vector<Value>& elements = {}) {
-    return GarbageCollector::instance().track(std::make_shared<Value::ArrayType>(elements));
+    return GarbageCollector::instance().track(memory::make<Value::ArrayType>(elements));
 }
 
 #endif // GC_H
@@ -0,0 +1,92 @@
+#include "Generator.h"
+#include "Interpreter.h"
+#include <system_error>
+
+void GeneratorChannel::yield(const Value& v) {
+    std::unique_lock<std::mutex> lock(mutex);
+    value = v;
+    hasValue = true;
+    requested = false;
+    cv.notify_all();
+    cv.wait(lock, [this] { return requested || cancelled; });
+    if (cancelled) throw GeneratorExit();
+}
+
+GeneratorIterator::GeneratorIterator(std::shared_ptr<EZFunction> func, std::shared_ptr<Environment> env,
+                                     std::shared_ptr<Environment> globals)
+    : func(std::move(func)), env(std::move(env)), globals(std::move(globals)),
+      channel(std::make_shared<GeneratorChannel>()) {}
+
+GeneratorIterator::~GeneratorIterator() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->cancelled = true;
+    }
+    channel->cv.notify_all();
+
+    // The last reference can be dropped by the body itself (e.g. it
+    // overwrites the variable holding its own generator); joining would
+    // then wait on ourselves. The thread owns its channel, so it can
+    // safely finish on its own.
+    if (worker.get_id() == std::this_thread::get_id()) {
+        worker.detach();
+    } else {
+        worker.join();
+    }
+}
+
+bool GeneratorIterator::next(Interpreter&, Value& out) {
+    if (exhausted) return false;
+
+    std::unique_lock<std::mutex> lock(channel->mutex);
+    channel->requested = true;
+    if (!worker.joinable()) {
+        // First request: only now does the body start running
+        try {
+            worker = std::thread(&GeneratorIterator::run, channel, func, env, globals);
+        } catch (const std::system_error&) {
+            channel->requested = false;
+            throw RuntimeError("Cannot start generator '" + func->name +
+                               "': out of threads (every generator that has started and not finished holds one)");
+        }
+    } else {
+        channel->cv.notify_all();
+    }
+    channel->cv.wait(lock, [this] { return channel->hasValue || channel->finished; });
+
+    if (channel->hasValue) {
+        out = std::move(channel->value);
+        channel->value = Value();
+        channel->hasValue = false;
+        return true;
+    }
+
+    exhausted = true;
+    std::exception_ptr error = channel->error;
+    channel->error = nullptr;
+    lock.unlock();
+    worker.join();
+    if (error) std::rethrow_exception(error);
+    return false;
+}
+
+void GeneratorIterator::run(std::shared_ptr<GeneratorChannel> channel, std::shared_ptr<EZFunction> func,
+                            std::shared_ptr<Environment> env, std::shared_ptr<Environment> globals) {
+    std::exception_ptr error;
+    try {
+        Interpreter threadInterp(globals);
+        threadInterp.setThreadName("<generator>");
+        threadInterp.setSourceFile(func->file);
+        threadInterp.runGenerator(func->body, env, channel.get());
+    } catch (const GeneratorExit&) {
+        // Consumer is gone; nothing to report
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    channel->finished = true;
+    channel->error = error;
+    channel->cv.notify_all();
+}
@@ -0,0 +1,63 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Value.h"
+
+// Generators (tasks whose body contains `yield`).
+//
+// Calling a generator task returns a GeneratorIterator without running
+// anything. The body runs on its own thread with its own Interpreter, and
+// hands values over one at a time through a GeneratorChannel: the consumer
+// asks for a value, the body runs until its next `yield`, then blocks until
+// the consumer asks again. Only one side runs at a time, so the body sees
+// the same ordering of side effects as a normal loop, and nothing is
+// buffered ahead of the consumer.
+
+// Raised inside the body when the consumer drops the generator early.
+// Not a RuntimeError, so a `try` in the body cannot swallow it.
+class GeneratorExit : public std::exception {};
+
+class GeneratorChannel {
+public:
+    // Producer side: hand `value` over and wait until the next one is wanted
+    void yield(const Value& value);
+
+private:
+    friend class GeneratorIterator;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool requested = false;   // consumer is waiting for a value
+    bool hasValue = false;    // value below is ready to be taken
+    bool finished = false;    // body ran to completion (or failed)
+    bool cancelled = false;   // consumer went away
+    Value value;
+    std::exception_ptr error;
+};
+
+class GeneratorIterator : public EZIterator {
+public:
+    GeneratorIterator(std::shared_ptr<EZFunction> func, std::shared_ptr<Environment> env,
+                      std::shared_ptr<Environment> globals);
+    ~GeneratorIterator() override;
+
+    bool next(Interpreter& interp, Value& out) override;
+
+private:
+    std::shared_ptr<EZFunction> func;
+    std::shared_ptr<Environment> env;      // parameters already bound
+    std::shared_ptr<Environment> globals;
+    std::shared_ptr<GeneratorChannel> channel;  // shared with the worker thread
+    std::thread worker;
+    bool exhausted = false;
+
+    static void run(std::shared_ptr<GeneratorChannel> channel, std::shared_ptr<EZFunction> func,
+                    std::shared_ptr<Environment> env, std::shared_ptr<Environment> globals);
+};
+
+#endif // GENERATOR_H
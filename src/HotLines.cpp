@@ -0,0 +1,163 @@
+#include "HotLines.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+bool HotLines::enabled = false;
+
+namespace {
+
+// Marks the line of every statement below stmts (blocks excluded: their
+// line is the line of the statement that owns them)
+void markStatements(const std::vector<StmtPtr>& stmts, std::vector<char>& marks);
+
+void markStatement(const StmtPtr& stmt, std::vector<char>& marks) {
+    if (!stmt) return;
+    auto mark = [&](int line) {
+        if (line > 0 && static_cast<size_t>(line) < marks.size()) marks[line] = 1;
+    };
+    std::visit([&](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, std::shared_ptr<BlockStmt>>) {
+            markStatements(arg->statements, marks);
+            return;
+        } else {
+            mark(stmt->line);
+        }
+        if constexpr (std::is_same_v<T, std::shared_ptr<WhenStmt>>) {
+            markStatement(arg->thenBranch, marks);
+            markStatement(arg->elseBranch, marks);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<WhileStmt>> ||
+                             std::is_same_v<T, std::shared_ptr<RepeatStmt>> ||
+                             std::is_same_v<T, std::shared_ptr<GetStmt>>) {
+            markStatement(arg->body, marks);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<TaskStmt>>) {
+            markStatements(arg->body, marks);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<ModelStmt>>) {
+            markStatements(arg->initBody, marks);
+            for (const auto& member : arg->members) markStatements(member.body, marks);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<TryStmt>>) {
+            markStatement(arg->tryBlock, marks);
+            markStatement(arg->catchBlock, marks);
+        }
+    }, stmt->variant);
+}
+
+void markStatements(const std::vector<StmtPtr>& stmts, std::vector<char>& marks) {
+    for (const auto& stmt : stmts) markStatement(stmt, marks);
+}
+
+} // namespace
+
+void HotLines::start(const std::string& path) {
+    outPath = path;
+    enabled = true;
+    started = true;
+    std::atexit([] { HotLines::instance().stop(); });
+}
+
+int HotLines::addFile(const std::string& path, const std::string& source, const std::vector<StmtPtr>& statements) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < owned.size(); i++) {
+        if (owned[i]->path == path) return static_cast<int>(i);
+    }
+    if (owned.size() >= MAX_FILES) return -1;
+
+    auto file = std::make_unique<File>();
+    file->path = path;
+    size_t begin = 0;
+    while (begin <= source.size()) {
+        size_t end = source.find('\n', begin);
+        if (end == std::string::npos) end = source.size();
+        std::string text = source.substr(begin, end - begin);
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        file->lines.push_back(std::move(text));
+        begin = end + 1;
+    }
+    if (!source.empty() && source.back() == '\n') file->lines.pop_back();
+
+    file->size = file->lines.size() + 1;
+    file->counters.reset(new Counter[file->size]);
+    std::vector<char> marks(file->size, 0);
+    markStatements(statements, marks);
+    for (size_t line = 1; line < file->size; line++) file->counters[line].statement = marks[line] != 0;
+
+    int index = static_cast<int>(owned.size());
+    files[index].store(file.get(), std::memory_order_release);
+    owned.push_back(std::move(file));
+    return index;
+}
+
+void HotLines::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!started) return;
+    started = false;
+    enabled = false;
+
+    struct Row {
+        const File* file;
+        int line;
+        uint64_t count;
+        uint64_t nanos;
+    };
+    std::vector<Row> rows;
+    uint64_t totalNanos = 0;
+    size_t statementLines = 0, executedLines = 0;
+    for (const auto& file : owned) {
+        for (size_t line = 1; line < file->size; line++) {
+            const Counter& c = file->counters[line];
+            uint64_t count = c.count.load(std::memory_order_relaxed);
+            uint64_t nanos = c.nanos.load(std::memory_order_relaxed);
+            totalNanos += nanos;
+            if (c.statement || count) statementLines++;
+            if (count) {
+                executedLines++;
+                rows.push_back(Row{file.get(), static_cast<int>(line), count, nanos});
+            }
+        }
+    }
+    double total = totalNanos > 0 ? static_cast<double>(totalNanos) : 1.0;
+
+    FILE* out = std::fopen(outPath.c_str(), "wb");
+    if (out) {
+        for (const auto& file : owned) {
+            uint64_t fileNanos = 0;
+            for (size_t line = 1; line < file->size; line++) fileNanos += file->counters[line].nanos.load();
+            std::fprintf(out, "== %s  (%.3f ms, %.1f%% of the time) ==\n", file->path.c_str(), fileNanos / 1e6,
+                         100.0 * fileNanos / total);
+            std::fprintf(out, "%12s %10s %6s  %-10s %5s\n", "count", "ms", "heat", "", "line");
+            for (size_t line = 1; line < file->size; line++) {
+                const Counter& c = file->counters[line];
+                uint64_t count = c.count.load(std::memory_order_relaxed);
+                const char* source = file->lines[line - 1].c_str();
+                if (!count) {
+                    std::fprintf(out, "%12s %10s %6s  %-10s %5zu | %s\n", c.statement ? "#####" : "", "", "", "", line,
+                                 source);
+                    continue;
+                }
+                double heat = 100.0 * c.nanos.load(std::memory_order_relaxed) / total;
+                std::string bar(static_cast<size_t>(std::min(10.0, heat / 10.0 + 0.5)), '#');
+                std::fprintf(out, "%12llu %10.3f %5.1f%%  %-10s %5zu | %s\n", static_cast<unsigned long long>(count),
+                             c.nanos.load(std::memory_order_relaxed) / 1e6, heat, bar.c_str(), line, source);
+            }
+            std::fprintf(out, "\n");
+        }
+        std::fclose(out);
+    } else {
+        std::fprintf(stderr, "hotlines: could not write '%s'\n", outPath.c_str());
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.nanos > b.nanos; });
+    std::fprintf(stderr, "\nHot lines (%.3f ms in statements; listing in %s)\n", totalNanos / 1e6, outPath.c_str());
+    std::fprintf(stderr, "  %6s  %10s  %12s  %s\n", "heat", "ms", "count", "line");
+    for (size_t i = 0; i < rows.size() && i < SUMMARY_ROWS; i++) {
+        const Row& r = rows[i];
+        std::string text = r.file->lines[r.line - 1];
+        text.erase(0, text.find_first_not_of(" \t"));
+        if (text.size() > 60) text = text.substr(0, 57) + "...";
+        std::fprintf(stderr, "  %5.1f%%  %10.3f  %12llu  %s:%d  %s\n", 100.0 * r.nanos / total, r.nanos / 1e6,
+                     static_cast<unsigned long long>(r.count), r.file->path.c_str(), r.line, text.c_str());
+    }
+    std::fprintf(stderr, "Coverage: %zu of %zu statement lines executed (%.1f%%)\n", executedLines, statementLines,
+                 statementLines ? 100.0 * executedLines / statementLines : 0.0);
+}
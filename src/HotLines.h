@@ -0,0 +1,122 @@
+#ifndef HOTLINES_H
+#define HOTLINES_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AST.h"
+
+// Per-line execution counters behind `ez --hotlines`.
+//
+// Every source file the interpreter runs (the script and each `use`d
+// module) gets a flat array of counters indexed by line number. Each
+// executed statement bumps its line's count, and the time until the next
+// statement starts (or until it finishes, for statements containing
+// others) is charged to its line, so a line's time is its own work plus
+// the builtins it calls, but not the tasks it calls: their lines are
+// charged instead.
+//
+// On exit an annotated listing of every file is written, with the count,
+// milliseconds and share of the total time next to each line. Statement
+// lines that never ran are marked ##### (as gcov does), which makes the
+// same listing a coverage report. A summary of the hottest lines and the
+// coverage goes to stderr.
+class HotLines {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int MAX_FILES = 256;
+    static constexpr size_t SUMMARY_ROWS = 10;
+
+    // Set before any script code runs; read without synchronization
+    static bool enabled;
+
+    static HotLines& instance() {
+        static HotLines hotLines;
+        return hotLines;
+    }
+
+    struct Counter {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> nanos{0};
+        bool statement = false;  // a statement starts on this line
+    };
+
+    // What one interpreter is charging time to right now
+    struct Cursor {
+        Counter* current = nullptr;
+        Clock::time_point mark;
+    };
+
+    // Counts one statement and charges time to its line while it runs
+    class Scope {
+    public:
+        Scope(Cursor& cursor, int file, int line) : cursor(cursor) {
+            if (!enabled) return;
+            Counter* counter = instance().counter(file, line);
+            if (!counter) return;
+            active = true;
+            Clock::time_point now = Clock::now();
+            charge(now);
+            previous = cursor.current;
+            cursor.current = counter;
+            counter->count.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~Scope() {
+            if (!active) return;
+            charge(Clock::now());
+            cursor.current = previous;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Cursor& cursor;
+        Counter* previous = nullptr;
+        bool active = false;
+
+        void charge(Clock::time_point now) {
+            if (cursor.current) {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - cursor.mark).count();
+                cursor.current->nanos.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+            }
+            cursor.mark = now;
+        }
+    };
+
+    void start(const std::string& outPath);
+    // Writes the listing and the summary; runs once
+    void stop();
+
+    // Registers a parsed file and returns its index (the same index again
+    // for a path seen before), or -1 once MAX_FILES are registered
+    int addFile(const std::string& path, const std::string& source, const std::vector<StmtPtr>& statements);
+
+    Counter* counter(int file, int line) const {
+        if (file < 0 || file >= MAX_FILES) return nullptr;
+        const File* f = files[file].load(std::memory_order_acquire);
+        if (!f || line <= 0 || static_cast<size_t>(line) >= f->size) return nullptr;
+        return &f->counters[line];
+    }
+
+private:
+    HotLines() = default;
+
+    struct File {
+        std::string path;
+        std::vector<std::string> lines;
+        size_t size = 0;  // counters: one per line, plus unused index 0
+        std::unique_ptr<Counter[]> counters;
+    };
+
+    std::atomic<const File*> files[MAX_FILES] = {};
+    std::vector<std::unique_ptr<File>> owned;  // guarded by mutex
+    std::mutex mutex;
+    std::string outPath;
+    bool started = false;
+};
+
+#endif // HOTLINES_H
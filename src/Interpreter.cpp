@@ -9,15 +9,20 @@
 #include "Lexer.h"
 #include "Parser.h"
 #include "MiniJson.h"
+#include "Generator.h"
+#include "Simd.h"
+#include "Output.h"
+#include "CallTracer.h"
 
 Interpreter::Interpreter() {
-    globalEnv = std::make_shared<Environment>();
+    globalEnv = memory::make<Environment>();
     currentEnv = globalEnv;
     GarbageCollector::instance().setRoot(globalEnv);
     
     // Seed random number generator
     std::srand(static_cast<unsigned>(std::time(nullptr)));
     
+    initCallStack();
     initBuiltins();
 }
 
@@ -25,9 +30,85 @@ Interpreter::Interpreter(std::shared_ptr<Environment> startEnv) {
     globalEnv = startEnv;
     currentEnv = globalEnv; // Start execution in this environment
     GarbageCollector::instance().setRoot(globalEnv);
+    initCallStack();
     // Skip initBuiltins() and srand()
 }
 
+void Interpreter::initCallStack() {
+    callStack.reserve(64);
+    callStack.push_back(CallFrame{"<main>", {}, 0});
+    profileTick = Profiler::instance().currentTick();
+}
+
+namespace {
+
+// Appends v as `+` and `out` print it; strings (and slices) are appended
+// straight from their bytes instead of through a toString() copy
+void appendText(std::string& out, const Value& v) {
+    if (v.isString()) out += v.asStringView();
+    else out += v.toString();
+}
+
+// The element a numeric index names in a sequence of `size`, truncating
+// fractions; NaN and numbers no int64_t holds are out of bounds like any
+// other, rather than undefined casts
+size_t elementIndex(const Value& index, size_t size, int line) {
+    double d = index.asNumber();
+    if (EZTypedArray::fitsInt(d)) {
+        int64_t i = static_cast<int64_t>(d);
+        if (i >= 0 && static_cast<uint64_t>(i) < size) return static_cast<size_t>(i);
+    }
+    throw RuntimeError("Array index out of bounds: " + index.toString(), line);
+}
+
+// Pushes a call frame for the duration of a call, popping it however the
+// call ends. Under --profile, pending ticks are charged to the stack as it
+// was before the push and before the pop, so the caller's line and the
+// callee (a blocking builtin included) each get their own time
+class FrameScope {
+public:
+    FrameScope(std::vector<CallFrame>& stack, uint64_t& profileTick, std::string_view name,
+               std::string_view owner = {})
+        : stack(stack), profileTick(profileTick) {
+        if (Profiler::enabled) Profiler::instance().poll(stack, profileTick);
+        stack.push_back(CallFrame{name, owner, 0});
+    }
+    ~FrameScope() {
+        if (Profiler::enabled) {
+            try {
+                Profiler::instance().poll(stack, profileTick);
+            } catch (const std::exception&) {
+                // Losing a sample beats terminating in a destructor
+            }
+        }
+        stack.pop_back();
+    }
+
+    FrameScope(const FrameScope&) = delete;
+    FrameScope& operator=(const FrameScope&) = delete;
+
+private:
+    std::vector<CallFrame>& stack;
+    uint64_t& profileTick;
+};
+
+// Switches the interpreter's current source file for the duration of a
+// call into code defined in another file
+class SourceFileScope {
+public:
+    SourceFileScope(int& current, int file) : current(current), saved(current) { current = file; }
+    ~SourceFileScope() { current = saved; }
+
+    SourceFileScope(const SourceFileScope&) = delete;
+    SourceFileScope& operator=(const SourceFileScope&) = delete;
+
+private:
+    int& current;
+    int saved;
+};
+
+} // namespace
+
 #include "Builtins.h"
 
 void Interpreter::initBuiltins() {
@@ -44,6 +125,7 @@ void Interpreter::interpret(const std::vector<StmtPtr>& statements) {
             execute(stmt);
         }
     } catch (const RuntimeError& e) {
+        Output::instance().flush();
         std::cerr << "[Line " << e.line << "] Runtime Error: " << e.what() << std::endl;
     } catch (const ReturnException&) {
         // Top-level return, just ignore
@@ -94,9 +176,32 @@ Value Interpreter::evaluate(const ExprPtr& expr) {
     }, expr->variant);
 }
 
+void Interpreter::checkHeapLimit(uint64_t more, int line) {
+    if (memory::takeOverdraft() || (more && memory::wouldExceedLimit(more))) {
+        throw RuntimeError("Heap limit exceeded (" + std::to_string(memory::liveHeapBytes() >> 20) + " MB live, limit " +
+                           std::to_string(memory::heapLimit() >> 20) + " MB)", line);
+    }
+}
+
 void Interpreter::execute(const StmtPtr& stmt) {
     if (!stmt) return;
     
+    // Ticks that passed since the last statement belong to the line that
+    // was running then (a blocking await or stop), so poll before moving on
+    if (Profiler::enabled) Profiler::instance().poll(callStack, profileTick);
+    callStack.back().line = stmt->line;
+    checkHeapLimit(0, stmt->line);
+    if (HotLines::enabled) {
+        // A block's time belongs to the statement that owns it
+        HotLines::Scope hotLine(hotCursor, sourceFile,
+                                std::holds_alternative<std::shared_ptr<BlockStmt>>(stmt->variant) ? 0 : stmt->line);
+        dispatch(stmt);
+        return;
+    }
+    dispatch(stmt);
+}
+
+void Interpreter::dispatch(const StmtPtr& stmt) {
     std::visit([this](auto&& arg) {
         using T = std::decay_t<decltype(arg)>;
         
@@ -120,6 +225,8 @@ void Interpreter::execute(const StmtPtr& stmt) {
             visitTaskStmt(arg);
         } else if constexpr (std::is_same_v<T, std::shared_ptr<GiveStmt>>) {
             visitGiveStmt(arg);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<YieldStmt>>) {
+            visitYieldStmt(arg);
         } else if constexpr (std::is_same_v<T, std::shared_ptr<EscapeStmt>>) {
             visitEscapeStmt(arg);
         } else if constexpr (std::is_same_v<T, std::shared_ptr<SkipStmt>>) {
@@ -169,8 +276,17 @@ Value Interpreter::visitBinary(const std::shared_ptr<BinaryExpr>& expr, int line
             if (left.isNumber() && right.isNumber()) {
                 return Value(left.asNumber() + right.asNumber());
             }
+            if (left.isStringBuilder()) {
+                // A new string; `sb += x` appends in place through appendInPlace
+                std::string result = left.asStringBuilder()->buffer;
+                appendText(result, right);
+                return Value(std::move(result));
+            }
             if (left.isString() || right.isString()) {
-                return Value(left.toString() + right.toString());
+                std::string result;
+                appendText(result, left);
+                appendText(result, right);
+                return Value(std::move(result));
             }
             if (left.isArray() && right.isArray()) {
                 auto result = left.asArray();
@@ -190,9 +306,14 @@ Value Interpreter::visitBinary(const std::shared_ptr<BinaryExpr>& expr, int line
             }
             if (left.isString() && right.isNumber()) {
                 std::string result;
+                std::string_view piece = left.asStringView();
                 int times = static_cast<int>(right.asNumber());
+                if (times > 0) {
+                    checkHeapLimit(piece.size() * static_cast<uint64_t>(times), line);
+                    result.reserve(piece.size() * times);
+                }
                 for (int i = 0; i < times; i++) {
-                    result += left.asString();
+                    result += piece;
                 }
                 return Value(result);
             }
@@ -243,7 +364,22 @@ Value Interpreter::visitBinary(const std::shared_ptr<BinaryExpr>& expr, int line
                 return Value(false);
             }
             if (right.isString()) {
-                return Value(right.asString().find(left.toString()) != std::string::npos);
+                std::string_view hay = right.asStringView();
+                std::string converted;
+                std::string_view needle = left.isString() ? left.asStringView()
+                                                          : std::string_view(converted = left.toString());
+                return Value(simd::find(hay.data(), hay.size(), needle.data(), needle.size()) != simd::NPOS);
+            }
+            if (right.isRange()) {
+                return Value(left.isNumber() && right.asRange()->contains(left.asNumber()));
+            }
+            if (right.isTypedArray()) {
+                if (!left.isNumber()) return Value(false);
+                const EZTypedArray& ta = *right.asTypedArray();
+                for (size_t i = 0; i < ta.size(); i++) {
+                    if (ta.get(i) == left.asNumber()) return Value(true);
+                }
+                return Value(false);
             }
             throw RuntimeError("'in' operator expects dictionary, array, or string on right side", line);
             
@@ -277,6 +413,7 @@ Value Interpreter::visitCall(const std::shared_ptr<CallExpr>& expr, int line) {
         args.push_back(evaluate(arg));
     }
     
+    callStack.back().line = line;
     return callFunction(callee, args, line);
 }
 
@@ -301,11 +438,27 @@ Value Interpreter::visitIndex(const std::shared_ptr<IndexExpr>& expr, int line)
             throw RuntimeError("String index must be a number", line);
         }
         int idx = static_cast<int>(index.asNumber());
-        const auto& str = object.asString();
-        if (idx < 0 || idx >= static_cast<int>(str.length())) {
+        const EZString& str = *object.asStringPtr();
+        if (idx < 0 || idx >= static_cast<int>(str.size())) {
             throw RuntimeError("String index out of bounds: " + std::to_string(idx), line);
         }
-        return Value(std::string(1, str[idx]));
+        return Value(EZString::ofChar(static_cast<unsigned char>(str.data()[idx])));
+    }
+    
+    if (object.isTypedArray()) {
+        if (!index.isNumber()) {
+            throw RuntimeError("Array index must be a number", line);
+        }
+        const EZTypedArray& ta = *object.asTypedArray();
+        return Value(ta.get(elementIndex(index, ta.size(), line)));
+    }
+    
+    if (object.isRange()) {
+        if (!index.isNumber()) {
+            throw RuntimeError("Array index must be a number", line);
+        }
+        const EZRange& range = *object.asRange();
+        return Value(range.at(elementIndex(index, range.size(), line)));
     }
     
     if (object.isDictionary()) {
@@ -330,6 +483,10 @@ Value Interpreter::visitArray(const std::shared_ptr<ArrayExpr>& expr, int line)
 }
 
 Value Interpreter::visitAssign(const std::shared_ptr<AssignExpr>& expr, int line) {
+    if (!expr->index && appendInPlace(expr->name, expr->value)) {
+        return currentEnv->get(expr->name, line);
+    }
+    
     Value value = evaluate(expr->value);
     
     if (expr->index) {
@@ -348,6 +505,8 @@ Value Interpreter::visitAssign(const std::shared_ptr<AssignExpr>& expr, int line
             } else if (object.isDictionary()) {
                 Value indexVal = evaluate(expr->index);
                 object.asDictionary().map[indexVal.toString()] = value;
+            } else if (object.isTypedArray()) {
+                setTypedElement(*object.asTypedArray(), evaluate(expr->index), value, line);
             } else {
                 throw RuntimeError("Target of indexed assignment must be array or dictionary", line);
             }
@@ -365,6 +524,8 @@ Value Interpreter::visitAssign(const std::shared_ptr<AssignExpr>& expr, int line
                 arr[idx] = value;
             } else if (targetPtr->isDictionary()) {
                 targetPtr->asDictionary().map[indexVal.toString()] = value;
+            } else if (targetPtr->isTypedArray()) {
+                setTypedElement(*targetPtr->asTypedArray(), indexVal, value, line);
             } else {
                 throw RuntimeError("Only arrays and dictionaries can be indexed", line);
             }
@@ -398,10 +559,14 @@ Value Interpreter::visitLambda(const std::shared_ptr<LambdaExpr>& expr, int line
         // Expression body lambda - wrap in a give statement
         std::vector<StmtPtr> body;
         body.push_back(makeGiveStmt(line, expr->body));
-        return Value::makeFunction("<lambda>", expr->params, body, closure);
+        Value function = Value::makeFunction("<lambda>", expr->params, body, closure);
+        function.asFunction()->file = sourceFile;
+        return function;
     } else {
         // Statement body lambda
-        return Value::makeFunction("<lambda>", expr->params, expr->stmtBody, closure);
+        Value function = Value::makeFunction("<lambda>", expr->params, expr->stmtBody, closure, expr->isGenerator);
+        function.asFunction()->file = sourceFile;
+        return function;
     }
 }
 
@@ -413,10 +578,15 @@ void Interpreter::visitExprStmt(const std::shared_ptr<ExprStmt>& stmt) {
 
 void Interpreter::visitOutStmt(const std::shared_ptr<OutStmt>& stmt) {
     Value value = evaluate(stmt->expression);
-    std::cout << value.toString() << std::endl;
+    std::string text;
+    appendText(text, value);
+    text += '\n';
+    Output::instance().write(text);
 }
 
 void Interpreter::visitVarDeclStmt(const std::shared_ptr<VarDeclStmt>& stmt) {
+    if (appendInPlace(stmt->name, stmt->initializer)) return;
+    
     Value value = evaluate(stmt->initializer);
     // Use assign if variable already exists (to update existing variable)
     // Otherwise define new variable
@@ -498,17 +668,15 @@ void Interpreter::visitRepeatStmt(const std::shared_ptr<RepeatStmt>& stmt) {
 
 void Interpreter::visitGetStmt(const std::shared_ptr<GetStmt>& stmt) {
     Value iterable = evaluate(stmt->iterable);
-    
-    if (!iterable.isArray() && !iterable.isString() && !iterable.isDictionary()) {
-        throw RuntimeError("Can only iterate over arrays, strings, and dictionaries", 0);
-    }
+    auto iter = makeIterator(iterable, stmt->iterable->line);
     
     auto loopEnv = currentEnv->createChild();
     auto prevEnv = currentEnv;
     currentEnv = loopEnv;
     
-    if (iterable.isArray()) {
-        for (const auto& elem : iterable.asArray()) {
+    try {
+        Value elem;
+        while (iter->next(*this, elem)) {
             loopEnv->define(stmt->variable, elem);
             
             try {
@@ -519,41 +687,17 @@ void Interpreter::visitGetStmt(const std::shared_ptr<GetStmt>& stmt) {
                 continue;
             }
         }
-    } else if (iterable.isDictionary()) {
-        const auto& map = iterable.asDictionary().map;
-        std::vector<std::string> keys;
-        for (const auto& pair : map) keys.push_back(pair.first);
-        
-        for (const auto& key : keys) {
-            loopEnv->define(stmt->variable, Value(key));
-            try {
-                execute(stmt->body);
-            } catch (const BreakException&) {
-                break;
-            } catch (const ContinueException&) {
-                continue;
-            }
-        }
-    } else {
-        const std::string& str = iterable.asString();
-        for (char c : str) {
-            loopEnv->define(stmt->variable, Value(std::string(1, c)));
-            
-            try {
-                execute(stmt->body);
-            } catch (const BreakException&) {
-                break;
-            } catch (const ContinueException&) {
-                continue;
-            }
-        }
+    } catch (...) {
+        currentEnv = prevEnv;
+        throw;
     }
     
     currentEnv = prevEnv;
 }
 
 void Interpreter::visitTaskStmt(const std::shared_ptr<TaskStmt>& stmt) {
-    Value function = Value::makeFunction(stmt->name, stmt->params, stmt->body, currentEnv);
+    Value function = Value::makeFunction(stmt->name, stmt->params, stmt->body, currentEnv, stmt->isGenerator);
+    function.asFunction()->file = sourceFile;
     currentEnv->define(stmt->name, function);
 }
 
@@ -565,6 +709,17 @@ void Interpreter::visitGiveStmt(const std::shared_ptr<GiveStmt>& stmt) {
     throw ReturnException(value);
 }
 
+void Interpreter::visitYieldStmt(const std::shared_ptr<YieldStmt>& stmt) {
+    if (!generatorChannel) {
+        throw RuntimeError("'yield' used outside of a generator");
+    }
+    Value value;
+    if (stmt->value) {
+        value = evaluate(stmt->value);
+    }
+    generatorChannel->yield(value);
+}
+
 void Interpreter::visitEscapeStmt(const std::shared_ptr<EscapeStmt>&) {
     throw BreakException();
 }
@@ -575,6 +730,235 @@ void Interpreter::visitSkipStmt(const std::shared_ptr<SkipStmt>&) {
 
 // ============ Helpers ============
 
+namespace {
+
+class ArrayIterator : public EZIterator {
+public:
+    explicit ArrayIterator(Value::ArrayPtr arr) : arr(std::move(arr)) {}
+    bool next(Interpreter&, Value& out) override {
+        // Re-check the size each step: the loop body may push or pop
+        if (pos >= arr->size()) return false;
+        out = (*arr)[pos++];
+        return true;
+    }
+private:
+    Value::ArrayPtr arr;
+    size_t pos = 0;
+};
+
+class StringIterator : public EZIterator {
+public:
+    explicit StringIterator(Value::StringPtr str) : str(std::move(str)) {}
+    bool next(Interpreter&, Value& out) override {
+        if (pos >= str->size()) return false;
+        out = Value(EZString::ofChar(static_cast<unsigned char>(str->data()[pos++])));
+        return true;
+    }
+private:
+    Value::StringPtr str;
+    size_t pos = 0;
+};
+
+// Walks a snapshot of the keys so the body may add or remove entries
+class KeyIterator : public EZIterator {
+public:
+    explicit KeyIterator(const EZDictionary& dict) {
+        keys.reserve(dict.map.size());
+        for (const auto& pair : dict.map) keys.push_back(pair.first);
+    }
+    bool next(Interpreter&, Value& out) override {
+        if (pos >= keys.size()) return false;
+        out = Value(keys[pos++]);
+        return true;
+    }
+private:
+    std::vector<std::string> keys;
+    size_t pos = 0;
+};
+
+class TypedArrayIterator : public EZIterator {
+public:
+    explicit TypedArrayIterator(Value::TypedArrayPtr ta) : ta(std::move(ta)) {}
+    bool next(Interpreter&, Value& out) override {
+        if (pos >= ta->size()) return false;
+        out = Value(ta->get(pos++));
+        return true;
+    }
+private:
+    Value::TypedArrayPtr ta;
+    size_t pos = 0;
+};
+
+class RangeIterator : public EZIterator {
+public:
+    explicit RangeIterator(const EZRange& range) : range(range) {}
+    bool next(Interpreter&, Value& out) override {
+        if (pos >= range.size()) return false;
+        out = Value(range.at(pos++));
+        return true;
+    }
+private:
+    EZRange range;
+    size_t pos = 0;
+};
+
+class FileLineIterator : public EZIterator {
+public:
+    FileLineIterator(Value::FilePtr file, int line) : file(std::move(file)), line(line) {}
+    bool next(Interpreter&, Value& out) override {
+        std::lock_guard<std::mutex> lock(file->mutex);
+        if (!file->isOpen()) throw RuntimeError("File '" + file->path + "' is closed", line);
+        std::string text;
+        if (!file->readLine(text)) return false;
+        out = Value(std::move(text));
+        return true;
+    }
+private:
+    Value::FilePtr file;
+    int line;
+};
+
+// User model implementing hasNext()/next()
+class ModelIterator : public EZIterator {
+public:
+    ModelIterator(Value hasNext, Value nextFn, int line)
+        : hasNext(std::move(hasNext)), nextFn(std::move(nextFn)), line(line) {}
+    bool next(Interpreter& interp, Value& out) override {
+        if (!interp.callFunction(hasNext, {}, line).isTruthy()) return false;
+        out = interp.callFunction(nextFn, {}, line);
+        return true;
+    }
+private:
+    Value hasNext;
+    Value nextFn;
+    int line;
+};
+
+} // namespace
+
+std::shared_ptr<EZIterator> Interpreter::makeIterator(const Value& iterable, int line) {
+    switch (iterable.type()) {
+        case ValueType::ARRAY: return std::make_shared<ArrayIterator>(iterable.asArrayPtr());
+        case ValueType::STRING: return std::make_shared<StringIterator>(iterable.asStringPtr());
+        case ValueType::DICTIONARY: return std::make_shared<KeyIterator>(iterable.asDictionary());
+        case ValueType::TYPED_ARRAY: return std::make_shared<TypedArrayIterator>(iterable.asTypedArray());
+        case ValueType::RANGE: return std::make_shared<RangeIterator>(*iterable.asRange());
+        case ValueType::ITERATOR: return iterable.asIterator();
+        case ValueType::FILE_HANDLE: return std::make_shared<FileLineIterator>(iterable.asFile(), line);
+        case ValueType::INSTANCE: {
+            // iter() hands back something iterable; otherwise the instance
+            // is its own iterator via hasNext()/next()
+            Value iterFn = bindMethod(iterable, "iter");
+            if (!iterFn.isNil()) {
+                Value inner = callFunction(iterFn, {}, line);
+                // iter() returning self means the instance is its own iterator
+                bool isSelf = inner.isInstance() && inner.asInstance() == iterable.asInstance();
+                if (!isSelf) return makeIterator(inner, line);
+            }
+            Value hasNext = bindMethod(iterable, "hasNext");
+            Value nextFn = bindMethod(iterable, "next");
+            if (!hasNext.isNil() && !nextFn.isNil()) {
+                return std::make_shared<ModelIterator>(hasNext, nextFn, line);
+            }
+            throw RuntimeError("'" + iterable.asInstance()->klass->name +
+                               "' is not iterable (needs iter() or hasNext()/next())", line);
+        }
+        default:
+            throw RuntimeError("Can only iterate over arrays, strings, dictionaries, ranges and iterators", line);
+    }
+}
+
+void Interpreter::runGenerator(const std::vector<StmtPtr>& body, std::shared_ptr<Environment> env,
+                               GeneratorChannel* channel) {
+    generatorChannel = channel;
+    try {
+        executeBlock(body, env);
+    } catch (const ReturnException&) {
+        // `give` ends the generator; its value is ignored
+    }
+}
+
+Value Interpreter::bindMethod(const Value& object, const std::string& name) {
+    if (!object.isInstance()) return Value();
+    auto klass = object.asInstance()->klass;
+    while (klass) {
+        auto it = klass->methods.find(name);
+        if (it != klass->methods.end()) {
+            Value method = it->second;
+            if (!method.isFunction()) return method;
+            
+            // Bind 'self' to the method
+            auto func = method.asFunction();
+            auto boundEnv = func->closure->createChild();
+            boundEnv->define("self", object);
+            Value bound = Value::makeFunction(func->name, func->params, func->body, boundEnv, func->isGenerator);
+            bound.asFunction()->owner = func->owner;
+            bound.asFunction()->file = func->file;
+            return bound;
+        }
+        klass = klass->parent;
+    }
+    return Value();
+}
+
+void Interpreter::setTypedElement(EZTypedArray& ta, const Value& index, const Value& value, int line) {
+    if (!index.isNumber()) throw RuntimeError("Array index must be a number", line);
+    double d = index.asNumber();
+    if (!(d >= 0 && d < static_cast<double>(ta.size()))) throw RuntimeError("Array index out of bounds", line);
+    if (!value.isNumber()) throw RuntimeError("Typed arrays can only hold numbers", line);
+    if (!ta.set(static_cast<size_t>(d), value.asNumber())) {
+        throw RuntimeError("IntArray elements must be finite numbers within the 64-bit integer range", line);
+    }
+}
+
+// Fast path for `name += expr` (parsed as name = name + expr) when name holds
+// a StringBuilder, or a string nobody else references: append to the existing
+// buffer instead of allocating a fresh copy, which keeps building a string
+// piecewise linear. The scope may be shared with spawn tasks and server
+// handlers, so the check and the append happen under its write lock.
+// Returns false, having evaluated nothing, when the pattern does not apply.
+bool Interpreter::appendInPlace(const std::string& name, const ExprPtr& valueExpr) {
+    auto* bin = std::get_if<std::shared_ptr<BinaryExpr>>(&valueExpr->variant);
+    if (!bin || (*bin)->op != TokenType::PLUS) return false;
+    auto* ident = std::get_if<std::shared_ptr<IdentifierExpr>>(&(*bin)->left->variant);
+    if (!ident || (*ident)->name != name) return false;
+    
+    // Keep the left operand (or the builder) alive while the right side
+    // runs, exactly as visitBinary would, in case evaluating it reassigns
+    // the variable.
+    Value left;
+    if (!currentEnv->tryGet(name, left)) return false;
+    if (!left.isStringBuilder() && !left.isString()) return false;
+    Value right = evaluate((*bin)->right);
+    std::string text;
+    if (!right.isString()) appendText(text, right);
+    std::string_view piece = right.isString() ? right.asStringView() : std::string_view(text);
+    
+    if (left.isStringBuilder()) {
+        currentEnv->update(name, [&](Value&) { left.asStringBuilder()->buffer.append(piece); });
+        return true;
+    }
+    
+    currentEnv->update(name, [&](Value& target) {
+        if (target.isString() && target.asStringPtr() == left.asStringPtr()) {
+            left = Value();
+            auto& buffer = std::get<Value::StringPtr>(target.data);
+            if (buffer.use_count() == 1 && !buffer->isView()) {
+                buffer->append(piece);
+                return;
+            }
+            std::string result(buffer->view());
+            result.append(piece);
+            target = Value(std::move(result));
+            return;
+        }
+        std::string result(left.asStringView());
+        result.append(piece);
+        target = Value(std::move(result));
+    });
+    return true;
+}
+
 void Interpreter::executeBlock(const std::vector<StmtPtr>& statements, std::shared_ptr<Environment> env) {
     auto prevEnv = currentEnv;
     currentEnv = env;
@@ -592,12 +976,33 @@ void Interpreter::executeBlock(const std::vector<StmtPtr>& statements, std::shar
 }
 
 Value Interpreter::callFunction(const Value& callee, const std::vector<Value>& args, int line) {
+    if (CallTracer::enabled) {
+        if (callee.isNativeFunction()) {
+            CallTracer::Scope scope({}, callee.asNativeFunction()->name, CallTracer::Kind::NATIVE);
+            return invoke(callee, args, line);
+        }
+        if (callee.isFunction()) {
+            const EZFunction& func = *callee.asFunction();
+            CallTracer::Scope scope(func.owner ? std::string_view(func.owner->name) : std::string_view(),
+                                    func.name, CallTracer::Kind::TASK);
+            return invoke(callee, args, line);
+        }
+        if (callee.isClass()) {
+            CallTracer::Scope scope(callee.asClass()->name, "init", CallTracer::Kind::TASK);
+            return invoke(callee, args, line);
+        }
+    }
+    return invoke(callee, args, line);
+}
+
+Value Interpreter::invoke(const Value& callee, const std::vector<Value>& args, int line) {
     if (callee.isNativeFunction()) {
         auto nativeFn = callee.asNativeFunction();
         if (nativeFn->arity != -1 && static_cast<int>(args.size()) != nativeFn->arity) {
             throw RuntimeError("Expected " + std::to_string(nativeFn->arity) + 
                              " arguments but got " + std::to_string(args.size()), line);
         }
+        FrameScope frame(callStack, profileTick, nativeFn->name);
         return nativeFn->function(*this, args);
     }
     
@@ -608,11 +1013,19 @@ Value Interpreter::callFunction(const Value& callee, const std::vector<Value>& a
                              " arguments but got " + std::to_string(args.size()), line);
         }
         
-        auto funcEnv = std::make_shared<Environment>(func->closure);
+        auto funcEnv = memory::make<Environment>(func->closure);
         for (size_t i = 0; i < func->params.size(); i++) {
             funcEnv->define(func->params[i], args[i]);
         }
         
+        if (func->isGenerator) {
+            // Nothing runs until the iterator is first advanced
+            return Value(std::static_pointer_cast<EZIterator>(
+                std::make_shared<GeneratorIterator>(func, funcEnv, globalEnv)));
+        }
+        
+        FrameScope frame(callStack, profileTick, func->name, func->owner ? std::string_view(func->owner->name) : std::string_view());
+        SourceFileScope file(sourceFile, func->file);
         try {
             executeBlock(func->body, funcEnv);
         } catch (const ReturnException& e) {
@@ -624,7 +1037,7 @@ Value Interpreter::callFunction(const Value& callee, const std::vector<Value>& a
     
     if (callee.isClass()) {
         auto klass = callee.asClass();
-        auto instance = std::make_shared<EZInstance>(klass);
+        auto instance = memory::make<EZInstance>(klass);
         Value instanceVal(instance);
         
         // Check argument count match for init
@@ -646,6 +1059,8 @@ Value Interpreter::callFunction(const Value& callee, const std::vector<Value>& a
             // Execute init body
             std::shared_ptr<Environment> previousEnv = currentEnv;
             currentEnv = methodEnv;
+            FrameScope frame(callStack, profileTick, "init", klass->name);
+            SourceFileScope file(sourceFile, klass->file);
             
             try {
                 executeBlock(klass->initBody, methodEnv);
@@ -690,7 +1105,7 @@ Value Interpreter::visitNew(const std::shared_ptr<NewExpr>& expr, int line) {
     }
     
     auto klass = classVal.asClass();
-    auto instance = std::make_shared<EZInstance>(klass);
+    auto instance = memory::make<EZInstance>(klass);
     Value instanceVal(instance);
     
     // Evaluate arguments
@@ -707,7 +1122,7 @@ Value Interpreter::visitNew(const std::shared_ptr<NewExpr>& expr, int line) {
     
     // Run init method if present
     if (!klass->initBody.empty()) {
-        auto initEnv = std::make_shared<Environment>(currentEnv); 
+        auto initEnv = memory::make<Environment>(currentEnv); 
         
         // Create a method scope with self
         // Note: we need to link it properly. 
@@ -724,6 +1139,8 @@ Value Interpreter::visitNew(const std::shared_ptr<NewExpr>& expr, int line) {
         // Execute init body
         std::shared_ptr<Environment> previousEnv = currentEnv;
         currentEnv = methodEnv;
+        FrameScope frame(callStack, profileTick, "init", klass->name);
+        SourceFileScope file(sourceFile, klass->file);
         
         try {
             executeBlock(klass->initBody, methodEnv);
@@ -777,29 +1194,19 @@ Value Interpreter::visitPropertyAccess(const std::shared_ptr<PropertyAccessExpr>
             return instance->getProperty(expr->property);
         }
         
-        // 2. Check class methods
-        auto klass = instance->klass;
-        while (klass) {
-            auto it = klass->methods.find(expr->property);
-            if (it != klass->methods.end()) {
-                // Method found (visibility already checked above)
-                Value method = it->second;
-                if (!method.isFunction()) return method;
-                
-                // Bind 'self' to the method
-                auto func = method.asFunction();
-                auto boundEnv = func->closure->createChild();
-                boundEnv->define("self", object);
-                return Value::makeFunction(func->name, func->params, func->body, boundEnv);
-            }
-            klass = klass->parent;
-        }
+        // 2. Check class methods (visibility already checked above)
+        Value method = bindMethod(object, expr->property);
+        if (!method.isNil()) return method;
         
         throw RuntimeError("Undefined property '" + expr->property + "'", line);
     } else if (object.isArray() && expr->property == "len") {
         return Value(static_cast<double>(object.asArray().size()));
     } else if (object.isString() && expr->property == "len") {
-        return Value(static_cast<double>(object.asString().length()));
+        return Value(static_cast<double>(object.asStringPtr()->size()));
+    } else if (object.isTypedArray() && expr->property == "len") {
+        return Value(static_cast<double>(object.asTypedArray()->size()));
+    } else if (object.isRange() && expr->property == "len") {
+        return Value(static_cast<double>(object.asRange()->size()));
     } else if (object.isDictionary()) {
         auto& map = object.asDictionary().map;
         auto it = map.find(expr->property);
@@ -825,6 +1232,7 @@ void Interpreter::visitModelStmt(const std::shared_ptr<ModelStmt>& stmt) {
     // Init
     klass->initParams = stmt->initParams;
     klass->initBody = stmt->initBody;
+    klass->file = sourceFile;
     
     // Process members
     for (const auto& member : stmt->members) {
@@ -834,8 +1242,10 @@ void Interpreter::visitModelStmt(const std::shared_ptr<ModelStmt>& stmt) {
         if (member.isMethod) {
             // Method - capture global env as closure (methods are shared)
             Value method = Value::makeFunction(
-                member.name, member.params, member.body, globalEnv
+                member.name, member.params, member.body, globalEnv, member.isGenerator
             );
+            method.asFunction()->owner = klass.get();
+            method.asFunction()->file = sourceFile;
             klass->methods[member.name] = method;
         } else {
             // Properties are dynamic, but we can store visibility
@@ -929,6 +1339,7 @@ void Interpreter::visitStructStmt(const std::shared_ptr<StructStmt>& stmt) {
 }
 
 void Interpreter::visitUseStmt(const std::shared_ptr<UseStmt>& stmt) {
+    TraceSpan span("module", "use", stmt->path);
     std::string path = stmt->path;
     std::ifstream file(path);
     
@@ -996,6 +1407,7 @@ void Interpreter::visitUseStmt(const std::shared_ptr<UseStmt>& stmt) {
          throw RuntimeError("Parser error in module '" + path + "'", 0);
     }
     
+    SourceFileScope moduleFile(sourceFile, HotLines::enabled ? HotLines::instance().addFile(path, source, statements) : 0);
     for (const auto& s : statements) {
         execute(s);
     }
@@ -9,6 +9,8 @@
 #include "Value.h"
 #include "Environment.h"
 #include "GC.h"
+#include "Profiler.h"
+#include "HotLines.h"
 
 // Control flow exceptions
 class ReturnException : public std::exception {
@@ -18,6 +20,8 @@ public:
 };
 
 class BreakException : public std::exception {};
+
+class GeneratorChannel;
 class ContinueException : public std::exception {};
 
 class Interpreter {
@@ -41,15 +45,47 @@ public:
     // For calling functions from native code
     Value callFunction(const Value& callee, const std::vector<Value>& args, int line);
     
+    // Raises the --max-heap error if the calling thread grew the heap past
+    // the limit, or if `more` bytes would; natives that build large values
+    // call it inside their loops
+    static void checkHeapLimit(uint64_t more = 0, int line = 0);
+    
+    // Cursor over anything `get x in` accepts; throws for non-iterables
+    std::shared_ptr<EZIterator> makeIterator(const Value& iterable, int line);
+    
+    // Method `name` of an instance with self bound, or nil if it has none
+    Value bindMethod(const Value& instance, const std::string& name);
+    
+    // Runs a generator body; each `yield` in it goes through `channel`
+    void runGenerator(const std::vector<StmtPtr>& body, std::shared_ptr<Environment> env,
+                      GeneratorChannel* channel);
+    
     // Define global variable (for built-ins)
     void defineGlobal(const std::string& name, const Value& value);
     
+    // Names the bottom frame of the call stack ("<spawn>", "<server>", ...);
+    // name must be a string literal
+    void setThreadName(std::string_view name) {
+        callStack.front().name = name;
+        if (Trace::enabled) Trace::instance().nameThread(name);
+    }
+    const std::vector<CallFrame>& getCallStack() const { return callStack; }
+    
+    // --hotlines index of the file whose code runs next (0: the main script)
+    void setSourceFile(int file) { sourceFile = file; }
+    
 private:
     std::shared_ptr<Environment> globalEnv;
     std::shared_ptr<Environment> currentEnv;
+    GeneratorChannel* generatorChannel = nullptr;  // set while running a generator body
+    std::vector<CallFrame> callStack;              // EZ-level stack, for the profiler
+    uint64_t profileTick = 0;                      // last Profiler tick this thread recorded
+    int sourceFile = 0;                            // --hotlines index of the running code's file
+    HotLines::Cursor hotCursor;                    // line --hotlines is charging time to
     
     // Initialization
     void initBuiltins();
+    void initCallStack();
     
     // Expression evaluation
     Value visitLiteral(const std::shared_ptr<LiteralExpr>& expr);
@@ -79,6 +115,7 @@ private:
     void visitGetStmt(const std::shared_ptr<GetStmt>& stmt);
     void visitTaskStmt(const std::shared_ptr<TaskStmt>& stmt);
     void visitGiveStmt(const std::shared_ptr<GiveStmt>& stmt);
+    void visitYieldStmt(const std::shared_ptr<YieldStmt>& stmt);
     void visitEscapeStmt(const std::shared_ptr<EscapeStmt>& stmt);
     void visitSkipStmt(const std::shared_ptr<SkipStmt>& stmt);
     void visitModelStmt(const std::shared_ptr<ModelStmt>& stmt);
@@ -88,7 +125,11 @@ private:
     void visitThrowStmt(const std::shared_ptr<ThrowStmt>& stmt);
     
     // Helpers
+    bool appendInPlace(const std::string& name, const ExprPtr& valueExpr);
+    void setTypedElement(EZTypedArray& ta, const Value& index, const Value& value, int line);
     void executeBlock(const std::vector<StmtPtr>& statements, std::shared_ptr<Environment> env);
+    void dispatch(const StmtPtr& stmt);  // execute() minus the bookkeeping
+    Value invoke(const Value& callee, const std::vector<Value>& args, int line);  // callFunction minus tracing
     void checkNumberOperand(TokenType op, const Value& operand, int line);
     void checkNumberOperands(TokenType op, const Value& left, const Value& right, int line);
 };
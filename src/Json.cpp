@@ -0,0 +1,748 @@
+#include "Json.h"
+#include "Environment.h"
+#include "Simd.h"
+#include "MappedFile.h"
+#include "Numbers.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace json {
+
+namespace {
+
+constexpr int MAX_DEPTH = 512;
+
+std::string describePosition(const char* begin, const char* at, size_t firstLine = 1) {
+    size_t line = firstLine;
+    const char* lineStart = begin;
+    for (const char* c = begin; c < at; c++) {
+        if (*c == '\n') {
+            line++;
+            lineStart = c + 1;
+        }
+    }
+    int column = static_cast<int>(at - lineStart) + 1;
+    return "line " + std::to_string(line) + ", column " + std::to_string(column);
+}
+
+class Parser {
+public:
+    // firstLine numbers the lines in error messages (for text cut out of a
+    // larger file)
+    explicit Parser(std::string_view text, size_t firstLine = 1)
+        : begin(text.data()), p(text.data()), end(text.data() + text.size()), firstLine(firstLine) {}
+
+    Value parseDocument() {
+        skipWhitespace();
+        Value root = parseValue();
+        skipWhitespace();
+        if (p != end) fail("unexpected data after the JSON value");
+        return root;
+    }
+
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+    size_t firstLine;
+    int depth = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw RuntimeError("Invalid JSON: " + message + " at " + describePosition(begin, p, firstLine));
+    }
+
+    [[noreturn]] void unexpected() const {
+        if (p >= end) fail("unexpected end of input");
+        char c = *p;
+        if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x7f) {
+            fail("unexpected character");
+        }
+        fail(std::string("unexpected character '") + c + "'");
+    }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    void expect(char c) {
+        if (p >= end || *p != c) unexpected();
+        p++;
+    }
+
+    Value parseValue() {
+        if (p >= end) unexpected();
+        switch (*p) {
+            case '{': return parseObject();
+            case '[': return parseArray();
+            case '"': return Value(parseString());
+            case 't': return parseLiteral("true", 4, Value(true));
+            case 'f': return parseLiteral("false", 5, Value(false));
+            case 'n': return parseLiteral("null", 4, Value());
+            default:
+                if (*p == '-' || (*p >= '0' && *p <= '9')) return Value(parseNumber());
+                unexpected();
+        }
+    }
+
+    Value parseLiteral(const char* word, size_t len, Value result) {
+        if (static_cast<size_t>(end - p) < len || std::memcmp(p, word, len) != 0) unexpected();
+        p += len;
+        return result;
+    }
+
+    void enter() {
+        if (++depth > MAX_DEPTH) fail("nesting deeper than " + std::to_string(MAX_DEPTH) + " levels");
+    }
+
+    Value parseObject() {
+        enter();
+        p++;  // {
+        auto dict = memory::make<EZDictionary>();
+        skipWhitespace();
+        if (p < end && *p == '}') {
+            p++;
+            depth--;
+            return Value(dict);
+        }
+        while (true) {
+            skipWhitespace();
+            if (p >= end || *p != '"') unexpected();
+            std::string key = parseString();
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+            dict->map[std::move(key)] = parseValue();
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            expect('}');
+            break;
+        }
+        depth--;
+        return Value(dict);
+    }
+
+    Value parseArray() {
+        enter();
+        p++;  // [
+        auto items = memory::make<Value::ArrayType>();
+        skipWhitespace();
+        if (p < end && *p == ']') {
+            p++;
+            depth--;
+            return Value(items);
+        }
+        while (true) {
+            skipWhitespace();
+            items->push_back(parseValue());
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            expect(']');
+            break;
+        }
+        depth--;
+        return Value(items);
+    }
+
+    // Strings without escapes (the common case) are copied in one go
+    std::string parseString() {
+        p++;  // opening quote
+        const char* start = p;
+        while (p < end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) p++;
+        if (p < end && *p == '"') {
+            std::string out(start, p - start);
+            p++;
+            return out;
+        }
+
+        std::string out(start, p - start);
+        while (true) {
+            if (p >= end) fail("unterminated string");
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c == '"') {
+                p++;
+                return out;
+            }
+            if (c < 0x20) fail("control character in string");
+            if (c != '\\') {
+                out += static_cast<char>(c);
+                p++;
+                continue;
+            }
+            p++;
+            if (p >= end) fail("unterminated string");
+            switch (*p++) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': appendUtf8(out, parseUnicodeEscape()); break;
+                default:
+                    p--;
+                    fail("invalid escape sequence");
+            }
+        }
+    }
+
+    unsigned parseHex4() {
+        if (end - p < 4) fail("incomplete \\u escape");
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++) {
+            char h = *p;
+            unsigned digit;
+            if (h >= '0' && h <= '9') digit = h - '0';
+            else if (h >= 'a' && h <= 'f') digit = h - 'a' + 10;
+            else if (h >= 'A' && h <= 'F') digit = h - 'A' + 10;
+            else fail("invalid hex digit in \\u escape");
+            code = code * 16 + digit;
+            p++;
+        }
+        return code;
+    }
+
+    // After "\u"; combines surrogate pairs. A lone surrogate becomes U+FFFD
+    unsigned parseUnicodeEscape() {
+        unsigned code = parseHex4();
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            if (end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                const char* save = p;
+                p += 2;
+                unsigned low = parseHex4();
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    return 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                p = save;  // not a pair; the second escape stands on its own
+            }
+            return 0xFFFD;
+        }
+        if (code >= 0xDC00 && code <= 0xDFFF) return 0xFFFD;
+        return code;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // Checks the RFC 8259 grammar, then converts. Short integers are summed
+    // directly; everything else goes through from_chars (correctly rounded)
+    double parseNumber() {
+        const char* start = p;
+        bool negative = false;
+        if (*p == '-') {
+            negative = true;
+            p++;
+        }
+        if (p >= end || !isDigit(*p)) fail("invalid number");
+
+        const char* digits = p;
+        if (*p == '0') {
+            p++;
+        } else {
+            while (p < end && isDigit(*p)) p++;
+        }
+        bool integer = true;
+        if (p < end && *p == '.') {
+            integer = false;
+            p++;
+            if (p >= end || !isDigit(*p)) fail("invalid number");
+            while (p < end && isDigit(*p)) p++;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            integer = false;
+            p++;
+            if (p < end && (*p == '+' || *p == '-')) p++;
+            if (p >= end || !isDigit(*p)) fail("invalid number");
+            while (p < end && isDigit(*p)) p++;
+        }
+
+        if (integer && p - digits <= 15) {
+            int64_t n = 0;
+            for (const char* d = digits; d < p; d++) n = n * 10 + (*d - '0');
+            return negative ? -static_cast<double>(n) : static_cast<double>(n);
+        }
+
+        double value = 0;
+        ::parseNumber(std::string_view(start, p - start), value);
+        return value;
+    }
+};
+
+class Writer {
+public:
+    Writer(std::string& out, bool pretty, const Sink* sink) : out(out), pretty(pretty), sink(sink) {}
+
+    void value(const Value& v, int depth) {
+        switch (v.type()) {
+            case ValueType::NIL: out += "null"; break;
+            case ValueType::BOOL: out += v.asBool() ? "true" : "false"; break;
+            case ValueType::NUMBER: number(v.asNumber()); break;
+            case ValueType::STRING: string(v.asStringView()); break;
+            case ValueType::STRING_BUILDER: string(v.asStringBuilder()->buffer); break;
+            case ValueType::ARRAY: {
+                const auto& arr = v.asArray();
+                open('[', depth);
+                for (size_t i = 0; i < arr.size(); i++) {
+                    element(i, depth);
+                    value(arr[i], depth + 1);
+                }
+                close(']', arr.empty(), depth);
+                break;
+            }
+            case ValueType::TYPED_ARRAY: {
+                const EZTypedArray& ta = *v.asTypedArray();
+                open('[', depth);
+                for (size_t i = 0; i < ta.size(); i++) {
+                    element(i, depth);
+                    if (ta.isFloat()) number(ta.floats[i]);
+                    else integer(ta.ints[i]);
+                }
+                close(']', ta.size() == 0, depth);
+                break;
+            }
+            case ValueType::RANGE: {
+                const EZRange& range = *v.asRange();
+                open('[', depth);
+                for (size_t i = 0; i < range.size(); i++) {
+                    element(i, depth);
+                    number(range.at(i));
+                }
+                close(']', range.size() == 0, depth);
+                break;
+            }
+            case ValueType::DICTIONARY: {
+                open('{', depth);
+                size_t i = 0;
+                for (const auto& kv : v.asDictionary().map) {
+                    element(i++, depth);
+                    string(kv.first);
+                    out += pretty ? ": " : ":";
+                    value(kv.second, depth + 1);
+                }
+                close('}', i == 0, depth);
+                break;
+            }
+            default:
+                out += "null";
+                break;
+        }
+        if (sink && out.size() >= WRITE_CHUNK) {
+            (*sink)(out.data(), out.size());
+            out.clear();
+        }
+    }
+
+private:
+    std::string& out;
+    bool pretty;
+    const Sink* sink;
+
+    void open(char bracket, int depth) {
+        if (depth >= MAX_DEPTH) {
+            throw RuntimeError("to_json(): value is nested more than " + std::to_string(MAX_DEPTH) +
+                               " levels deep (does a container hold itself?)");
+        }
+        out += bracket;
+    }
+
+    void element(size_t index, int depth) {
+        if (index > 0) out += ',';
+        if (pretty) newline(depth + 1);
+    }
+
+    void close(char bracket, bool empty, int depth) {
+        if (pretty && !empty) newline(depth);
+        out += bracket;
+    }
+
+    void newline(int depth) {
+        out += '\n';
+        out.append(static_cast<size_t>(depth) * 2, ' ');
+    }
+
+    void integer(int64_t n) {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), n);
+        out.append(buf, result.ptr - buf);
+    }
+
+    void number(double d) {
+        if (!std::isfinite(d)) {
+            out += "null";
+            return;
+        }
+        appendNumber(out, d);
+    }
+
+    // Copies runs that need no escaping in one go
+    void string(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+};
+
+} // namespace
+
+Value parse(std::string_view text) {
+    return Parser(text).parseDocument();
+}
+
+void write(const Value& v, std::string& out, bool pretty) {
+    Writer(out, pretty, nullptr).value(v, 0);
+}
+
+void write(const Value& v, const Sink& sink, bool pretty) {
+    std::string buffer;
+    buffer.reserve(WRITE_CHUNK + WRITE_CHUNK / 4);
+    Writer(buffer, pretty, &sink).value(v, 0);
+    if (!buffer.empty()) sink(buffer.data(), buffer.size());
+}
+
+// ---------------- Document (json_doc / json_get) ----------------
+
+std::vector<PathStep> parsePath(std::string_view path) {
+    std::vector<PathStep> steps;
+    size_t i = 0;
+    while (i < path.size()) {
+        if (path[i] == '[') {
+            size_t close = path.find(']', i);
+            if (close == std::string_view::npos || close == i + 1) {
+                throw RuntimeError("json_get(): bad index in path '" + std::string(path) + "'");
+            }
+            PathStep step;
+            auto result = std::from_chars(path.data() + i + 1, path.data() + close, step.index);
+            if (result.ptr != path.data() + close || step.index < 0) {
+                throw RuntimeError("json_get(): bad index in path '" + std::string(path) + "'");
+            }
+            steps.push_back(step);
+            i = close + 1;
+            if (i < path.size() && path[i] == '.') i++;
+            continue;
+        }
+        size_t end = path.find_first_of(".[", i);
+        if (end == std::string_view::npos) end = path.size();
+        if (end == i) throw RuntimeError("json_get(): empty key in path '" + std::string(path) + "'");
+        PathStep step;
+        step.key = std::string(path.substr(i, end - i));
+        steps.push_back(std::move(step));
+        i = end;
+        if (i < path.size() && path[i] == '.') i++;
+    }
+    return steps;
+}
+
+Document::Document(Value::StringPtr source) : text(std::move(source)) {
+    const char* data = text->data();
+    size_t n = text->size();
+    if (n > UINT32_MAX) throw RuntimeError("json_doc(): documents over 4 GB are not supported");
+
+    // Stage 1: where every structural character, string and scalar starts
+    if (!simd::jsonStructurals(data, n, pos)) fail(n, "unterminated string");
+    if (pos.empty()) fail(n, "unexpected end of input");
+
+    // Stage 2: check the grammar and link brackets. `expect` is what may
+    // come next; the stack holds the indexes of the open brackets
+    enum Expect { VALUE, VALUE_OR_CLOSE, KEY, KEY_OR_CLOSE, COLON, COMMA_OR_CLOSE, END };
+    match.assign(pos.size(), 0);
+    std::vector<uint32_t> open;
+    Expect expect = VALUE;
+
+    auto afterValue = [&] { expect = open.empty() ? END : COMMA_OR_CLOSE; };
+    auto close = [&](size_t i) {
+        match[open.back()] = static_cast<uint32_t>(i);
+        open.pop_back();
+        afterValue();
+    };
+
+    for (size_t i = 0; i < pos.size(); i++) {
+        char c = data[pos[i]];
+        switch (expect) {
+            case VALUE:
+            case VALUE_OR_CLOSE:
+                if (c == ']' && expect == VALUE_OR_CLOSE) {
+                    close(i);
+                } else if (c == '{') {
+                    open.push_back(static_cast<uint32_t>(i));
+                    expect = KEY_OR_CLOSE;
+                } else if (c == '[') {
+                    open.push_back(static_cast<uint32_t>(i));
+                    expect = VALUE_OR_CLOSE;
+                } else if (c == '"' || c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                    afterValue();
+                } else {
+                    fail(pos[i], std::string("unexpected character '") + c + "'");
+                }
+                break;
+            case KEY:
+            case KEY_OR_CLOSE:
+                if (c == '"') expect = COLON;
+                else if (c == '}' && expect == KEY_OR_CLOSE) close(i);
+                else fail(pos[i], std::string("expected a string key, found '") + c + "'");
+                break;
+            case COLON:
+                if (c != ':') fail(pos[i], std::string("expected ':', found '") + c + "'");
+                expect = VALUE;
+                break;
+            case COMMA_OR_CLOSE: {
+                bool inObject = data[pos[open.back()]] == '{';
+                if (c == ',') expect = inObject ? KEY : VALUE;
+                else if (c == (inObject ? '}' : ']')) close(i);
+                else fail(pos[i], std::string("expected ',' or '") + (inObject ? '}' : ']') + "', found '" + c + "'");
+                break;
+            }
+            case END:
+                fail(pos[i], "unexpected data after the JSON value");
+        }
+    }
+    if (expect != END) fail(n, "unexpected end of input");
+}
+
+void Document::fail(size_t offset, const std::string& message) const {
+    throw RuntimeError("Invalid JSON: " + message + " at " +
+                       describePosition(text->data(), text->data() + offset));
+}
+
+size_t Document::skip(size_t i) const {
+    char c = at(i);
+    return (c == '{' || c == '[') ? match[i] + 1 : i + 1;
+}
+
+// Key at structural i (its opening quote) against an unescaped key
+bool Document::keyEquals(size_t i, std::string_view key) const {
+    const char* data = text->data();
+    size_t start = pos[i] + 1;
+    size_t end = pos[i + 1];  // the ':' after the key
+    while (data[end - 1] != '"') end--;
+    std::string_view raw(data + start, end - 1 - start);
+    if (raw.find('\\') == std::string_view::npos) return raw == key;
+    Value decoded = parse(std::string_view(data + pos[i], end - pos[i]));
+    return decoded.asStringView() == key;
+}
+
+Value Document::materialize(size_t i) const {
+    const char* data = text->data();
+    size_t start = pos[i];
+    char c = data[start];
+    if (c == '{' || c == '[') {
+        return parse(std::string_view(data + start, pos[match[i]] + 1 - start));
+    }
+    size_t end = i + 1 < pos.size() ? pos[i + 1] : text->size();
+    if (c == '"') {
+        // Share the document's buffer when there is nothing to decode
+        size_t quote = end - 1;
+        while (data[quote] != '"') quote--;
+        std::string_view body(data + start + 1, quote - start - 1);
+        if (body.find('\\') == std::string_view::npos) {
+            for (char b : body) {
+                if (static_cast<unsigned char>(b) < 0x20) return parse(std::string_view(data + start, end - start));
+            }
+            if (body.empty()) return Value("");
+            return Value(EZString::slice(text, start + 1, body.size()));
+        }
+    }
+    return parse(std::string_view(data + start, end - start));
+}
+
+bool Document::get(const std::vector<PathStep>& path, Value& out) const {
+    size_t i = 0;  // the value we are standing on
+    for (const PathStep& step : path) {
+        char c = at(i);
+        if (step.index >= 0) {
+            if (c != '[') return false;
+            size_t j = i + 1;
+            if (at(j) == ']') return false;
+            for (int64_t k = 0; k < step.index; k++) {
+                j = skip(j);
+                if (at(j) == ']') return false;
+                j++;  // the ','
+            }
+            i = j;
+        } else {
+            if (c != '{') return false;
+            size_t j = i + 1;
+            size_t found = 0;
+            bool any = false;
+            // Keep scanning after a hit: like parse_json, the last duplicate wins
+            while (at(j) != '}') {
+                size_t value = j + 2;
+                if (keyEquals(j, step.key)) {
+                    found = value;
+                    any = true;
+                }
+                j = skip(value);
+                if (at(j) == ',') j++;
+            }
+            if (!any) return false;
+            i = found;
+        }
+    }
+    out = materialize(i);
+    return true;
+}
+
+// ---------------- LinesReader (jsonl_read) ----------------
+
+namespace {
+
+bool isBlank(const char* p, const char* end) {
+    for (; p < end; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\r') return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// Parses the lines in [begin, end), which starts at a line boundary and ends
+// just past a newline (or at the end of the file)
+void LinesReader::parseChunk(Chunk& chunk) {
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        const char* lineEnd = nl ? nl : chunk.end;
+        if (!isBlank(p, lineEnd)) {
+            try {
+                chunk.values.push_back(Parser(std::string_view(p, lineEnd - p)).parseDocument());
+            } catch (const std::exception&) {
+                // Re-parsed in order by next(), which reports the error with
+                // the file's line number (or hands the value out if the
+                // failure was the worker's, e.g. running out of memory)
+                chunk.errorAt = p;
+                chunk.errorEnd = lineEnd;
+                return;
+            }
+        }
+        chunk.lines++;
+        p = nl ? nl + 1 : chunk.end;
+    }
+}
+
+LinesReader::LinesReader(const std::string& path) : path(path), file(new MappedFile()) {
+    if (!file->open(path)) throw RuntimeError("Could not open file '" + path + "'");
+}
+
+LinesReader::~LinesReader() = default;
+
+void LinesReader::fill() {
+    batch.clear();
+    batchPos = 0;
+    const char* data = file->data();
+    const char* end = data + file->size();
+
+    // Cut the next stretch of the file into CHUNK_BYTES pieces on line
+    // boundaries, one per worker
+    size_t workers = std::max(1u, std::min(std::thread::hardware_concurrency(), MAX_WORKERS));
+    std::vector<Chunk> chunks;
+    const char* p = data + offset;
+    while (p < end && chunks.size() < workers) {
+        const char* cut = end - p > static_cast<ptrdiff_t>(CHUNK_BYTES) ? p + CHUNK_BYTES : end;
+        if (cut < end) {
+            const char* nl = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+            cut = nl ? nl + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = p;
+        chunk.end = cut;
+        chunks.push_back(std::move(chunk));
+        p = cut;
+    }
+    offset = p - data;
+
+    if (chunks.size() == 1) {
+        parseChunk(chunks[0]);
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < chunks.size(); i++) {
+            threads.emplace_back([&chunks, i] { parseChunk(chunks[i]); });
+        }
+        parseChunk(chunks[0]);
+        for (auto& t : threads) t.join();
+    }
+
+    for (Chunk& chunk : chunks) {
+        for (Value& v : chunk.values) batch.push_back(std::move(v));
+        if (chunk.errorAt) {
+            // Everything before the bad line is still handed out first; the
+            // next batch starts after it
+            errorAt = chunk.errorAt;
+            errorEnd = chunk.errorEnd;
+            errorLine = line + chunk.lines;
+            line = errorLine + 1;
+            offset = std::min<size_t>(errorEnd - data + 1, file->size());
+            break;
+        }
+        line += chunk.lines;
+    }
+}
+
+bool LinesReader::next(Interpreter&, Value& out) {
+    while (batchPos >= batch.size()) {
+        if (errorAt) {
+            const char* at = errorAt;
+            errorAt = nullptr;
+            try {
+                out = Parser(std::string_view(at, errorEnd - at), errorLine + 1).parseDocument();
+            } catch (const RuntimeError& e) {
+                offset = file->size();
+                throw RuntimeError(std::string(e.what()) + " in '" + path + "'");
+            }
+            return true;
+        }
+        if (offset >= file->size()) return false;
+        fill();
+    }
+    out = std::move(batch[batchPos++]);
+    return true;
+}
+
+} // namespace json
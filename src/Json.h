@@ -0,0 +1,129 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Value.h"
+
+class MappedFile;
+
+// JSON (RFC 8259) to and from EZ values, in a single pass with no
+// intermediate tree.
+namespace json {
+
+// Receives serialized output in chunks of about WRITE_CHUNK bytes
+using Sink = std::function<void(const char* data, size_t len)>;
+constexpr size_t WRITE_CHUNK = 64 * 1024;
+
+// Parses one complete JSON text. Objects become dictionaries (keys in
+// document order, the last duplicate wins), arrays become arrays, numbers
+// become numbers, true/false become booleans and null becomes nil.
+// Throws RuntimeError naming the line and column of the first error.
+Value parse(std::string_view text);
+
+// Appends the JSON form of v to out. Compact by default; pretty puts each
+// member on its own line with two-space indentation. Numbers use the
+// shortest form that reads back exactly (integers without a fraction),
+// NaN/infinity and values with no JSON form (functions, models, ...) are
+// written as null. Throws RuntimeError past 512 levels of nesting, which
+// usually means a container holds itself.
+void write(const Value& v, std::string& out, bool pretty = false);
+
+// Same, but hands the output to sink piece by piece instead of building
+// it all in memory
+void write(const Value& v, const Sink& sink, bool pretty = false);
+
+// One step of a json_get path: an object key, or an array index (>= 0)
+struct PathStep {
+    std::string key;
+    int64_t index = -1;
+};
+
+// Parses "a.b[3]" / "[0].name" into steps; throws RuntimeError if malformed
+std::vector<PathStep> parsePath(std::string_view path);
+
+// A JSON text indexed for on-demand access (json_doc / json_get).
+//
+// Construction makes two passes in the style of simdjson. Stage 1
+// (simd::jsonStructurals) finds the offset of every structural character,
+// string and scalar with vector compares and bit arithmetic. Stage 2 walks
+// those offsets once to check the grammar and to link every `{` and `[` to
+// its closing bracket. A lookup then hops from key to key and skips whole
+// subtrees through those links, and only the value it lands on is turned
+// into an EZ value. Strings without escapes come back as slices of the text.
+//
+// The structure is validated up front; a malformed scalar (e.g. `tru`) is
+// reported when it is read.
+class Document {
+public:
+    // Throws RuntimeError with the line and column if the text is not JSON
+    explicit Document(Value::StringPtr text);
+
+    // Value at path, converted to EZ values; false if the path is missing
+    bool get(const std::vector<PathStep>& path, Value& out) const;
+
+    size_t size() const { return text->size(); }
+
+private:
+    Value::StringPtr text;
+    std::vector<uint32_t> pos;    // offset of each structural
+    std::vector<uint32_t> match;  // for `{`/`[`: index of the closing bracket
+
+    // Index just past the value starting at structural i
+    size_t skip(size_t i) const;
+    char at(size_t i) const { return text->data()[pos[i]]; }
+    bool keyEquals(size_t i, std::string_view key) const;
+    Value materialize(size_t i) const;
+    [[noreturn]] void fail(size_t offset, const std::string& message) const;
+};
+
+// Lazy iterator behind jsonl_read(path): one value per line of a JSON Lines
+// (NDJSON) file, blank lines skipped.
+//
+// The file is memory-mapped and parsed a batch at a time: the next few MB
+// are cut into CHUNK_BYTES pieces on line boundaries and the pieces are
+// parsed on up to MAX_WORKERS threads, so only one batch of values is held
+// at once. A bad line raises an error naming its line number once the
+// values before it have been handed out.
+class LinesReader : public EZIterator {
+public:
+    static constexpr size_t CHUNK_BYTES = 1 << 20;
+    static constexpr unsigned MAX_WORKERS = 8;
+
+    // Throws RuntimeError if the file cannot be opened
+    explicit LinesReader(const std::string& path);
+    ~LinesReader() override;
+
+    bool next(Interpreter& interp, Value& out) override;
+
+private:
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        std::vector<Value> values;
+        size_t lines = 0;               // lines parsed (or skipped) before any error
+        const char* errorAt = nullptr;  // first bad line, if any
+        const char* errorEnd = nullptr;
+    };
+
+    std::string path;
+    std::unique_ptr<MappedFile> file;
+    size_t offset = 0;   // start of the next batch
+    size_t line = 0;     // lines before offset
+    std::vector<Value> batch;
+    size_t batchPos = 0;
+    const char* errorAt = nullptr;
+    const char* errorEnd = nullptr;
+    size_t errorLine = 0;
+
+    void fill();
+    static void parseChunk(Chunk& chunk);
+};
+
+} // namespace json
+
+#endif // JSON_H
@@ -1,4 +1,5 @@
 #include "Lexer.h"
+#include "Numbers.h"
 #include <iostream>
 #include <stdexcept>
 
@@ -13,6 +14,7 @@ std::unordered_map<std::string, TokenType> Lexer::keywords = {
     {"use", TokenType::USE},
     {"task", TokenType::TASK},
     {"give", TokenType::GIVE},
+    {"yield", TokenType::YIELD},
     {"escape", TokenType::ESCAPE},
     {"skip", TokenType::SKIP},
     {"get", TokenType::GET},
@@ -250,8 +252,9 @@ void Lexer::scanNumber() {
         while (isDigit(peek())) advance();
     }
     
-    std::string text = source.substr(start, current - start);
-    addToken(TokenType::NUMBER, std::stod(text));
+    double value = 0;
+    parseNumber(std::string_view(source).substr(start, current - start), value);
+    addToken(TokenType::NUMBER, value);
 }
 
 void Lexer::scanIdentifier() {
@@ -0,0 +1,294 @@
+#include "Log.h"
+#include "Environment.h"
+#include "Json.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"debug", "info", "warn", "error", "off"};
+
+// ISO 8601 UTC with milliseconds; the seconds part is cached per thread
+void appendTimestamp(std::string& out) {
+    thread_local time_t cachedSeconds = -1;
+    thread_local char cached[32];
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    time_t seconds = static_cast<time_t>(ms / 1000);
+    if (seconds != cachedSeconds) {
+        std::tm t{};
+#ifdef _WIN32
+        gmtime_s(&t, &seconds);
+#else
+        gmtime_r(&seconds, &t);
+#endif
+        std::strftime(cached, sizeof(cached), "%Y-%m-%dT%H:%M:%S", &t);
+        cachedSeconds = seconds;
+    }
+    char fraction[8];
+    std::snprintf(fraction, sizeof(fraction), ".%03dZ", static_cast<int>(ms % 1000));
+    out += cached;
+    out += fraction;
+}
+
+void appendEscaped(std::string& out, std::string_view s) {
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+}
+
+void appendJsonString(std::string& out, std::string_view s) {
+    out += '"';
+    appendEscaped(out, s);
+    out += '"';
+}
+
+// logfmt values are bare unless they are empty or hold spaces, '=' or '"'
+void appendLogfmtValue(std::string& out, std::string_view s) {
+    bool quote = s.empty();
+    for (unsigned char c : s) {
+        if (c <= ' ' || c == '=' || c == '"') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) {
+        out += s;
+        return;
+    }
+    out += '"';
+    appendEscaped(out, s);
+    out += '"';
+}
+
+void formatRecord(std::string& out, Logger::Format format, Logger::Level level, std::string_view msg,
+                  const Value* fields) {
+    const char* levelName = LEVEL_NAMES[static_cast<int>(level)];
+    if (format == Logger::Format::JSON) {
+        out += "{\"ts\":\"";
+        appendTimestamp(out);
+        out += "\",\"level\":\"";
+        out += levelName;
+        out += "\",\"msg\":";
+        appendJsonString(out, msg);
+        if (fields) {
+            for (const auto& kv : fields->asDictionary().map) {
+                out += ',';
+                appendJsonString(out, kv.first);
+                out += ':';
+                if (kv.second.isString()) appendJsonString(out, kv.second.asStringView());
+                else json::write(kv.second, out);
+            }
+        }
+        out += "}\n";
+    } else {
+        out += "ts=";
+        appendTimestamp(out);
+        out += " level=";
+        out += levelName;
+        out += " msg=";
+        appendLogfmtValue(out, msg);
+        if (fields) {
+            for (const auto& kv : fields->asDictionary().map) {
+                out += ' ';
+                out += kv.first;
+                out += '=';
+                const Value& v = kv.second;
+                if (v.isString()) {
+                    appendLogfmtValue(out, v.asStringView());
+                } else if (v.isDictionary() || v.isArray() || v.isTypedArray()) {
+                    std::string text;
+                    json::write(v, text);
+                    appendLogfmtValue(out, text);
+                } else {
+                    appendLogfmtValue(out, v.toString());
+                }
+            }
+        }
+        out += '\n';
+    }
+}
+
+} // namespace
+
+Logger::Logger() : slots(new Slot[CAPACITY]) {
+    for (size_t i = 0; i < CAPACITY; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool Logger::parseLevel(std::string_view name, Level& level) {
+    for (int i = 0; i <= static_cast<int>(Level::OFF); i++) {
+        if (name == LEVEL_NAMES[i]) {
+            level = static_cast<Level>(i);
+            return true;
+        }
+    }
+    if (name == "warning") {
+        level = Level::WARN;
+        return true;
+    }
+    return false;
+}
+
+bool Logger::log(Level level, std::string_view msg, const Value* fields) {
+    std::call_once(startOnce, [this] { start(); });
+
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & (CAPACITY - 1)];
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // The writer has not freed this slot yet: the ring is full
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // The slot is claimed and must be published whatever happens
+    slot->text.clear();
+    try {
+        formatRecord(slot->text, format.load(std::memory_order_relaxed), level, msg, fields);
+    } catch (const std::exception&) {
+        slot->text.clear();
+        formatRecord(slot->text, format.load(std::memory_order_relaxed), level, msg, nullptr);
+    }
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+Logger::Options Logger::options() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+void Logger::configure(const Options& options) {
+    flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    FILE* opened = nullptr;
+    if (!options.path.empty()) {
+        if (file && options.path == current.path) {
+            opened = file;
+        } else {
+            opened = std::fopen(options.path.c_str(), "ab");
+            if (!opened) throw RuntimeError("logConfig() could not open '" + options.path + "'");
+            std::setvbuf(opened, nullptr, _IOFBF, WRITE_BUFFER);
+        }
+    }
+    if (file && file != opened) std::fclose(file);
+    if (opened && opened != file) {
+        std::fseek(opened, 0, SEEK_END);
+        long size = std::ftell(opened);
+        fileSize = size > 0 ? static_cast<uint64_t>(size) : 0;
+    }
+    file = opened;
+    current = options;
+    minLevel.store(static_cast<int>(options.level), std::memory_order_relaxed);
+    format.store(options.format, std::memory_order_relaxed);
+}
+
+void Logger::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    writer = std::thread([this] { run(); });
+    std::atexit([] { Logger::instance().stop(); });
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable() || stopping) return;
+    uint64_t target = head.load(std::memory_order_acquire);
+    if (target > flushTarget) flushTarget = target;
+    wake.notify_one();
+    drained.wait(lock, [&] { return flushedTo >= target || stopping; });
+}
+
+void Logger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writer.joinable() || stopping) return;
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool dirty = false;
+    for (;;) {
+        size_t n = drain();
+        if (n) dirty = true;
+        if (n == 0 || (flushTarget > flushedTo && tail >= flushTarget)) {
+            if (dirty) std::fflush(file ? file : stderr);
+            dirty = false;
+            flushedTo = tail;
+            drained.notify_all();
+        }
+        if (n == 0) {
+            if (stopping) break;
+            // Producers never signal (that would cost them a syscall), so poll
+            wake.wait_for(lock, std::chrono::milliseconds(IDLE_MS));
+        }
+    }
+}
+
+size_t Logger::drain() {
+    size_t n = 0;
+    while (n < CAPACITY) {
+        Slot& slot = slots[tail & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) break;
+        if (file && current.maxBytes && fileSize > 0 && fileSize + slot.text.size() > current.maxBytes) rotate();
+        std::fwrite(slot.text.data(), 1, slot.text.size(), file ? file : stderr);
+        fileSize += slot.text.size();
+        slot.sequence.store(tail + CAPACITY, std::memory_order_release);
+        tail++;
+        n++;
+    }
+    writtenCount.fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
+
+// app.log -> app.log.1 -> app.log.2 ... up to keep files
+void Logger::rotate() {
+    std::fclose(file);
+    const std::string& path = current.path;
+    if (current.keep <= 0) {
+        std::remove(path.c_str());
+    } else {
+        std::remove((path + "." + std::to_string(current.keep)).c_str());
+        for (int i = current.keep - 1; i >= 1; i--) {
+            std::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+        }
+        std::rename(path.c_str(), (path + ".1").c_str());
+    }
+    file = std::fopen(path.c_str(), "wb");
+    if (file) {
+        std::setvbuf(file, nullptr, _IOFBF, WRITE_BUFFER);
+    } else {
+        std::fprintf(stderr, "log: could not reopen '%s', logging to stderr\n", path.c_str());
+    }
+    fileSize = 0;
+    rotationCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "Value.h"
+
+// Structured logging behind log(level, msg, fields) and logConfig().
+//
+// Records go into a bounded multi-producer, single-consumer ring: a
+// producer claims a slot with one compare-and-swap on the head, formats
+// the record (JSON or logfmt) straight into that slot's reusable string
+// and publishes it with a release store of the slot's sequence number
+// (Vyukov's bounded queue). A background writer thread drains the ring in
+// order into a buffered file, or stderr, and rotates the file by size. The
+// level is checked before anything is formatted, and a record that finds
+// the ring full is dropped and counted instead of blocking the caller.
+class Logger {
+public:
+    enum class Level { DEBUG, INFO, WARN, ERROR, OFF };
+    enum class Format { JSON, LOGFMT };
+
+    static constexpr size_t CAPACITY = 8192;  // records; a power of two
+    static constexpr size_t WRITE_BUFFER = 64 * 1024;
+    static constexpr int IDLE_MS = 5;  // writer poll interval when the ring is empty
+
+    struct Options {
+        Level level = Level::INFO;
+        Format format = Format::JSON;
+        std::string path;       // empty: stderr
+        uint64_t maxBytes = 0;  // rotate past this size; 0 for never
+        int keep = 3;           // rotated files kept (path.1 ... path.keep)
+    };
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    // "debug", "info", "warn"/"warning", "error", "off"; false if unknown
+    static bool parseLevel(std::string_view name, Level& level);
+
+    bool wants(Level level) const { return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed); }
+
+    // Queues one record; fields (a dictionary, or nullptr) become extra
+    // keys. False if the ring was full and the record was dropped.
+    bool log(Level level, std::string_view msg, const Value* fields);
+
+    Options options();
+    // Waits for queued records to be written, then applies the options;
+    // throws RuntimeError if the file cannot be opened
+    void configure(const Options& options);
+
+    // Returns once every record queued before the call is written out
+    void flush();
+    // Flushes and stops the writer thread; runs at exit
+    void stop();
+
+    uint64_t written() const { return writtenCount.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    uint64_t rotations() const { return rotationCount.load(std::memory_order_relaxed); }
+
+private:
+    Logger();
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::string text;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<uint64_t> head{0};  // next slot to claim
+    alignas(64) uint64_t tail = 0;              // next slot to write; writer only
+
+    std::atomic<int> minLevel{static_cast<int>(Level::INFO)};
+    std::atomic<Format> format{Format::JSON};
+    std::atomic<uint64_t> writtenCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+    std::atomic<uint64_t> rotationCount{0};
+
+    // Writer state, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable wake;     // writer: flush requested or stopping
+    std::condition_variable drained;  // flush(): writer caught up
+    std::once_flag startOnce;
+    std::thread writer;
+    bool stopping = false;
+    uint64_t flushTarget = 0;  // head position flush() waits for
+    uint64_t flushedTo = 0;    // records written and flushed to the OS
+    Options current;
+    FILE* file = nullptr;      // nullptr: stderr
+    uint64_t fileSize = 0;
+
+    void start();
+    void run();
+    // Writes every published record; returns how many
+    size_t drain();
+    void rotate();
+};
+
+#endif // LOG_H
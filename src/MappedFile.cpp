@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// Reads to end of file; false (and nothing kept) on a read error
+bool MappedFile::readAll(HANDLE file, size_t sizeHint) {
+    contents.clear();
+    contents.reserve(sizeHint);
+    char chunk[64 * 1024];
+    for (;;) {
+        DWORD got = 0;
+        if (!ReadFile(file, chunk, sizeof(chunk), &got, nullptr)) {
+            // A pipe whose writer closed reports end of file as an error
+            if (GetLastError() == ERROR_BROKEN_PIPE) break;
+            contents.clear();
+            return false;
+        }
+        if (got == 0) break;
+        contents.append(chunk, got);
+    }
+    length = contents.size();
+    return true;
+}
+
+bool MappedFile::open(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    // Pipes and devices have no size to map; read them as a stream
+    LARGE_INTEGER fileSize;
+    fileSize.QuadPart = 0;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize) ||
+        static_cast<size_t>(fileSize.QuadPart) < MAP_THRESHOLD) {
+        bool ok = readAll(file, static_cast<size_t>(fileSize.QuadPart));
+        CloseHandle(file);
+        return ok;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mapped) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) UnmapViewOfFile(mapped);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+}
+
+#else
+
+// Reads to end of file; false (and nothing kept) on a read error
+bool MappedFile::readAll(int fd, size_t sizeHint) {
+    contents.clear();
+    contents.reserve(sizeHint);
+    char chunk[64 * 1024];
+    for (;;) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            contents.clear();
+            return false;
+        }
+        contents.append(chunk, static_cast<size_t>(n));
+    }
+    length = contents.size();
+    return true;
+}
+
+bool MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Small files are read. So are pipes, devices and files that report a
+    // size of 0 but have contents (/proc), which cannot be mapped
+    if (!S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) < MAP_THRESHOLD) {
+        bool ok = readAll(fd, S_ISREG(st.st_mode) ? static_cast<size_t>(st.st_size) : 0);
+        ::close(fd);
+        return ok;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        bool ok = readAll(fd, length);
+        ::close(fd);
+        return ok;
+    }
+    ::close(fd);  // the mapping stays valid without the descriptor
+    madvise(base, length, MADV_SEQUENTIAL);
+    mapped = base;
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) munmap(mapped, length);
+}
+
+#endif
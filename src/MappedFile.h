@@ -0,0 +1,44 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file.
+//
+// Large files are memory-mapped so the kernel pages them in directly and
+// nothing is copied until the caller builds strings out of the bytes; small
+// files (below MAP_THRESHOLD) are simply read into memory, which is cheaper
+// than setting up a mapping. Pipes, devices and /proc-style files that
+// report no size are read to end of file the same way. Either way
+// data()/size() cover the raw bytes.
+class MappedFile {
+public:
+    static constexpr size_t MAP_THRESHOLD = 64 * 1024;
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file cannot be opened or read
+    bool open(const std::string& path);
+
+    const char* data() const { return mapped ? static_cast<const char*>(mapped) : contents.data(); }
+    size_t size() const { return length; }
+
+private:
+    void* mapped = nullptr;   // mapping base, or nullptr for small files
+    size_t length = 0;
+    std::string contents;     // small files only
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+    bool readAll(void* file, size_t sizeHint);
+#else
+    bool readAll(int fd, size_t sizeHint);
+#endif
+};
+
+#endif // MAPPEDFILE_H
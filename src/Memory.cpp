@@ -0,0 +1,260 @@
+#include "Memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace memory {
+namespace {
+
+// Written by one thread at a time: plain load + store, no locked add
+struct Counter {
+    std::atomic<uint64_t> value{0};
+
+    void add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+struct CounterSet {
+    Counter allocations, frees, bytes, freedBytes;
+
+    void addTo(Totals& t) const {
+        t.allocations += allocations.get();
+        t.frees += frees.get();
+        t.bytes += bytes.get();
+        t.freedBytes += freedBytes.get();
+    }
+};
+
+struct ThreadStats {
+    CounterSet heap;
+    CounterSet kinds[KINDS];
+    uint64_t allocationCount = 0;  // owner thread only, for threadAllocations()
+    int64_t pending = 0;           // bytes not yet added to liveHeap
+    std::atomic<bool> inUse{true};
+    ThreadStats* next = nullptr;
+};
+
+// Blocks are never freed, only handed to the next thread
+std::atomic<ThreadStats*> threads{nullptr};
+
+// Counts for frees that happen after a thread released its block (while
+// its other thread_locals are destroyed)
+ThreadStats orphan;
+std::mutex orphanMutex;
+
+thread_local ThreadStats* mine = nullptr;
+thread_local bool released = false;
+thread_local bool overdrawn = false;
+
+std::atomic<int64_t> liveHeap{0};
+std::atomic<uint64_t> limit{0};
+
+void flush(ThreadStats& s) {
+    int64_t delta = s.pending;
+    s.pending = 0;
+    int64_t live = liveHeap.fetch_add(delta, std::memory_order_relaxed) + delta;
+    uint64_t cap = limit.load(std::memory_order_relaxed);
+    if (cap && delta > 0 && live > static_cast<int64_t>(cap) && &s == mine) overdrawn = true;
+}
+
+ThreadStats* acquireBlock() {
+    for (ThreadStats* s = threads.load(std::memory_order_acquire); s; s = s->next) {
+        bool expected = false;
+        if (!s->inUse.load(std::memory_order_relaxed) &&
+            s->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return s;
+        }
+    }
+    // Placement into malloc'd memory: operator new would recurse
+    ThreadStats* s = new (std::malloc(sizeof(ThreadStats))) ThreadStats();
+    s->next = threads.load(std::memory_order_relaxed);
+    while (!threads.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed)) {}
+    return s;
+}
+
+struct Release {
+    ~Release() {
+        if (mine) {
+            flush(*mine);
+            mine->inUse.store(false, std::memory_order_release);
+        }
+        mine = nullptr;
+        released = true;
+    }
+};
+
+// The calling thread's block, or nullptr once it has been released
+ThreadStats* threadBlock() {
+    if (mine) return mine;
+    if (released) return nullptr;
+    mine = acquireBlock();
+    thread_local Release release;
+    (void)release;
+    return mine;
+}
+
+template <typename F>
+void update(F&& f) {
+    if (ThreadStats* s = threadBlock()) {
+        f(*s);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(orphanMutex);
+    f(orphan);
+}
+
+size_t blockSize(void* p) {
+#if defined(_WIN32)
+    return _msize(p);
+#elif defined(__APPLE__)
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+} // namespace
+
+const char* kindName(Kind kind) {
+    static const char* const names[KINDS] = {"strings", "arrays", "dictionaries", "instances", "environments",
+                                             "functions"};
+    return names[static_cast<size_t>(kind)];
+}
+
+void countObject(Kind kind, size_t bytes) {
+    update([&](ThreadStats& s) {
+        CounterSet& c = s.kinds[static_cast<size_t>(kind)];
+        c.allocations.add(1);
+        c.bytes.add(bytes);
+    });
+}
+
+void countObjectFree(Kind kind, size_t bytes) {
+    update([&](ThreadStats& s) {
+        CounterSet& c = s.kinds[static_cast<size_t>(kind)];
+        c.frees.add(1);
+        c.freedBytes.add(bytes);
+    });
+}
+
+Snapshot snapshot() {
+    Snapshot snap;
+    for (ThreadStats* s = threads.load(std::memory_order_acquire); s; s = s->next) {
+        s->heap.addTo(snap.heap);
+        for (size_t k = 0; k < KINDS; k++) s->kinds[k].addTo(snap.kinds[k]);
+    }
+    std::lock_guard<std::mutex> lock(orphanMutex);
+    orphan.heap.addTo(snap.heap);
+    for (size_t k = 0; k < KINDS; k++) orphan.kinds[k].addTo(snap.kinds[k]);
+    return snap;
+}
+
+void printReport() {
+    Snapshot snap = snapshot();
+    auto row = [](const char* name, const Totals& t) {
+        std::fprintf(stderr, "  %-14s %12llu %14llu %14llu %16llu\n", name, static_cast<unsigned long long>(t.live()),
+                     static_cast<unsigned long long>(t.liveBytes()), static_cast<unsigned long long>(t.allocations),
+                     static_cast<unsigned long long>(t.bytes));
+    };
+    std::fprintf(stderr, "\nMemory at exit\n");
+    std::fprintf(stderr, "  %-14s %12s %14s %14s %16s\n", "", "live", "live bytes", "allocated", "allocated bytes");
+    row("heap blocks", snap.heap);
+    for (size_t k = 0; k < KINDS; k++) row(kindName(static_cast<Kind>(k)), snap.kinds[k]);
+}
+
+void setHeapLimit(uint64_t bytes) {
+    limit.store(bytes, std::memory_order_relaxed);
+}
+
+uint64_t heapLimit() {
+    return limit.load(std::memory_order_relaxed);
+}
+
+uint64_t liveHeapBytes() {
+    int64_t live = liveHeap.load(std::memory_order_relaxed);
+    return live > 0 ? static_cast<uint64_t>(live) : 0;
+}
+
+bool heapNearLimit() {
+    uint64_t cap = heapLimit();
+    return cap && liveHeapBytes() > static_cast<uint64_t>(static_cast<double>(cap) * SHED_RATIO);
+}
+
+bool takeOverdraft() {
+    if (!overdrawn) return false;
+    overdrawn = false;
+    return true;
+}
+
+bool wouldExceedLimit(uint64_t bytes) {
+    uint64_t cap = heapLimit();
+    return cap && bytes > cap - std::min(cap, liveHeapBytes());
+}
+
+bool parseSize(const char* text, uint64_t& bytes) {
+    char* end = nullptr;
+    double n = std::strtod(text, &end);
+    if (end == text || n <= 0) return false;
+    switch (*end) {
+        case 'k': case 'K': n *= 1024.0; end++; break;
+        case 'm': case 'M': n *= 1024.0 * 1024.0; end++; break;
+        case 'g': case 'G': n *= 1024.0 * 1024.0 * 1024.0; end++; break;
+        default: break;
+    }
+    if (*end == 'b' || *end == 'B') end++;
+    if (*end != '\0') return false;
+    bytes = static_cast<uint64_t>(n);
+    return true;
+}
+
+uint64_t threadAllocations() {
+    return mine ? mine->allocationCount : 0;
+}
+
+} // namespace memory
+
+// The array and nothrow forms forward to these, so every operator new
+// block is counted; the over-aligned forms are left to the runtime
+void* operator new(std::size_t size) {
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) {
+            size_t bytes = memory::blockSize(p);
+            memory::update([&](memory::ThreadStats& s) {
+                s.allocationCount++;
+                s.heap.allocations.add(1);
+                s.heap.bytes.add(bytes);
+                s.pending += static_cast<int64_t>(bytes);
+                if (s.pending >= memory::FLUSH_BYTES) memory::flush(s);
+            });
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    size_t bytes = memory::blockSize(p);
+    memory::update([&](memory::ThreadStats& s) {
+        s.heap.frees.add(1);
+        s.heap.freedBytes.add(bytes);
+        s.pending -= static_cast<int64_t>(bytes);
+        if (s.pending <= -memory::FLUSH_BYTES) memory::flush(s);
+    });
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
@@ -0,0 +1,141 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class EZString;
+class Environment;
+struct Value;
+struct EZDictionary;
+struct EZInstance;
+struct EZFunction;
+struct EZTypedArray;
+
+// Heap and object accounting behind memstats() and `ez --memstats`.
+//
+// Memory.cpp replaces the global operator new/delete, so every block the
+// C++ code allocates or frees through them is counted with its real
+// (usable) size. Memory that bypasses them is not seen: malloc from SQLite,
+// libcurl and the C runtime, over-aligned operator new, mmap (readFile's
+// mapped files), and thread stacks. The totals are therefore a floor for
+// the process's heap, not its resident size. On top of that, the heap objects behind EZ values are created with
+// memory::make, which charges each object (with its reference count) to
+// its kind. Kind figures cover the objects themselves; the buffers they
+// own (string bytes, array slots, dictionary entries) count toward the
+// heap totals only.
+//
+// Counters live in per-thread blocks that only their thread writes (no
+// atomic read-modify-write on the allocation path) and are summed when a
+// snapshot is taken. A thread's block is reused by the next thread to
+// start after it exits.
+//
+// For the --max-heap cap each thread also keeps a running balance that it
+// adds to a process-wide live byte count every FLUSH_BYTES. A thread that
+// adds to that count while it is over the limit is marked overdrawn, and
+// its interpreter raises a RuntimeError at its next statement. Natives that
+// build a large value in one call check the mark as they go, and refuse up
+// front a single allocation that would not fit.
+namespace memory {
+
+constexpr int64_t FLUSH_BYTES = 64 * 1024;
+// server() answers 503 above this share of the limit
+constexpr double SHED_RATIO = 0.9;
+
+enum class Kind { STRING, ARRAY, DICTIONARY, INSTANCE, ENVIRONMENT, FUNCTION, COUNT };
+
+constexpr size_t KINDS = static_cast<size_t>(Kind::COUNT);
+
+// "strings", "arrays", ... as shown by memstats()
+const char* kindName(Kind kind);
+
+struct Totals {
+    uint64_t allocations = 0;  // blocks allocated so far
+    uint64_t frees = 0;
+    uint64_t bytes = 0;        // bytes allocated so far
+    uint64_t freedBytes = 0;
+
+    uint64_t live() const { return allocations - frees; }
+    uint64_t liveBytes() const { return bytes - freedBytes; }
+};
+
+struct Snapshot {
+    Totals heap;
+    Totals kinds[KINDS];
+};
+
+// Sum over all threads; exact once the counted threads are quiet
+Snapshot snapshot();
+
+// Writes the --memstats table (the snapshot above) to stderr
+void printReport();
+
+// Cap on live heap bytes; 0 (the default) for none
+void setHeapLimit(uint64_t bytes);
+uint64_t heapLimit();
+
+// Live heap bytes as of the last flush of every thread (within
+// FLUSH_BYTES per thread of the exact figure)
+uint64_t liveHeapBytes();
+
+// True when a limit is set and live heap is above SHED_RATIO of it
+bool heapNearLimit();
+
+// Whether the calling thread grew the heap past the limit since the last
+// call; clears the mark
+bool takeOverdraft();
+
+// True when a limit is set and `bytes` more would take live heap past it
+bool wouldExceedLimit(uint64_t bytes);
+
+// Parses "512M", "2G", "64k", "1048576" into bytes; false if malformed
+bool parseSize(const char* text, uint64_t& bytes);
+
+// Heap allocations made by the calling thread so far
+uint64_t threadAllocations();
+
+void countObject(Kind kind, size_t bytes);
+void countObjectFree(Kind kind, size_t bytes);
+
+template <typename T> struct KindOf;
+template <> struct KindOf<EZString> { static constexpr Kind value = Kind::STRING; };
+template <> struct KindOf<std::vector<Value>> { static constexpr Kind value = Kind::ARRAY; };
+template <> struct KindOf<EZTypedArray> { static constexpr Kind value = Kind::ARRAY; };
+template <> struct KindOf<EZDictionary> { static constexpr Kind value = Kind::DICTIONARY; };
+template <> struct KindOf<EZInstance> { static constexpr Kind value = Kind::INSTANCE; };
+template <> struct KindOf<Environment> { static constexpr Kind value = Kind::ENVIRONMENT; };
+template <> struct KindOf<EZFunction> { static constexpr Kind value = Kind::FUNCTION; };
+
+// std::allocator that charges what it allocates to kind K
+template <typename T, Kind K>
+struct Allocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = Allocator<U, K>; };
+
+    Allocator() = default;
+    template <typename U> Allocator(const Allocator<U, K>&) {}
+
+    T* allocate(size_t n) {
+        countObject(K, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        countObjectFree(K, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const Allocator<U, K>&) const { return true; }
+    template <typename U> bool operator!=(const Allocator<U, K>&) const { return false; }
+};
+
+// std::make_shared, counted under T's kind
+template <typename T, typename... Args>
+std::shared_ptr<T> make(Args&&... args) {
+    return std::allocate_shared<T>(Allocator<T, KindOf<T>::value>(), std::forward<Args>(args)...);
+}
+
+} // namespace memory
+
+#endif // MEMORY_H
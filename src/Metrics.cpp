@@ -0,0 +1,101 @@
+#include "Metrics.h"
+#include "Memory.h"
+#include <cstdio>
+
+uint64_t ServerMetrics::Histogram::upperBound(int index) {
+    if (index == 0) return uint64_t(1) << MIN_EXP;
+    int e = MIN_EXP + (index - 1) / SUB_BUCKETS;
+    int sub = (index - 1) % SUB_BUCKETS;
+    return (uint64_t(1) << e) + ((uint64_t(sub + 1) << e) / SUB_BUCKETS);
+}
+
+void ServerMetrics::Histogram::record(uint64_t micros) {
+    int index;
+    if (micros <= (uint64_t(1) << MIN_EXP)) {
+        index = 0;
+    } else {
+        // Bounds are inclusive, so bucket micros - 1 against the lower edges;
+        // the last finite bucket ends at 2^MAX_EXP
+        uint64_t w = micros - 1;
+        if ((w >> MAX_EXP) != 0) {
+            index = BUCKETS;
+        } else {
+            int e = MIN_EXP;
+            while ((w >> (e + 1)) != 0) e++;
+            int sub = static_cast<int>(((w - (uint64_t(1) << e)) * SUB_BUCKETS) >> e);
+            index = 1 + (e - MIN_EXP) * SUB_BUCKETS + sub;
+        }
+    }
+    counts[index].fetch_add(1, std::memory_order_relaxed);
+    sumMicros.fetch_add(micros, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::Histogram::write(std::string& out, const char* name, const char* help) const {
+    char line[320];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    out += line;
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        std::snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, upperBound(i) / 1e6,
+                      static_cast<unsigned long long>(cumulative));
+        out += line;
+    }
+    cumulative += counts[BUCKETS].load(std::memory_order_relaxed);
+    std::snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n%s_sum %.6f\n%s_count %llu\n", name,
+                  static_cast<unsigned long long>(cumulative), name, sumMicros.load(std::memory_order_relaxed) / 1e6,
+                  name, static_cast<unsigned long long>(cumulative));
+    out += line;
+}
+
+void ServerMetrics::recordStatus(int status) {
+    if (status < 0 || status >= MAX_STATUS) status = 0;
+    statusCounts[status].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string ServerMetrics::render() const {
+    std::string out;
+    char line[320];
+    out += "# HELP ez_http_requests_total Requests answered, by status code.\n";
+    out += "# TYPE ez_http_requests_total counter\n";
+    for (int code = 0; code < MAX_STATUS; code++) {
+        uint64_t n = statusCounts[code].load(std::memory_order_relaxed);
+        if (!n) continue;
+        std::snprintf(line, sizeof(line), "ez_http_requests_total{code=\"%d\"} %llu\n", code,
+                      static_cast<unsigned long long>(n));
+        out += line;
+    }
+    std::snprintf(line, sizeof(line),
+                  "# HELP ez_http_received_bytes_total Bytes read from clients.\n"
+                  "# TYPE ez_http_received_bytes_total counter\nez_http_received_bytes_total %llu\n",
+                  static_cast<unsigned long long>(bytesIn.load(std::memory_order_relaxed)));
+    out += line;
+    std::snprintf(line, sizeof(line),
+                  "# HELP ez_http_sent_bytes_total Bytes sent to clients.\n"
+                  "# TYPE ez_http_sent_bytes_total counter\nez_http_sent_bytes_total %llu\n",
+                  static_cast<unsigned long long>(bytesOut.load(std::memory_order_relaxed)));
+    out += line;
+    std::snprintf(line, sizeof(line),
+                  "# HELP ez_http_active_connections Connections being served.\n"
+                  "# TYPE ez_http_active_connections gauge\nez_http_active_connections %lld\n",
+                  static_cast<long long>(active.load(std::memory_order_relaxed)));
+    out += line;
+    handlerTime.write(out, "ez_http_handler_seconds", "Time spent in the EZ handler.");
+    queueWait.write(out, "ez_http_queue_wait_seconds", "Time from accept until a thread picked the connection up.");
+    dbTime.write(out, "ez_db_query_seconds", "Time spent in dbExec and dbQuery.");
+    // The exact sum over threads, not the --max-heap running count that
+    // lags by up to FLUSH_BYTES per thread. Threads keep allocating while
+    // it is summed, so a free can be seen before its allocation
+    memory::Totals heap = memory::snapshot().heap;
+    uint64_t liveHeap = heap.bytes > heap.freedBytes ? heap.bytes - heap.freedBytes : 0;
+    std::snprintf(line, sizeof(line),
+                  "# HELP ez_heap_live_bytes Live bytes allocated through operator new, summed over threads.\n"
+                  "# TYPE ez_heap_live_bytes gauge\nez_heap_live_bytes %llu\n"
+                  "# HELP ez_heap_limit_bytes The --max-heap limit (0 if none).\n"
+                  "# TYPE ez_heap_limit_bytes gauge\nez_heap_limit_bytes %llu\n",
+                  static_cast<unsigned long long>(liveHeap),
+                  static_cast<unsigned long long>(memory::heapLimit()));
+    out += line;
+    return out;
+}
@@ -0,0 +1,88 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Counters behind server()'s metrics endpoint (/__metrics by default).
+//
+// Everything is a relaxed atomic, so request threads update them without
+// locks, and render() produces the Prometheus text exposition format
+// without going through the EZ handler.
+class ServerMetrics {
+public:
+    static ServerMetrics& instance() {
+        static ServerMetrics metrics;
+        return metrics;
+    }
+
+    // Latency histogram with HDR-style log-linear buckets: each power of
+    // two of microseconds from 2^MIN_EXP to 2^MAX_EXP (16 us to ~34 s) is
+    // split into SUB_BUCKETS equal parts, so a bucket is at most 50% wide
+    // and the bucket for a value is found with shifts
+    class Histogram {
+    public:
+        static constexpr int MIN_EXP = 4;
+        static constexpr int MAX_EXP = 25;
+        static constexpr int SUB_BUCKETS = 2;
+        static constexpr int BUCKETS = 1 + (MAX_EXP - MIN_EXP) * SUB_BUCKETS;  // plus +Inf
+
+        void record(uint64_t micros);
+        void write(std::string& out, const char* name, const char* help) const;
+
+        // Records the time from construction to destruction
+        class Timer {
+        public:
+            explicit Timer(Histogram& histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+            ~Timer() {
+                histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count()));
+            }
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+        private:
+            Histogram& histogram;
+            std::chrono::steady_clock::time_point start;
+        };
+
+    private:
+        std::atomic<uint64_t> counts[BUCKETS + 1] = {};
+        std::atomic<uint64_t> sumMicros{0};
+        std::atomic<uint64_t> total{0};
+
+        static uint64_t upperBound(int index);  // in microseconds
+    };
+
+    // Counts a connection as active for its lifetime
+    class Connection {
+    public:
+        Connection() { instance().active.fetch_add(1, std::memory_order_relaxed); }
+        ~Connection() { instance().active.fetch_sub(1, std::memory_order_relaxed); }
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+    };
+
+    Histogram handlerTime;  // EZ handler, per request
+    Histogram queueWait;    // accept() until the request thread starts
+    Histogram dbTime;       // dbExec/dbQuery, per call
+
+    void addBytesIn(uint64_t n) { bytesIn.fetch_add(n, std::memory_order_relaxed); }
+    void addBytesOut(uint64_t n) { bytesOut.fetch_add(n, std::memory_order_relaxed); }
+    void recordStatus(int status);
+
+    std::string render() const;
+
+private:
+    ServerMetrics() = default;
+
+    static constexpr int MAX_STATUS = 600;
+    std::atomic<uint64_t> statusCounts[MAX_STATUS] = {};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<int64_t> active{0};
+};
+
+#endif // METRICS_H
@@ -0,0 +1,69 @@
+#ifndef NUMBERS_H
+#define NUMBERS_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Number <-> text conversions shared by toString/str/join, num(), the lexer,
+// JSON and the database bindings. Both directions use <charconv>, which is
+// locale-independent and much faster than std::to_string/std::stod.
+
+// Whole numbers up to this magnitude are exact doubles and print as integers
+constexpr double MAX_EXACT_INTEGER = 9007199254740992.0;  // 2^53
+
+// Writes the shortest text that reads back as exactly d into buf (at least
+// 32 bytes) and returns its length: "42", "0.1", "3000000000", "1e+300".
+// NaN and infinities print as "nan", "inf", "-inf".
+inline size_t formatNumber(double d, char* buf) {
+    if (d > -MAX_EXACT_INTEGER && d < MAX_EXACT_INTEGER) {
+        int64_t n = static_cast<int64_t>(d);
+        if (static_cast<double>(n) == d) return std::to_chars(buf, buf + 32, n).ptr - buf;
+    }
+    return std::to_chars(buf, buf + 32, d).ptr - buf;
+}
+
+inline void appendNumber(std::string& out, double d) {
+    char buf[32];
+    out.append(buf, formatNumber(d, buf));
+}
+
+inline std::string formatNumber(double d) {
+    // std::to_string builds integers in place, which beats copying from
+    // buf, and 32-bit division is cheaper for the common small values
+    if (d > -2147483649.0 && d < 2147483648.0) {
+        int n = static_cast<int>(d);
+        if (static_cast<double>(n) == d) return std::to_string(n);
+    } else if (d > -MAX_EXACT_INTEGER && d < MAX_EXACT_INTEGER) {
+        int64_t n = static_cast<int64_t>(d);
+        if (static_cast<double>(n) == d) return std::to_string(n);
+    }
+    char buf[32];
+    return std::string(buf, std::to_chars(buf, buf + sizeof(buf), d).ptr - buf);
+}
+
+// Parses the whole of text as a decimal number ("12", "-0.5", "1e3", "inf").
+// Surrounding whitespace and a leading '+' are allowed; anything else makes
+// it return false. Values beyond the double range become +-inf (or 0).
+inline bool parseNumber(std::string_view text, double& out) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) return false;
+    size_t end = text.find_last_not_of(" \t\r\n") + 1;
+    const char* first = text.data() + begin;
+    const char* last = text.data() + end;
+    if (*first == '+' && last - first > 1 && first[1] != '-') first++;
+
+    auto result = std::from_chars(first, last, out);
+    if (result.ptr != last) return false;
+    if (result.ec == std::errc::result_out_of_range) {
+        // from_chars leaves out untouched; strtod saturates
+        out = std::strtod(std::string(first, last).c_str(), nullptr);
+    } else if (result.ec != std::errc()) {
+        return false;
+    }
+    return true;
+}
+
+#endif // NUMBERS_H
@@ -0,0 +1,294 @@
+#ifndef ORDEREDMAP_H
+#define ORDEREDMAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ORDEREDMAP_SSE2 1
+#endif
+
+// Insertion-ordered hash map from string keys to V.
+//
+// Entries live in one dense vector in insertion order, so iteration is
+// deterministic and cache friendly. Lookups go through an open-addressing
+// index of 1-byte control tags (7 bits of the hash, or EMPTY/DELETED) probed
+// 16 at a time, with a parallel array of entry positions. Maps with at most
+// SMALL_LIMIT keys skip the index entirely and are scanned linearly.
+//
+// The interface mirrors the subset of std::unordered_map the interpreter
+// uses (operator[], find, count, at, erase, iteration over first/second).
+template<typename V>
+class OrderedMap {
+public:
+    struct Entry {
+        std::string first;
+        V second;
+        size_t hash;
+        bool alive;
+    };
+
+    template<typename EntryT>
+    class Iter {
+    public:
+        Iter(EntryT* pos, EntryT* last) : pos(pos), last(last) { skipDead(); }
+        EntryT& operator*() const { return *pos; }
+        EntryT* operator->() const { return pos; }
+        Iter& operator++() { ++pos; skipDead(); return *this; }
+        bool operator==(const Iter& other) const { return pos == other.pos; }
+        bool operator!=(const Iter& other) const { return pos != other.pos; }
+    private:
+        friend class OrderedMap;
+        EntryT* pos;
+        EntryT* last;
+        void skipDead() { while (pos != last && !pos->alive) ++pos; }
+    };
+
+    using iterator = Iter<Entry>;
+    using const_iterator = Iter<const Entry>;
+
+    OrderedMap() = default;
+
+    size_t size() const { return liveCount; }
+    bool empty() const { return liveCount == 0; }
+
+    iterator begin() { return iterator(entries.data(), entries.data() + entries.size()); }
+    iterator end() { return iterator(entries.data() + entries.size(), entries.data() + entries.size()); }
+    const_iterator begin() const { return const_iterator(entries.data(), entries.data() + entries.size()); }
+    const_iterator end() const { return const_iterator(entries.data() + entries.size(), entries.data() + entries.size()); }
+
+    iterator find(const std::string& key) {
+        size_t pos = lookup(key, hashKey(key));
+        if (pos == NPOS) return end();
+        return iterator(entries.data() + pos, entries.data() + entries.size());
+    }
+
+    const_iterator find(const std::string& key) const {
+        size_t pos = lookup(key, hashKey(key));
+        if (pos == NPOS) return end();
+        return const_iterator(entries.data() + pos, entries.data() + entries.size());
+    }
+
+    size_t count(const std::string& key) const {
+        return lookup(key, hashKey(key)) != NPOS ? 1 : 0;
+    }
+
+    V& at(const std::string& key) {
+        size_t pos = lookup(key, hashKey(key));
+        if (pos == NPOS) throw std::out_of_range("OrderedMap::at: key not found");
+        return entries[pos].second;
+    }
+
+    const V& at(const std::string& key) const {
+        size_t pos = lookup(key, hashKey(key));
+        if (pos == NPOS) throw std::out_of_range("OrderedMap::at: key not found");
+        return entries[pos].second;
+    }
+
+    V& operator[](const std::string& key) {
+        size_t h = hashKey(key);
+        size_t pos = lookup(key, h);
+        if (pos != NPOS) return entries[pos].second;
+        return entries[append(key, V(), h)].second;
+    }
+
+    V& operator[](std::string&& key) {
+        size_t h = hashKey(key);
+        size_t pos = lookup(key, h);
+        if (pos != NPOS) return entries[pos].second;
+        return entries[append(std::move(key), V(), h)].second;
+    }
+
+    // Insert or overwrite; keeps the original position of an existing key.
+    void set(std::string key, V value) {
+        size_t h = hashKey(key);
+        size_t pos = lookup(key, h);
+        if (pos != NPOS) {
+            entries[pos].second = std::move(value);
+            return;
+        }
+        append(std::move(key), std::move(value), h);
+    }
+
+    size_t erase(const std::string& key) {
+        size_t h = hashKey(key);
+        size_t pos = lookup(key, h);
+        if (pos == NPOS) return 0;
+
+        if (!ctrl.empty()) {
+            size_t slot = findSlot(key, h);
+            ctrl[slot] = DELETED;
+            tombstones++;
+        }
+        entries[pos].alive = false;
+        entries[pos].first.clear();
+        entries[pos].first.shrink_to_fit();
+        entries[pos].second = V();
+        liveCount--;
+
+        // Keep the entry array dense: compact once half of it is dead.
+        if (entries.size() - liveCount > liveCount && entries.size() > SMALL_LIMIT) {
+            compact();
+        }
+        return 1;
+    }
+
+    void clear() {
+        entries.clear();
+        ctrl.clear();
+        slots.clear();
+        liveCount = 0;
+        tombstones = 0;
+    }
+
+    void reserve(size_t n) {
+        entries.reserve(n);
+        if (n > SMALL_LIMIT) rehash(capacityFor(n));
+    }
+
+private:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    static constexpr size_t SMALL_LIMIT = 8;
+    static constexpr size_t GROUP = 16;
+    static constexpr uint8_t EMPTY = 0x80;
+    static constexpr uint8_t DELETED = 0xFE;
+
+    std::vector<Entry> entries;
+    std::vector<uint8_t> ctrl;     // one tag per slot; empty while small
+    std::vector<uint32_t> slots;   // entry position for each full slot
+    size_t liveCount = 0;
+    size_t tombstones = 0;
+
+    static size_t hashKey(const std::string& key) { return std::hash<std::string>()(key); }
+    static uint8_t tagOf(size_t h) { return static_cast<uint8_t>(h & 0x7F); }
+    size_t groupMask() const { return ctrl.size() / GROUP - 1; }
+
+    static size_t capacityFor(size_t n) {
+        size_t cap = GROUP;
+        while (cap * 7 / 8 < n) cap *= 2;
+        return cap;
+    }
+
+    // Bitmask of positions in the 16-byte group whose tag equals `tag`.
+    static uint32_t matchGroup(const uint8_t* group, uint8_t tag) {
+#ifdef ORDEREDMAP_SSE2
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            if (group[i] == tag) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    static int lowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+        return __builtin_ctz(mask);
+#else
+        int i = 0;
+        while (!(mask & 1u)) { mask >>= 1; i++; }
+        return i;
+#endif
+    }
+
+    // Position in `entries` of a live key, or NPOS.
+    size_t lookup(const std::string& key, size_t h) const {
+        if (ctrl.empty()) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                const Entry& e = entries[i];
+                if (e.alive && e.hash == h && e.first == key) return i;
+            }
+            return NPOS;
+        }
+        size_t slot = findSlot(key, h);
+        return slot == NPOS ? NPOS : slots[slot];
+    }
+
+    // Index slot holding `key`, or NPOS. Requires a built index.
+    size_t findSlot(const std::string& key, size_t h) const {
+        uint8_t tag = tagOf(h);
+        size_t mask = groupMask();
+        size_t g = (h >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            const uint8_t* group = ctrl.data() + g * GROUP;
+            uint32_t hits = matchGroup(group, tag);
+            while (hits) {
+                int bit = lowestBit(hits);
+                size_t slot = g * GROUP + bit;
+                const Entry& e = entries[slots[slot]];
+                if (e.hash == h && e.first == key) return slot;
+                hits &= hits - 1;
+            }
+            if (matchGroup(group, EMPTY)) return NPOS;
+            g = (g + step) & mask;  // triangular probing visits every group
+        }
+    }
+
+    void insertSlot(size_t h, uint32_t entryPos) {
+        size_t mask = groupMask();
+        size_t g = (h >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            uint8_t* group = ctrl.data() + g * GROUP;
+            for (size_t i = 0; i < GROUP; i++) {
+                if (group[i] == EMPTY || group[i] == DELETED) {
+                    if (group[i] == DELETED) tombstones--;
+                    group[i] = tagOf(h);
+                    slots[g * GROUP + i] = entryPos;
+                    return;
+                }
+            }
+            g = (g + step) & mask;
+        }
+    }
+
+    template<typename K>
+    size_t append(K&& key, V value, size_t h) {
+        size_t pos = entries.size();
+        entries.push_back(Entry{std::forward<K>(key), std::move(value), h, true});
+        liveCount++;
+
+        if (ctrl.empty()) {
+            if (entries.size() > SMALL_LIMIT) rehash(capacityFor(entries.size()));
+        } else if ((liveCount + tombstones) > ctrl.size() * 7 / 8) {
+            rehash(capacityFor(liveCount * 2));
+        } else {
+            insertSlot(h, static_cast<uint32_t>(pos));
+        }
+        return pos;
+    }
+
+    void rehash(size_t capacity) {
+        ctrl.assign(capacity, EMPTY);
+        slots.assign(capacity, 0);
+        tombstones = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].alive) insertSlot(entries[i].hash, static_cast<uint32_t>(i));
+        }
+    }
+
+    void compact() {
+        size_t out = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (!entries[i].alive) continue;
+            if (out != i) entries[out] = std::move(entries[i]);
+            out++;
+        }
+        entries.resize(out);
+        if (entries.size() <= SMALL_LIMIT) {
+            ctrl.clear();
+            slots.clear();
+            tombstones = 0;
+        } else {
+            rehash(capacityFor(entries.size()));
+        }
+    }
+};
+
+#endif // ORDEREDMAP_H
@@ -0,0 +1,128 @@
+#include "Output.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool stdoutIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdout)) != 0;
+#else
+    return isatty(fileno(stdout)) != 0;
+#endif
+}
+
+// Static rather than owned by Output so it outlives everything that might
+// still flush stdout during exit
+char stdoutBuffer[Output::BUFFER_SIZE];
+
+} // namespace
+
+void Output::init() {
+    const char* env = std::getenv("EZ_STDOUT");
+    std::string choice = env ? env : "";
+    if (choice == "line") currentMode = Mode::LINE;
+    else if (choice == "block") currentMode = Mode::BLOCK;
+    else currentMode = stdoutIsTerminal() ? Mode::LINE : Mode::BLOCK;
+
+    // Full buffering in both modes: LINE flushes by itself in write(), since
+    // the Windows CRT treats _IOLBF as full buffering
+    std::setvbuf(stdout, stdoutBuffer, _IOFBF, sizeof(stdoutBuffer));
+
+    std::atexit([] { Output::instance().flush(); });
+    std::set_terminate([] {
+        Output::instance().flush();
+        std::abort();
+    });
+    for (int sig : {SIGSEGV, SIGFPE, SIGILL, SIGABRT}) {
+        std::signal(sig, flushOnSignal);
+    }
+
+#ifdef _WIN32
+    // Console control handlers already run on a thread of their own;
+    // returning FALSE lets the default handler end the process
+    SetConsoleCtrlHandler([](DWORD type) -> BOOL {
+        if (type == CTRL_C_EVENT || type == CTRL_BREAK_EVENT || type == CTRL_CLOSE_EVENT) {
+            if (auto stop = instance().interruptHandler.load()) stop();
+            instance().flush();
+        }
+        return FALSE;
+    }, TRUE);
+    std::signal(SIGTERM, flushOnSignal);
+#else
+    // Threads inherit the mask, so only the waiting thread ever sees these
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    std::thread([set] {
+        int sig = 0;
+        while (sigwait(&set, &sig) != 0) {}
+        instance().interrupted(sig);
+    }).detach();
+#endif
+}
+
+void Output::setInterruptHandler(void (*stop)()) {
+    interruptHandler.store(stop);
+}
+
+void Output::interrupted(int sig) {
+    if (auto stop = interruptHandler.load()) stop();
+    flush();
+#ifndef _WIN32
+    std::signal(sig, SIG_DFL);
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, sig);
+    pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+#endif
+    std::raise(sig);
+}
+
+void Output::setMode(Mode m) {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentMode = m;
+    if (m == Mode::LINE) std::fflush(stdout);
+}
+
+void Output::write(std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    if (currentMode == Mode::LINE && std::memchr(text.data(), '\n', text.size())) {
+        std::fflush(stdout);
+    }
+}
+
+void Output::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fflush(stdout);
+}
+
+// Best effort: hand whatever is buffered to the OS, then die the way the
+// signal would have. The lock is only tried, so a crash inside write()
+// cannot deadlock here.
+void Output::flushOnSignal(int sig) {
+    Output& out = instance();
+    if (out.mutex.try_lock()) {
+        std::fflush(stdout);
+        out.mutex.unlock();
+    }
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
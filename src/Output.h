@@ -0,0 +1,60 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+
+// Buffered standard output shared by `out`, print() and the runtime.
+//
+// stdout gets a BUFFER_SIZE stdio buffer. When it is a terminal the buffer
+// is flushed after every write that ends a line, so interactive output shows
+// up as before; when it is a pipe or file it is only flushed when full, on
+// flush(), before reading input, and at exit, which turns millions of `out`
+// lines into a few large writes. EZ_STDOUT=line or EZ_STDOUT=block overrides
+// the choice.
+//
+// Each write() goes out whole under a mutex, so lines from spawned tasks and
+// server threads never interleave mid-line. std::cout shares the same stdio
+// stream, so anything still printed through it stays in order.
+class Output {
+public:
+    enum class Mode { LINE, BLOCK };
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    static Output& instance() {
+        static Output output;
+        return output;
+    }
+
+    // Picks the mode and installs the exit, terminate and fatal-signal
+    // handlers that flush pending output. Called once from main(), before
+    // any other thread starts.
+    void init();
+
+    // Runs `stop` when SIGINT or SIGTERM (Ctrl-C or Ctrl-Break on Windows)
+    // ends the process, before stdout is flushed. The signals are blocked
+    // in every thread and taken by one waiting thread, so `stop` runs as
+    // ordinary code and can take locks and write files.
+    void setInterruptHandler(void (*stop)());
+
+    void write(std::string_view text);
+    void flush();
+
+    Mode mode() const { return currentMode; }
+    void setMode(Mode m);
+
+private:
+    Output() = default;
+
+    std::mutex mutex;
+    Mode currentMode = Mode::LINE;
+    std::atomic<void (*)()> interruptHandler{nullptr};
+
+    static void flushOnSignal(int sig);
+    // Runs the interrupt handler, flushes and ends the process by sig
+    void interrupted(int sig);
+};
+
+#endif // OUTPUT_H
@@ -109,6 +109,7 @@ void Parser::synchronize() {
             case TokenType::GET:
             case TokenType::OUT:
             case TokenType::GIVE:
+            case TokenType::YIELD:
             case TokenType::ESCAPE:
             case TokenType::SKIP:
                 return;
@@ -140,6 +141,7 @@ StmtPtr Parser::statement() {
     if (match(TokenType::GET)) return getStatement();
     if (match(TokenType::TASK)) return taskStatement();
     if (match(TokenType::GIVE)) return giveStatement();
+    if (match(TokenType::YIELD)) return yieldStatement();
     if (match(TokenType::ESCAPE)) return escapeStatement();
     if (match(TokenType::SKIP)) return skipStatement();
     if (match(TokenType::LBRACE)) return blockStatement();
@@ -302,6 +304,8 @@ StmtPtr Parser::taskStatement() {
     consume(TokenType::RPAREN, "Expected ')' after parameters");
     skipNewlines();
     
+    bool outerSawYield;
+    beginFunctionBody(outerSawYield);
     std::vector<StmtPtr> body;
     if (match(TokenType::LBRACE)) {
         skipNewlines();
@@ -310,14 +314,30 @@ StmtPtr Parser::taskStatement() {
             if (stmt) body.push_back(stmt);
             skipNewlines();
         }
+        bool isGenerator = endFunctionBody(outerSawYield);
         consume(TokenType::RBRACE, "Expected '}' after function body");
-    } else {
-        // Single statement body
-        auto stmt = statement();
-        if (stmt) body.push_back(stmt);
+        return makeTaskStmt(line, name, params, body, isGenerator);
     }
     
-    return makeTaskStmt(line, name, params, body);
+    // Single statement body
+    auto stmt = statement();
+    if (stmt) body.push_back(stmt);
+    bool isGenerator = endFunctionBody(outerSawYield);
+    return makeTaskStmt(line, name, params, body, isGenerator);
+}
+
+void Parser::beginFunctionBody(bool& outerSawYield) {
+    outerSawYield = sawYield;
+    sawYield = false;
+    functionDepth++;
+}
+
+// Returns whether the body just parsed was a generator
+bool Parser::endFunctionBody(bool outerSawYield) {
+    bool isGenerator = sawYield;
+    sawYield = outerSawYield;
+    functionDepth--;
+    return isGenerator;
 }
 
 StmtPtr Parser::giveStatement() {
@@ -331,6 +351,22 @@ StmtPtr Parser::giveStatement() {
     return makeGiveStmt(line, value);
 }
 
+StmtPtr Parser::yieldStatement() {
+    int line = previous().line;
+    
+    if (functionDepth == 0) {
+        throw ParseError("'yield' can only be used inside a task", line);
+    }
+    sawYield = true;
+    
+    ExprPtr value = nullptr;
+    if (!check(TokenType::NEWLINE) && !check(TokenType::END_OF_FILE) && !check(TokenType::RBRACE)) {
+        value = expression();
+    }
+    
+    return makeYieldStmt(line, value);
+}
+
 StmtPtr Parser::escapeStatement() {
     int line = previous().line;
     return makeEscapeStmt(line);
@@ -731,14 +767,17 @@ ExprPtr Parser::lambdaExpression() {
     } else if (match(TokenType::LBRACE)) {
         // Statement body
         skipNewlines();
+        bool outerSawYield;
+        beginFunctionBody(outerSawYield);
         std::vector<StmtPtr> stmtBody;
         while (!check(TokenType::RBRACE) && !isAtEnd()) {
             auto stmt = declaration();
             if (stmt) stmtBody.push_back(stmt);
             skipNewlines();
         }
+        bool isGenerator = endFunctionBody(outerSawYield);
         consume(TokenType::RBRACE, "Expected '}' after lambda body");
-        return makeLambdaExpr(line, params, stmtBody);
+        return makeLambdaExpr(line, params, stmtBody, isGenerator);
     } else {
         // Default: treat as expression body without arrow
         ExprPtr body = expression();
@@ -821,6 +860,8 @@ StmtPtr Parser::modelStatement() {
             consume(TokenType::RPAREN, "Expected ')' after method parameters");
             skipNewlines();
             
+            bool outerSawYield;
+            beginFunctionBody(outerSawYield);
             std::vector<StmtPtr> body;
             if (match(TokenType::LBRACE)) {
                 skipNewlines();
@@ -831,6 +872,7 @@ StmtPtr Parser::modelStatement() {
                 }
                 consume(TokenType::RBRACE, "Expected '}' after method body");
             }
+            bool isGenerator = endFunctionBody(outerSawYield);
             
             ModelMember member;
             member.visibility = visibility;
@@ -838,6 +880,7 @@ StmtPtr Parser::modelStatement() {
             member.name = methodName.lexeme;
             member.params = params;
             member.body = body;
+            member.isGenerator = isGenerator;
             members.push_back(member);
         }
         // Property declaration
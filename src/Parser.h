@@ -24,6 +24,14 @@ private:
     std::vector<Token> tokens;
     size_t current = 0;
     bool hadError = false;
+    
+    // Function bodies being parsed, and whether the innermost one has
+    // used 'yield' (which makes it a generator)
+    int functionDepth = 0;
+    bool sawYield = false;
+    
+    void beginFunctionBody(bool& outerSawYield);
+    bool endFunctionBody(bool outerSawYield);
 
     // Token navigation
     bool isAtEnd() const;
@@ -53,6 +61,7 @@ private:
     StmtPtr getStatement();
     StmtPtr taskStatement();
     StmtPtr giveStatement();
+    StmtPtr yieldStatement();
     StmtPtr escapeStatement();
     StmtPtr skipStatement();
     StmtPtr blockStatement();
@@ -0,0 +1,183 @@
+#include "Platform.h"
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <conio.h>
+#include <windows.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace platform {
+
+#ifdef _WIN32
+
+bool startNetwork() {
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+}
+
+void stopNetwork() {
+    WSACleanup();
+}
+
+void closeSocket(Socket s) {
+    closesocket(s);
+}
+
+#else
+
+bool startNetwork() {
+    return true;
+}
+
+void stopNetwork() {}
+
+void closeSocket(Socket s) {
+    close(s);
+}
+
+#endif
+
+Socket listenTcp(int port, const char*& error) {
+    Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == NO_SOCKET) {
+        error = "Socket creation failed";
+        return NO_SOCKET;
+    }
+#ifndef _WIN32
+    // Allow a restarted server to bind while old connections sit in TIME_WAIT
+    // (SO_REUSEADDR means something else, port sharing, on Windows)
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#endif
+
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(static_cast<unsigned short>(port));
+
+    if (bind(s, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) != 0) {
+        closeSocket(s);
+        error = "Bind failed";
+        return NO_SOCKET;
+    }
+    if (listen(s, SOMAXCONN) != 0) {
+        closeSocket(s);
+        error = "Listen failed";
+        return NO_SOCKET;
+    }
+    return s;
+}
+
+int receive(Socket s, char* buffer, size_t size) {
+    return static_cast<int>(recv(s, buffer, static_cast<int>(size), 0));
+}
+
+bool sendAll(Socket s, const char* data, size_t size) {
+#ifdef _WIN32
+    const int flags = 0;
+#else
+    const int flags = MSG_NOSIGNAL;
+#endif
+    while (size > 0) {
+        int sent = static_cast<int>(send(s, data, static_cast<int>(size), flags));
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void shutdownSend(Socket s) {
+#ifdef _WIN32
+    shutdown(s, SD_SEND);
+#else
+    shutdown(s, SHUT_WR);
+#endif
+}
+
+#ifdef _WIN32
+
+void clearScreen() {
+    std::system("cls");
+}
+
+void setTextColor(int code) {
+    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), static_cast<WORD>(code));
+}
+
+void resetTextColor() {
+    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 7);  // Default light gray/white
+}
+
+void moveCursor(int x, int y) {
+    COORD pos = {static_cast<SHORT>(x), static_cast<SHORT>(y)};
+    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), pos);
+}
+
+int readKey() {
+    return _getch();
+}
+
+#else
+
+namespace {
+
+// Windows color bits are blue=1, green=2, red=4, intense=8; ANSI has red=1, blue=4
+int ansiColor(int windowsColor) {
+    return ((windowsColor & 1) << 2) | (windowsColor & 2) | ((windowsColor & 4) >> 2);
+}
+
+void writeTerminal(const char* text) {
+    std::fputs(text, stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+void clearScreen() {
+    writeTerminal("\x1b[2J\x1b[H");
+}
+
+void setTextColor(int code) {
+    int fg = code & 0xF;
+    int bg = (code >> 4) & 0xF;
+    char seq[32];
+    // Background 0 (black on a Windows console) keeps the terminal's own background
+    int bgCode = bg == 0 ? 49 : (bg & 8 ? 100 : 40) + ansiColor(bg);
+    std::snprintf(seq, sizeof(seq), "\x1b[0;%d;%dm", (fg & 8 ? 90 : 30) + ansiColor(fg), bgCode);
+    writeTerminal(seq);
+}
+
+void resetTextColor() {
+    writeTerminal("\x1b[0m");
+}
+
+void moveCursor(int x, int y) {
+    // ANSI positions are 1-based; gotoxy() keeps the Windows 0-based ones
+    char seq[32];
+    std::snprintf(seq, sizeof(seq), "\x1b[%d;%dH", y + 1, x + 1);
+    writeTerminal(seq);
+}
+
+int readKey() {
+    if (!isatty(STDIN_FILENO)) return std::getchar();
+    termios saved;
+    tcgetattr(STDIN_FILENO, &saved);
+    termios raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    unsigned char c = 0;
+    ssize_t n = read(STDIN_FILENO, &c, 1);
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    return n == 1 ? c : -1;
+}
+
+#endif
+
+} // namespace platform
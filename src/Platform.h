@@ -0,0 +1,58 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+// Operating system differences behind server() and the terminal builtins.
+//
+// Sockets are BSD sockets everywhere; on Windows that means Winsock, which
+// needs WSAStartup and closes with closesocket(). The console uses the
+// Win32 console API on Windows and ANSI escape sequences plus termios
+// elsewhere, with Windows color codes (0-15, background in the high
+// nibble) translated to the ANSI equivalents.
+namespace platform {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+constexpr Socket NO_SOCKET = INVALID_SOCKET;
+#else
+using Socket = int;
+constexpr Socket NO_SOCKET = -1;
+#endif
+
+// WSAStartup/WSACleanup on Windows; nothing elsewhere
+bool startNetwork();
+void stopNetwork();
+
+// TCP socket bound to port on all interfaces and listening; NO_SOCKET on
+// failure, with error naming the step that failed
+Socket listenTcp(int port, const char*& error);
+void closeSocket(Socket s);
+
+// recv(); <= 0 when the peer closed the connection or on error
+int receive(Socket s, char* buffer, size_t size);
+// Sends all of data; false if the peer went away (never raises SIGPIPE)
+bool sendAll(Socket s, const char* data, size_t size);
+// Ends the sending side once queued data is out (a FIN after a reply to a
+// request that is never read, so the reply is not cut off)
+void shutdownSend(Socket s);
+
+void clearScreen();
+void setTextColor(int code);
+void resetTextColor();
+void moveCursor(int x, int y);
+// One key press, without waiting for Enter and without echo
+int readKey();
+
+} // namespace platform
+
+#endif // PLATFORM_H
@@ -0,0 +1,118 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <unordered_map>
+
+bool Profiler::enabled = false;
+
+std::string frameLabel(const CallFrame& frame) {
+    std::string label;
+    if (!frame.owner.empty()) {
+        label += frame.owner;
+        label += '.';
+    }
+    label += frame.name;
+    if (frame.line > 0) label += " (line " + std::to_string(frame.line) + ")";
+    return label;
+}
+
+void Profiler::start(const std::string& path, int frequency) {
+    outPath = path;
+    hz = frequency > 0 ? frequency : DEFAULT_HZ;
+    enabled = true;
+    running = true;
+    sampler = std::thread([this] {
+        auto period = std::chrono::nanoseconds(1000000000LL / hz);
+        auto next = std::chrono::steady_clock::now() + period;
+        while (running.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_until(next);
+            next += period;
+            tick.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    std::atexit([] { Profiler::instance().stop(); });
+}
+
+void Profiler::record(const std::vector<CallFrame>& stack, uint64_t samples) {
+    std::string key;
+    for (size_t i = 0; i < stack.size(); i++) {
+        if (i > 0) key += ';';
+        key += frameLabel(stack[i]);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    folded[key] += samples;
+}
+
+void Profiler::stop() {
+    if (!running.exchange(false)) return;
+    sampler.join();
+    enabled = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    FILE* out = std::fopen(outPath.c_str(), "wb");
+    for (const auto& entry : folded) {
+        total += entry.second;
+        if (out) std::fprintf(out, "%s %llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+    }
+    if (out) {
+        std::fclose(out);
+    } else {
+        std::fprintf(stderr, "profile: could not write '%s'\n", outPath.c_str());
+    }
+    writeSummary(total);
+}
+
+// Self time is charged to the innermost frame of each sample, total time to
+// every distinct frame on the stack. Functions are ranked without line
+// numbers, lines by self time.
+void Profiler::writeSummary(uint64_t total) {
+    std::fprintf(stderr, "\nProfile: %llu samples at %d Hz (wall clock, all threads) -> %s\n",
+                 static_cast<unsigned long long>(total), hz, outPath.c_str());
+    if (total == 0) return;
+
+    struct Counts { uint64_t self = 0; uint64_t total = 0; };
+    std::unordered_map<std::string, Counts> functions;
+    std::unordered_map<std::string, uint64_t> lines;
+
+    for (const auto& entry : folded) {
+        const std::string& stack = entry.first;
+        uint64_t n = entry.second;
+        std::set<std::string> seen;
+        size_t start = 0;
+        while (start <= stack.size()) {
+            size_t end = stack.find(';', start);
+            if (end == std::string::npos) end = stack.size();
+            std::string label = stack.substr(start, end - start);
+            std::string function = label.substr(0, label.find(" (line "));
+            if (seen.insert(function).second) functions[function].total += n;
+            if (end == stack.size()) {
+                functions[function].self += n;
+                lines[label] += n;
+            }
+            start = end + 1;
+        }
+    }
+
+    auto percent = [total](uint64_t n) { return 100.0 * static_cast<double>(n) / static_cast<double>(total); };
+
+    std::vector<std::pair<std::string, Counts>> byFunction(functions.begin(), functions.end());
+    std::sort(byFunction.begin(), byFunction.end(), [](const auto& a, const auto& b) {
+        return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+    });
+    std::fprintf(stderr, "\n   self%%  total%%  function\n");
+    for (size_t i = 0; i < byFunction.size() && i < SUMMARY_ROWS; i++) {
+        std::fprintf(stderr, "  %6.1f  %6.1f  %s\n", percent(byFunction[i].second.self),
+                     percent(byFunction[i].second.total), byFunction[i].first.c_str());
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> byLine(lines.begin(), lines.end());
+    std::sort(byLine.begin(), byLine.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::fprintf(stderr, "\n   self%%  line\n");
+    for (size_t i = 0; i < byLine.size() && i < SUMMARY_ROWS; i++) {
+        std::fprintf(stderr, "  %6.1f  %s\n", percent(byLine[i].second), byLine[i].first.c_str());
+    }
+}
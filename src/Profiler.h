@@ -0,0 +1,82 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// One entry of an interpreter's EZ-level call stack. The bottom frame names
+// the thread ("<main>", "<spawn>", "<server>", "<generator>"); the others
+// are the tasks, lambdas, model methods and builtins being called.
+struct CallFrame {
+    std::string_view name;
+    std::string_view owner;  // model name for methods and init, else empty
+    int line = 0;            // line currently executing in this frame
+};
+
+// Sampling profiler behind `ez --profile`.
+//
+// A sampler thread bumps `tick` at the requested frequency. Interpreters
+// check it at every statement and call boundary (only while enabled) and,
+// when it has moved, record their own call stack once per elapsed tick. No thread ever reads
+// another thread's stack, so the hot path is one relaxed atomic load, and
+// spawned tasks and server() handler threads are covered like the main
+// thread. Samples are wall-clock: a builtin that blocks (sleep, await, I/O)
+// is charged, under the line that called it, for the time it waited once
+// it returns.
+//
+// On stop() the stacks are written in the folded format read by
+// flamegraph.pl / speedscope / inferno, and a top-N summary goes to stderr.
+class Profiler {
+public:
+    static constexpr int DEFAULT_HZ = 1000;
+    static constexpr size_t SUMMARY_ROWS = 15;
+
+    // Set before any script code runs; read without synchronization
+    static bool enabled;
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void start(const std::string& outPath, int hz);
+    // Writes the folded stacks and the summary; safe to call more than once
+    void stop();
+
+    uint64_t currentTick() const { return tick.load(std::memory_order_relaxed); }
+
+    // Called at statement and call boundaries while enabled
+    void poll(const std::vector<CallFrame>& stack, uint64_t& seenTick) {
+        uint64_t now = tick.load(std::memory_order_relaxed);
+        if (now != seenTick) {
+            record(stack, now - seenTick);
+            seenTick = now;
+        }
+    }
+
+private:
+    Profiler() = default;
+
+    std::atomic<uint64_t> tick{0};
+    std::atomic<bool> running{false};
+    std::thread sampler;
+    std::string outPath;
+    int hz = DEFAULT_HZ;
+
+    std::mutex mutex;
+    std::map<std::string, uint64_t> folded;  // "a;b;c" -> samples
+
+    void record(const std::vector<CallFrame>& stack, uint64_t samples);
+    void writeSummary(uint64_t total);
+};
+
+// "owner.name (line N)"
+std::string frameLabel(const CallFrame& frame);
+
+#endif // PROFILER_H
@@ -0,0 +1,946 @@
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// The vector paths rely on GCC/Clang target attributes and builtins
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define EZ_SIMD_X86 1
+#include <immintrin.h>
+#define EZ_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace simd {
+
+namespace {
+
+Level detectLevel() {
+#ifdef EZ_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Level::SSE2;
+#endif
+    return Level::SCALAR;
+}
+
+std::atomic<Level> currentLevel{detectLevel()};
+
+inline bool useAvx2() { return currentLevel.load(std::memory_order_relaxed) == Level::AVX2; }
+inline bool useSse2() { return currentLevel.load(std::memory_order_relaxed) != Level::SCALAR; }
+
+// ---------------- scalar ----------------
+
+template<typename T>
+T sumScalar(const T* data, size_t n) {
+    T total = 0;
+    for (size_t i = 0; i < n; i++) total += data[i];
+    return total;
+}
+
+template<typename T>
+void minMaxScalar(const T* data, size_t n, T& mn, T& mx) {
+    mn = mx = data[0];
+    for (size_t i = 1; i < n; i++) {
+        if (data[i] < mn) mn = data[i];
+        if (data[i] > mx) mx = data[i];
+    }
+}
+
+template<typename T>
+T dotScalar(const T* a, const T* b, size_t n) {
+    T total = 0;
+    for (size_t i = 0; i < n; i++) total += a[i] * b[i];
+    return total;
+}
+
+template<typename T>
+void prefixSumScalar(const T* in, T* out, size_t n, T carry = 0) {
+    for (size_t i = 0; i < n; i++) {
+        carry += in[i];
+        out[i] = carry;
+    }
+}
+
+// ---------------- checked int64 ----------------
+
+// a + b wrapped to 64 bits; true if the exact result is out of range
+inline bool addWraps(int64_t a, int64_t b, int64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, &out);
+#else
+    out = static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    return (b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b);
+#endif
+}
+
+// a * b; false if the exact result is out of range
+inline bool mulChecked(int64_t a, int64_t b, int64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, &out);
+#else
+    if (a > 0 ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+              : (b > 0 ? a < INT64_MIN / b : a != 0 && b < INT64_MAX / a)) {
+        return false;
+    }
+    out = a * b;
+    return true;
+#endif
+}
+
+// Largest |x| in data, as unsigned so that |INT64_MIN| fits
+uint64_t maxMagnitude(const int64_t* data, size_t n) {
+    if (n == 0) return 0;
+    int64_t mn, mx;
+    minMax(data, n, mn, mx);
+    uint64_t up = mx > 0 ? static_cast<uint64_t>(mx) : 0;
+    uint64_t down = mn < 0 ? 0 - static_cast<uint64_t>(mn) : 0;
+    return std::max(up, down);
+}
+
+// True when no running total of n terms, each at most bound in magnitude,
+// can leave the int64 range
+inline bool sumFits(uint64_t bound, size_t n) {
+    return n == 0 || bound <= static_cast<uint64_t>(INT64_MAX) / n;
+}
+
+#ifdef EZ_SIMD_X86
+
+// ---------------- SSE2 ----------------
+
+double sumSse2(const double* data, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + sumScalar(data + i, n - i);
+}
+
+int64_t sumSse2(const int64_t* data, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + sumScalar(data + i, n - i);
+}
+
+void minMaxSse2(const double* data, size_t n, double& mn, double& mx) {
+    if (n < 2) { minMaxScalar(data, n, mn, mx); return; }
+    __m128d vmin = _mm_loadu_pd(data), vmax = vmin;
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(data + i);
+        vmin = _mm_min_pd(vmin, v);
+        vmax = _mm_max_pd(vmax, v);
+    }
+    double lo[2], hi[2];
+    _mm_storeu_pd(lo, vmin);
+    _mm_storeu_pd(hi, vmax);
+    mn = std::min(lo[0], lo[1]);
+    mx = std::max(hi[0], hi[1]);
+    for (; i < n; i++) {
+        mn = std::min(mn, data[i]);
+        mx = std::max(mx, data[i]);
+    }
+}
+
+double dotSse2(const double* a, const double* b, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + dotScalar(a + i, b + i, n - i);
+}
+
+void scaleSse2(const double* in, double factor, double* out, size_t n) {
+    __m128d k = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(in + i), k));
+    for (; i < n; i++) out[i] = in[i] * factor;
+}
+
+void addSse2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+void addSse2(const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi64(va, vb));
+    }
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+// ---------------- AVX2 ----------------
+
+EZ_AVX2 double sumAvx2(const double* data, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+        acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(data + i + 8));
+        acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(data + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumScalar(data + i, n - i);
+}
+
+EZ_AVX2 int64_t sumAvx2(const int64_t* data, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 4)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(data + i, n - i);
+}
+
+EZ_AVX2 void minMaxAvx2(const double* data, size_t n, double& mn, double& mx) {
+    if (n < 4) { minMaxScalar(data, n, mn, mx); return; }
+    __m256d vmin = _mm256_loadu_pd(data), vmax = vmin;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(data + i);
+        vmin = _mm256_min_pd(vmin, v);
+        vmax = _mm256_max_pd(vmax, v);
+    }
+    double lo[4], hi[4];
+    _mm256_storeu_pd(lo, vmin);
+    _mm256_storeu_pd(hi, vmax);
+    mn = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    mx = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+    for (; i < n; i++) {
+        mn = std::min(mn, data[i]);
+        mx = std::max(mx, data[i]);
+    }
+}
+
+EZ_AVX2 void minMaxAvx2(const int64_t* data, size_t n, int64_t& mn, int64_t& mx) {
+    if (n < 4) { minMaxScalar(data, n, mn, mx); return; }
+    __m256i vmin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), vmax = vmin;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        vmin = _mm256_blendv_epi8(vmin, v, _mm256_cmpgt_epi64(vmin, v));
+        vmax = _mm256_blendv_epi8(vmax, v, _mm256_cmpgt_epi64(v, vmax));
+    }
+    int64_t lo[4], hi[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), vmin);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi), vmax);
+    mn = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    mx = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+    for (; i < n; i++) {
+        mn = std::min(mn, data[i]);
+        mx = std::max(mx, data[i]);
+    }
+}
+
+EZ_AVX2 double dotAvx2(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, n - i);
+}
+
+EZ_AVX2 void scaleAvx2(const double* in, double factor, double* out, size_t n) {
+    __m256d k = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(in + i), k));
+    for (; i < n; i++) out[i] = in[i] * factor;
+}
+
+EZ_AVX2 void addAvx2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+EZ_AVX2 void addAvx2(const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(va, vb));
+    }
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+// In-register scan of 4 lanes: shift by one lane and add, then by two.
+EZ_AVX2 void prefixSumAvx2(const double* in, double* out, size_t n) {
+    __m256d zero = _mm256_setzero_pd();
+    __m256d carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(in + i);
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+        v = _mm256_add_pd(v, carry);
+        _mm256_storeu_pd(out + i, v);
+        carry = _mm256_permute4x64_pd(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    double last = i > 0 ? out[i - 1] : 0.0;
+    prefixSumScalar(in + i, out + i, n - i, last);
+}
+
+EZ_AVX2 void prefixSumAvx2(const int64_t* in, int64_t* out, size_t n) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        v = _mm256_add_epi64(v, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    int64_t last = i > 0 ? out[i - 1] : 0;
+    prefixSumScalar(in + i, out + i, n - i, last);
+}
+
+// Bucket indices are computed four at a time; the increments themselves
+// go to four interleaved sub-histograms so neighbouring equal values do
+// not serialize on one counter.
+EZ_AVX2 void histogramAvx2(const double* data, size_t n, double lo, double hi, size_t bins, int64_t* counts) {
+    std::vector<int64_t> sub(bins * 4, 0);
+    double width = (hi - lo) / static_cast<double>(bins);
+    __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    __m256d vinv = _mm256_set1_pd(1.0 / width);
+    __m256d vlast = _mm256_set1_pd(static_cast<double>(bins - 1));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(data + i);
+        __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ), _mm256_cmp_pd(v, vhi, _CMP_LE_OQ));
+        int mask = _mm256_movemask_pd(inRange);
+        if (!mask) continue;
+        __m256d idx = _mm256_min_pd(_mm256_floor_pd(_mm256_mul_pd(_mm256_sub_pd(v, vlo), vinv)), vlast);
+        int32_t bucket[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bucket), _mm256_cvttpd_epi32(idx));
+        for (int lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) sub[bucket[lane] * 4 + lane]++;
+        }
+    }
+    for (size_t b = 0; b < bins; b++) {
+        counts[b] += sub[b * 4] + sub[b * 4 + 1] + sub[b * 4 + 2] + sub[b * 4 + 3];
+    }
+    for (; i < n; i++) {
+        double v = data[i];
+        if (!(v >= lo && v <= hi)) continue;
+        size_t b = static_cast<size_t>((v - lo) / width);
+        counts[b < bins ? b : bins - 1]++;
+    }
+}
+
+#endif // EZ_SIMD_X86
+
+} // namespace
+
+Level level() { return currentLevel.load(std::memory_order_relaxed); }
+
+const char* levelName() {
+    switch (level()) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void setLevel(Level lvl) {
+    if (static_cast<int>(lvl) <= static_cast<int>(detectLevel())) {
+        currentLevel.store(lvl, std::memory_order_relaxed);
+    }
+}
+
+#ifdef EZ_SIMD_X86
+#define DISPATCH(avx2Call, sse2Call, scalarCall) \
+    if (useAvx2()) return avx2Call; \
+    if (useSse2()) return sse2Call; \
+    return scalarCall
+#else
+#define DISPATCH(avx2Call, sse2Call, scalarCall) return scalarCall
+#endif
+
+double sum(const double* data, size_t n) {
+    DISPATCH(sumAvx2(data, n), sumSse2(data, n), sumScalar(data, n));
+}
+
+namespace {
+
+int64_t sumFast(const int64_t* data, size_t n) {
+    DISPATCH(sumAvx2(data, n), sumSse2(data, n), sumScalar(data, n));
+}
+
+} // namespace
+
+bool sum(const int64_t* data, size_t n, int64_t& out) {
+    if (sumFits(maxMagnitude(data, n), n)) {
+        out = sumFast(data, n);
+        return true;
+    }
+    // A running total may leave the range and come back; count the wraps
+    // so only a total that ends up outside it fails
+    int64_t total = 0, wraps = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (addWraps(total, data[i], total)) wraps += data[i] > 0 ? 1 : -1;
+    }
+    out = total;
+    return wraps == 0;
+}
+
+void minMax(const double* data, size_t n, double& minOut, double& maxOut) {
+    DISPATCH(minMaxAvx2(data, n, minOut, maxOut), minMaxSse2(data, n, minOut, maxOut),
+             minMaxScalar(data, n, minOut, maxOut));
+}
+
+void minMax(const int64_t* data, size_t n, int64_t& minOut, int64_t& maxOut) {
+    // SSE2 has no 64-bit compare, so only AVX2 gets a vector path
+    DISPATCH(minMaxAvx2(data, n, minOut, maxOut), minMaxScalar(data, n, minOut, maxOut),
+             minMaxScalar(data, n, minOut, maxOut));
+}
+
+double dot(const double* a, const double* b, size_t n) {
+    DISPATCH(dotAvx2(a, b, n), dotSse2(a, b, n), dotScalar(a, b, n));
+}
+
+bool dot(const int64_t* a, const int64_t* b, size_t n, int64_t& out) {
+    // No 64-bit multiply below AVX-512, so the scalar loop is as good as it
+    // gets, and checking each step costs little on top
+    int64_t total = 0, wraps = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t product;
+        if (!mulChecked(a[i], b[i], product)) return false;
+        if (addWraps(total, product, total)) wraps += product > 0 ? 1 : -1;
+    }
+    out = total;
+    return wraps == 0;
+}
+
+void scale(const double* in, double factor, double* out, size_t n) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { scaleAvx2(in, factor, out, n); return; }
+    if (useSse2()) { scaleSse2(in, factor, out, n); return; }
+#endif
+    for (size_t i = 0; i < n; i++) out[i] = in[i] * factor;
+}
+
+bool scale(const int64_t* in, int64_t factor, int64_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (!mulChecked(in[i], factor, out[i])) return false;
+    }
+    return true;
+}
+
+void add(const double* a, const double* b, double* out, size_t n) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { addAvx2(a, b, out, n); return; }
+    if (useSse2()) { addSse2(a, b, out, n); return; }
+#endif
+    for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+
+bool add(const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+    // Each magnitude is at most 2^63, so the bound itself cannot wrap
+    if (maxMagnitude(a, n) + maxMagnitude(b, n) <= static_cast<uint64_t>(INT64_MAX)) {
+#ifdef EZ_SIMD_X86
+        if (useAvx2()) { addAvx2(a, b, out, n); return true; }
+        if (useSse2()) { addSse2(a, b, out, n); return true; }
+#endif
+        for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (addWraps(a[i], b[i], out[i])) return false;
+    }
+    return true;
+}
+
+void prefixSum(const double* in, double* out, size_t n) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { prefixSumAvx2(in, out, n); return; }
+#endif
+    prefixSumScalar(in, out, n);
+}
+
+bool prefixSum(const int64_t* in, int64_t* out, size_t n) {
+    if (sumFits(maxMagnitude(in, n), n)) {
+#ifdef EZ_SIMD_X86
+        if (useAvx2()) { prefixSumAvx2(in, out, n); return true; }
+#endif
+        prefixSumScalar(in, out, n);
+        return true;
+    }
+    // Every running total is an output, so each one must be in range
+    int64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (addWraps(carry, in[i], carry)) return false;
+        out[i] = carry;
+    }
+    return true;
+}
+
+void histogram(const double* data, size_t n, double lo, double hi, size_t bins, int64_t* counts) {
+    if (bins == 0 || !(hi > lo)) return;
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { histogramAvx2(data, n, lo, hi, bins, counts); return; }
+#endif
+    double width = (hi - lo) / static_cast<double>(bins);
+    for (size_t i = 0; i < n; i++) {
+        double v = data[i];
+        if (!(v >= lo && v <= hi)) continue;
+        size_t b = static_cast<size_t>((v - lo) / width);
+        counts[b < bins ? b : bins - 1]++;
+    }
+}
+
+// ---------------- String kernels ----------------
+//
+// Substring search compares the first and last byte of the needle at 16/32
+// candidate positions per step and only runs memcmp where both match, which
+// skips most of the haystack for real text. (The SSE4.2 string instructions
+// are slower than this on current CPUs, so the 16-byte path is plain SSE2.)
+
+namespace {
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+size_t findScalar(const char* hay, size_t n, const char* needle, size_t m, size_t from) {
+    size_t pos = std::string_view(hay, n).find(std::string_view(needle, m), from);
+    return pos == std::string_view::npos ? NPOS : pos;
+}
+
+void splitByteScalar(const char* s, size_t n, char delim, size_t from, std::vector<size_t>& positions) {
+    const char* p = s + from;
+    const char* end = s + n;
+    while (p < end) {
+        const char* hit = static_cast<const char*>(std::memchr(p, delim, end - p));
+        if (!hit) break;
+        positions.push_back(hit - s);
+        p = hit + 1;
+    }
+}
+
+void mapCaseScalar(const char* in, char* out, size_t n, char lo, char hi) {
+    for (size_t i = 0; i < n; i++) {
+        char c = in[i];
+        out[i] = (c >= lo && c <= hi) ? static_cast<char>(c ^ 0x20) : c;
+    }
+}
+
+#ifdef EZ_SIMD_X86
+
+inline int lowestBit(uint32_t mask) { return __builtin_ctz(mask); }
+
+size_t findSse2(const char* hay, size_t n, const char* needle, size_t m, size_t from) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = from;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask) {
+            size_t pos = i + lowestBit(mask);
+            if (m <= 2 || std::memcmp(hay + pos + 1, needle + 1, m - 2) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return findScalar(hay, n, needle, m, i);
+}
+
+EZ_AVX2 size_t findAvx2(const char* hay, size_t n, const char* needle, size_t m, size_t from) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = from;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + m - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask) {
+            size_t pos = i + lowestBit(mask);
+            if (m <= 2 || std::memcmp(hay + pos + 1, needle + 1, m - 2) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return findScalar(hay, n, needle, m, i);
+}
+
+void splitByteSse2(const char* s, size_t n, char delim, std::vector<size_t>& positions) {
+    const __m128i d = _mm_set1_epi8(delim);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), d)));
+        while (mask) {
+            positions.push_back(i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    splitByteScalar(s, n, delim, i, positions);
+}
+
+EZ_AVX2 void splitByteAvx2(const char* s, size_t n, char delim, std::vector<size_t>& positions) {
+    const __m256i d = _mm256_set1_epi8(delim);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)), d)));
+        while (mask) {
+            positions.push_back(i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    splitByteScalar(s, n, delim, i, positions);
+}
+
+// Flips bit 0x20 of every byte in [lo, hi]. The range test shifts the bytes
+// so that lo maps to -128 and uses one signed compare.
+void mapCaseSse2(const char* in, char* out, size_t n, char lo, char hi) {
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(-128 - lo));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i inRange = _mm_cmplt_epi8(_mm_add_epi8(v, shift), limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v, _mm_and_si128(inRange, flip)));
+    }
+    mapCaseScalar(in + i, out + i, n - i, lo, hi);
+}
+
+EZ_AVX2 void mapCaseAvx2(const char* in, char* out, size_t n, char lo, char hi) {
+    const __m256i shift = _mm256_set1_epi8(static_cast<char>(-128 - lo));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i inRange = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(v, shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, _mm256_and_si256(inRange, flip)));
+    }
+    mapCaseScalar(in + i, out + i, n - i, lo, hi);
+}
+
+// Bitmask of the non-whitespace bytes among the 32 at p
+EZ_AVX2 inline uint32_t nonSpaceMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i space = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(space));
+}
+
+EZ_AVX2 void trimAvx2(const char* s, size_t n, size_t& begin, size_t& end) {
+    begin = 0;
+    while (begin + 32 <= n) {
+        uint32_t mask = nonSpaceMask(s + begin);
+        if (mask) { begin += lowestBit(mask); break; }
+        begin += 32;
+    }
+    while (begin < n && isSpace(s[begin])) begin++;
+
+    end = n;
+    while (end >= begin + 32) {
+        uint32_t mask = nonSpaceMask(s + end - 32);
+        if (mask) { end -= __builtin_clz(mask); break; }
+        end -= 32;
+    }
+    while (end > begin && isSpace(s[end - 1])) end--;
+}
+
+#endif // EZ_SIMD_X86
+
+} // namespace
+
+size_t find(const char* hay, size_t n, const char* needle, size_t m, size_t from) {
+    if (from > n || m > n - from) return NPOS;
+    if (m == 0) return from;
+    if (m == 1) {
+        const void* hit = std::memchr(hay + from, needle[0], n - from);
+        return hit ? static_cast<const char*>(hit) - hay : NPOS;
+    }
+    DISPATCH(findAvx2(hay, n, needle, m, from), findSse2(hay, n, needle, m, from),
+             findScalar(hay, n, needle, m, from));
+}
+
+void splitByte(const char* s, size_t n, char delim, std::vector<size_t>& positions) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { splitByteAvx2(s, n, delim, positions); return; }
+    if (useSse2()) { splitByteSse2(s, n, delim, positions); return; }
+#endif
+    splitByteScalar(s, n, delim, 0, positions);
+}
+
+void toUpperAscii(const char* in, char* out, size_t n) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { mapCaseAvx2(in, out, n, 'a', 'z'); return; }
+    if (useSse2()) { mapCaseSse2(in, out, n, 'a', 'z'); return; }
+#endif
+    mapCaseScalar(in, out, n, 'a', 'z');
+}
+
+void toLowerAscii(const char* in, char* out, size_t n) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { mapCaseAvx2(in, out, n, 'A', 'Z'); return; }
+    if (useSse2()) { mapCaseSse2(in, out, n, 'A', 'Z'); return; }
+#endif
+    mapCaseScalar(in, out, n, 'A', 'Z');
+}
+
+void trimBounds(const char* s, size_t n, size_t& begin, size_t& end) {
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) { trimAvx2(s, n, begin, end); return; }
+#endif
+    begin = 0;
+    while (begin < n && isSpace(s[begin])) begin++;
+    end = n;
+    while (end > begin && isSpace(s[end - 1])) end--;
+}
+
+std::string replaceAll(const char* s, size_t n, const char* from, size_t fromLen, const char* to, size_t toLen) {
+    if (fromLen == 0) return std::string(s, n);
+
+    // Find every match first so the result is allocated exactly once
+    std::vector<size_t> matches;
+    for (size_t pos = find(s, n, from, fromLen, 0); pos != NPOS; pos = find(s, n, from, fromLen, pos + fromLen)) {
+        matches.push_back(pos);
+    }
+    if (matches.empty()) return std::string(s, n);
+
+    std::string out;
+    out.resize(n - matches.size() * fromLen + matches.size() * toLen);
+    char* dst = &out[0];
+    size_t prev = 0;
+    for (size_t pos : matches) {
+        std::memcpy(dst, s + prev, pos - prev);
+        dst += pos - prev;
+        std::memcpy(dst, to, toLen);
+        dst += toLen;
+        prev = pos + fromLen;
+    }
+    std::memcpy(dst, s + prev, n - prev);
+    return out;
+}
+
+// ---------------- JSON structural index ----------------
+//
+// The text is processed in 64-byte blocks. Each block is reduced to four
+// bitmasks (backslashes, quotes, structural characters, whitespace) - that
+// part is vectorized - and the rest is plain 64-bit arithmetic, carrying a
+// little state from block to block:
+//
+//   escaped    bytes preceded by an odd run of backslashes
+//   in-string  prefix-XOR of the unescaped quotes: 1 from an opening quote
+//              up to, not including, its closing quote
+//   structural {}[]:, plus the start of each scalar, minus anything inside
+//              a string (the opening quote counts as a scalar start)
+
+namespace {
+
+struct JsonMasks {
+    uint64_t backslash = 0;
+    uint64_t quote = 0;
+    uint64_t op = 0;
+    uint64_t space = 0;
+};
+
+void jsonMasksScalar(const char* p, JsonMasks& m) {
+    m = JsonMasks();
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = uint64_t(1) << i;
+        switch (p[i]) {
+            case '\\': m.backslash |= bit; break;
+            case '"': m.quote |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': m.space |= bit; break;
+            default: break;
+        }
+    }
+}
+
+#ifdef EZ_SIMD_X86
+
+void jsonMasksSse2(const char* p, JsonMasks& m) {
+    m = JsonMasks();
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        auto eq = [&](char c) {
+            return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+        };
+        auto bits = [](__m128i x) {
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(x)));
+        };
+        int shift = 16 * k;
+        m.backslash |= bits(eq('\\')) << shift;
+        m.quote |= bits(eq('"')) << shift;
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']'))),
+                                  _mm_or_si128(eq(':'), eq(',')));
+        m.op |= bits(op) << shift;
+        __m128i space = _mm_or_si128(_mm_or_si128(eq(' '), eq('\t')), _mm_or_si128(eq('\n'), eq('\r')));
+        m.space |= bits(space) << shift;
+    }
+}
+
+EZ_AVX2 void jsonMasksAvx2(const char* p, JsonMasks& m) {
+    m = JsonMasks();
+    for (int k = 0; k < 2; k++) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+        __m256i bs = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+        __m256i qt = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}'))),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        __m256i sp = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        int shift = 32 * k;
+        m.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(bs))) << shift;
+        m.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(qt))) << shift;
+        m.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+        m.space |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(sp))) << shift;
+    }
+}
+
+#endif // EZ_SIMD_X86
+
+inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+inline int countBits(uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+inline int lowestBit64(uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+class JsonScanner {
+public:
+    uint64_t structurals(const JsonMasks& m) {
+        // Backslashes that escape the next byte: the odd-numbered ones in
+        // each run (subtracting the run from the odd bits flips exactly the
+        // bits after an odd-length run)
+        const uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAULL;
+        uint64_t escaped;
+        uint64_t backslash = m.backslash & ~nextIsEscaped;
+        if (!backslash) {
+            escaped = nextIsEscaped;
+            nextIsEscaped = 0;
+        } else {
+            uint64_t maybeEscaped = backslash << 1;
+            uint64_t codes = ((maybeEscaped | ODD_BITS) - backslash) ^ ODD_BITS;
+            escaped = codes ^ (backslash | nextIsEscaped);
+            uint64_t escape = codes & backslash;
+            nextIsEscaped = escape >> 63;
+        }
+
+        uint64_t quote = m.quote & ~escaped;
+        uint64_t inString = prefixXor(quote) ^ prevInString;
+        prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+        uint64_t stringTail = inString ^ quote;  // string bodies and closing quotes
+
+        uint64_t scalar = ~(m.op | m.space);
+        uint64_t nonQuoteScalar = scalar & ~quote;
+        uint64_t followsScalar = (nonQuoteScalar << 1) | prevScalar;
+        prevScalar = nonQuoteScalar >> 63;
+        uint64_t scalarStart = scalar & ~followsScalar;
+        return (m.op | scalarStart) & ~stringTail;
+    }
+
+    bool insideString() const { return prevInString != 0; }
+
+private:
+    uint64_t nextIsEscaped = 0;
+    uint64_t prevInString = 0;
+    uint64_t prevScalar = 0;
+};
+
+} // namespace
+
+bool jsonStructurals(const char* s, size_t n, std::vector<uint32_t>& out) {
+    void (*masks)(const char*, JsonMasks&) = jsonMasksScalar;
+#ifdef EZ_SIMD_X86
+    if (useAvx2()) masks = jsonMasksAvx2;
+    else if (useSse2()) masks = jsonMasksSse2;
+#endif
+
+    JsonScanner scanner;
+    JsonMasks m;
+    // Rough guess (about one structural per 6 bytes) to avoid regrowing
+    out.reserve(out.size() + n / 6 + 16);
+
+    auto emit = [&](uint64_t bits, size_t base) {
+        size_t at = out.size();
+        out.resize(at + countBits(bits));
+        for (; bits; bits &= bits - 1) out[at++] = static_cast<uint32_t>(base + lowestBit64(bits));
+    };
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        masks(s + i, m);
+        emit(scanner.structurals(m), i);
+    }
+    if (i < n) {
+        // Pad the tail with spaces, which are never structural
+        char block[64];
+        std::memset(block, ' ', sizeof(block));
+        std::memcpy(block, s + i, n - i);
+        masks(block, m);
+        emit(scanner.structurals(m), i);
+    }
+    return !scanner.insideString();
+}
+
+} // namespace simd
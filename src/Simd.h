@@ -0,0 +1,87 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Vectorized kernels with runtime CPU dispatch.
+//
+// Every kernel has a portable scalar version; on x86 an SSE2 or AVX2 version
+// is picked once at startup based on what the CPU supports. Floating-point
+// reductions add in a different order than a plain loop, so sums can differ
+// from the scalar result in the last bits.
+namespace simd {
+
+enum class Level { SCALAR, SSE2, AVX2 };
+
+// Best instruction set available on this CPU (detected once)
+Level level();
+const char* levelName();
+
+// Force a lower level, e.g. to compare against the scalar path
+void setLevel(Level lvl);
+
+// ---- Numeric kernels (typed arrays) ----
+
+// The int64 versions return false when a result leaves the 64-bit range
+// (for dot, also when a single product does); out is then unspecified.
+// Inputs whose magnitudes cannot overflow take the vector paths; the rest
+// go through a checked scalar loop.
+
+double sum(const double* data, size_t n);
+bool sum(const int64_t* data, size_t n, int64_t& out);
+
+// n must be > 0
+void minMax(const double* data, size_t n, double& minOut, double& maxOut);
+void minMax(const int64_t* data, size_t n, int64_t& minOut, int64_t& maxOut);
+
+double dot(const double* a, const double* b, size_t n);
+bool dot(const int64_t* a, const int64_t* b, size_t n, int64_t& out);
+
+void scale(const double* in, double factor, double* out, size_t n);
+bool scale(const int64_t* in, int64_t factor, int64_t* out, size_t n);
+
+void add(const double* a, const double* b, double* out, size_t n);
+bool add(const int64_t* a, const int64_t* b, int64_t* out, size_t n);
+
+// out[i] = in[0] + ... + in[i]; in and out may alias
+void prefixSum(const double* in, double* out, size_t n);
+bool prefixSum(const int64_t* in, int64_t* out, size_t n);
+
+// Counts values into `bins` equal-width buckets over [lo, hi]; values outside
+// the range are ignored, hi itself lands in the last bucket.
+void histogram(const double* data, size_t n, double lo, double hi, size_t bins, int64_t* counts);
+
+// ---- String kernels ----
+
+constexpr size_t NPOS = static_cast<size_t>(-1);
+
+// Position of needle in hay at or after `from`, or NPOS
+size_t find(const char* hay, size_t n, const char* needle, size_t m, size_t from = 0);
+
+// Appends the position of every `delim` byte in s to positions
+void splitByte(const char* s, size_t n, char delim, std::vector<size_t>& positions);
+
+// ASCII-only case mapping; other bytes (including UTF-8) pass through. in and out may alias
+void toUpperAscii(const char* in, char* out, size_t n);
+void toLowerAscii(const char* in, char* out, size_t n);
+
+// [begin, end) of s without leading/trailing spaces, tabs, CR and LF
+void trimBounds(const char* s, size_t n, size_t& begin, size_t& end);
+
+// s with every non-overlapping occurrence of `from` replaced by `to`
+std::string replaceAll(const char* s, size_t n, const char* from, size_t fromLen, const char* to, size_t toLen);
+
+// ---- JSON ----
+
+// Stage 1 of the JSON document index: appends the offset of every
+// structural character ({ } [ ] : ,) outside strings, of every string's
+// opening quote and of the first byte of every other scalar. Returns false
+// if the text ends inside a string. n must fit in 32 bits.
+bool jsonStructurals(const char* s, size_t n, std::vector<uint32_t>& out);
+
+} // namespace simd
+
+#endif // SIMD_H
@@ -24,6 +24,7 @@ enum class TokenType {
     USE,
     TASK,
     GIVE,
+    YIELD,
     ESCAPE,
     SKIP,
     GET,
@@ -118,6 +119,7 @@ inline std::string tokenTypeToString(TokenType type) {
         case TokenType::WHILE: return "WHILE";
         case TokenType::TASK: return "TASK";
         case TokenType::GIVE: return "GIVE";
+        case TokenType::YIELD: return "YIELD";
         case TokenType::ESCAPE: return "ESCAPE";
         case TokenType::SKIP: return "SKIP";
         case TokenType::GET: return "GET";
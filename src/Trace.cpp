@@ -0,0 +1,156 @@
+#include "Trace.h"
+#include <cstdio>
+#include <cstdlib>
+
+bool Trace::enabled = false;
+
+namespace {
+
+void appendEscaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    for (char ch : s) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        } else {
+            out += ch;
+        }
+    }
+}
+
+} // namespace
+
+Trace::ThreadBuffer& Trace::threadBuffer() {
+    struct Lease {
+        ThreadBuffer* buffer = instance().acquireBuffer();
+        ~Lease() { instance().releaseBuffer(buffer); }
+    };
+    thread_local Lease lease;
+    return *lease.buffer;
+}
+
+Trace::ThreadBuffer* Trace::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (ThreadBuffer* b : buffers) {
+        if (!b->inUse) {
+            b->inUse = true;
+            return b;
+        }
+    }
+    auto* b = new ThreadBuffer();
+    b->head = b->tail = new Chunk();
+    b->tid = static_cast<uint32_t>(buffers.size() + 1);
+    buffers.push_back(b);
+    return b;
+}
+
+void Trace::releaseBuffer(ThreadBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer->inUse = false;
+}
+
+void Trace::append(Event&& event) {
+    ThreadBuffer& buffer = threadBuffer();
+    Chunk* chunk = buffer.tail;
+    size_t n = chunk->count.load(std::memory_order_relaxed);
+    if (n == Chunk::SIZE) {
+        Chunk* fresh = new Chunk();
+        chunk->next.store(fresh, std::memory_order_release);
+        buffer.tail = chunk = fresh;
+        n = 0;
+    }
+    chunk->events[n] = std::move(event);
+    chunk->count.store(n + 1, std::memory_order_release);
+}
+
+void Trace::start(const std::string& path) {
+    outPath = path;
+    origin = Clock::now();
+    enabled = true;
+    started = true;
+    nameThread("<main>");
+    std::atexit([] { Trace::instance().stop(); });
+}
+
+void Trace::nameThread(std::string_view name) {
+    if (!enabled) return;
+    // A reused buffer keeps its track; only a new label needs an event
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.name == name) return;
+    buffer.name = std::string(name);
+    Event event;
+    event.name = std::string(name);
+    append(std::move(event));
+}
+
+void Trace::record(const char* category, std::string_view name, std::string_view detail, Clock::time_point start) {
+    Event event;
+    event.category = category;
+    event.name = std::string(name);
+    event.detail = std::string(detail);
+    event.start = start;
+    event.duration = Clock::now() - start;
+    append(std::move(event));
+}
+
+void Trace::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!started) return;
+    started = false;
+    enabled = false;
+
+    FILE* out = std::fopen(outPath.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "trace: could not write '%s'\n", outPath.c_str());
+        return;
+    }
+    auto micros = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+    std::string text = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    size_t events = 0;
+    for (const ThreadBuffer* buffer : buffers) {
+        for (Chunk* chunk = buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            size_t n = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; i++) {
+                const Event& e = chunk->events[i];
+                if (!first) text += ",\n";
+                first = false;
+                char head[160];
+                if (!e.category) {
+                    std::snprintf(head, sizeof(head), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"",
+                                  buffer->tid);
+                    text += head;
+                    appendEscaped(text, e.name);
+                    text += "\"}}";
+                    continue;
+                }
+                std::snprintf(head, sizeof(head), "{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"cat\":\"%s\",\"name\":\"",
+                              buffer->tid, micros(e.start - origin), micros(e.duration), e.category);
+                text += head;
+                appendEscaped(text, e.name);
+                text += '"';
+                if (!e.detail.empty()) {
+                    text += ",\"args\":{\"detail\":\"";
+                    appendEscaped(text, e.detail);
+                    text += "\"}";
+                }
+                text += '}';
+                events++;
+            }
+            if (text.size() > (1 << 20)) {
+                std::fwrite(text.data(), 1, text.size(), out);
+                text.clear();
+            }
+        }
+    }
+    text += "\n]}\n";
+    std::fwrite(text.data(), 1, text.size(), out);
+    std::fclose(out);
+    std::fprintf(stderr, "\nTrace: %zu spans on %zu tracks -> %s\n", events, buffers.size(), outPath.c_str());
+}
@@ -0,0 +1,113 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Timeline recorder behind `ez --trace=out.json`.
+//
+// Spans (server requests, spawned tasks, await, database calls, HTTP
+// requests, module loads, waits for a contended Environment lock) are
+// appended to a per-thread buffer: a list of fixed-size chunks
+// that only the owning thread writes and that publishes each event with a
+// release store, so recording takes no lock. stop() writes everything in
+// the Chrome trace-event format, which chrome://tracing, Perfetto
+// (ui.perfetto.dev) and speedscope open as one track per buffer.
+//
+// A thread hands its buffer back when it exits and the next new thread
+// appends to it, so a server that runs each connection on its own thread
+// keeps one buffer per concurrent connection, not one per connection.
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Set before any script code runs; read without synchronization
+    static bool enabled;
+
+    static Trace& instance() {
+        static Trace trace;
+        return trace;
+    }
+
+    void start(const std::string& outPath);
+    // Writes the JSON file; runs once
+    void stop();
+
+    // Labels the calling thread's track ("<main>", "<server>", ...)
+    void nameThread(std::string_view name);
+
+    // Records [start, now) on the calling thread
+    void record(const char* category, std::string_view name, std::string_view detail, Clock::time_point start);
+
+private:
+    Trace() = default;
+
+    struct Event {
+        const char* category = nullptr;  // nullptr: thread name (metadata)
+        std::string name;
+        std::string detail;
+        Clock::time_point start;
+        Clock::duration duration{0};
+    };
+
+    struct Chunk {
+        static constexpr size_t SIZE = 256;
+        Event events[SIZE];
+        std::atomic<size_t> count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    struct ThreadBuffer {
+        uint32_t tid = 0;
+        Chunk* head = nullptr;
+        Chunk* tail = nullptr;  // owning thread only
+        std::string name;       // owning thread only: the last thread_name
+        bool inUse = true;      // guarded by Trace::mutex
+    };
+
+    static ThreadBuffer& threadBuffer();
+    // A free buffer, or a new one; never freed, as stop() reads them all
+    ThreadBuffer* acquireBuffer();
+    void releaseBuffer(ThreadBuffer* buffer);
+    void append(Event&& event);
+
+    std::mutex mutex;  // guards buffers (acquire, release) and the stop() handoff
+    std::vector<ThreadBuffer*> buffers;
+    std::string outPath;
+    Clock::time_point origin;
+    bool started = false;
+};
+
+// Records the enclosing scope as one span when tracing is enabled;
+// otherwise it costs one branch and copies nothing
+class TraceSpan {
+public:
+    TraceSpan(const char* category, std::string_view name, std::string_view detail = {}) {
+        if (Trace::enabled) {
+            active = true;
+            this->category = category;
+            this->name = name;
+            this->detail = detail;
+            start = Trace::Clock::now();
+        }
+    }
+    ~TraceSpan() {
+        if (active) Trace::instance().record(category, name, detail, start);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    bool active = false;
+    const char* category = nullptr;
+    std::string name;
+    std::string detail;
+    Trace::Clock::time_point start;
+};
+
+#endif // TRACE_H
@@ -1,6 +1,7 @@
 #ifndef VALUE_H
 #define VALUE_H
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
@@ -9,6 +10,10 @@
 #include <unordered_map>
 #include <future>
 #include "AST.h"
+#include "OrderedMap.h"
+#include "FileHandle.h"
+#include "EZString.h"
+#include "Numbers.h"
 
 // Forward declarations
 class Environment;
@@ -23,6 +28,11 @@ struct NativeFunction;
 struct EZClass;
 struct EZInstance;
 struct EZDictionary;
+struct EZStringBuilder;
+struct EZTypedArray;
+struct EZRange;
+class EZIterator;
+namespace json { class Document; }
 
 using NativeFn = std::function<Value(Interpreter&, const std::vector<Value>&)>;
 
@@ -37,7 +47,13 @@ enum class ValueType {
     CLASS,
     INSTANCE,
     DICTIONARY,
-    FUTURE
+    FUTURE,
+    STRING_BUILDER,
+    TYPED_ARRAY,
+    RANGE,
+    ITERATOR,
+    FILE_HANDLE,
+    JSON_DOC
 };
 
 // EZ user-defined function
@@ -46,12 +62,16 @@ struct EZFunction {
     std::vector<std::string> params;
     std::vector<StmtPtr> body;
     std::shared_ptr<Environment> closure;
+    bool isGenerator;  // Calling it returns an iterator instead of running the body
+    const EZClass* owner = nullptr;  // model this is a method of (for profiles and traces)
+    int file = 0;                    // --hotlines index of the file it was defined in
     
     EZFunction(const std::string& name, 
                const std::vector<std::string>& params,
                const std::vector<StmtPtr>& body,
-               std::shared_ptr<Environment> closure)
-        : name(name), params(params), body(body), closure(closure) {}
+               std::shared_ptr<Environment> closure,
+               bool isGenerator = false)
+        : name(name), params(params), body(body), closure(closure), isGenerator(isGenerator) {}
 };
 
 // Native (built-in) function
@@ -67,7 +87,7 @@ struct NativeFunction {
 // The main Value struct - dynamically typed
 struct Value {
     using ArrayType = std::vector<Value>;
-    using StringPtr = std::shared_ptr<std::string>;
+    using StringPtr = std::shared_ptr<EZString>;
     using ArrayPtr = std::shared_ptr<ArrayType>;
     using FunctionPtr = std::shared_ptr<EZFunction>;
     using NativeFnPtr = std::shared_ptr<NativeFunction>;
@@ -75,6 +95,12 @@ struct Value {
     using InstancePtr = std::shared_ptr<EZInstance>;
     using DictionaryPtr = std::shared_ptr<EZDictionary>;
     using FuturePtr = std::shared_ptr<std::shared_future<Value>>;
+    using StringBuilderPtr = std::shared_ptr<EZStringBuilder>;
+    using TypedArrayPtr = std::shared_ptr<EZTypedArray>;
+    using RangePtr = std::shared_ptr<EZRange>;
+    using IteratorPtr = std::shared_ptr<EZIterator>;
+    using FilePtr = std::shared_ptr<EZFile>;
+    using JsonDocPtr = std::shared_ptr<json::Document>;
     
     std::variant<
         std::nullptr_t,     // NIL
@@ -87,7 +113,13 @@ struct Value {
         ClassPtr,           // CLASS
         InstancePtr,        // INSTANCE
         DictionaryPtr,      // DICTIONARY
-        FuturePtr           // FUTURE
+        FuturePtr,          // FUTURE
+        StringBuilderPtr,   // STRING_BUILDER
+        TypedArrayPtr,      // TYPED_ARRAY
+        RangePtr,           // RANGE
+        IteratorPtr,        // ITERATOR
+        FilePtr,            // FILE_HANDLE
+        JsonDocPtr          // JSON_DOC
     > data;
     
     // Constructors
@@ -96,8 +128,9 @@ struct Value {
     Value(bool val) : data(val) {}
     Value(double val) : data(val) {}
     Value(int val) : data(static_cast<double>(val)) {}
-    Value(const std::string& val) : data(std::make_shared<std::string>(val)) {}
-    Value(const char* val) : data(std::make_shared<std::string>(val)) {}
+    Value(const std::string& val) : data(memory::make<EZString>(val)) {}
+    Value(std::string&& val) : data(memory::make<EZString>(std::move(val))) {}
+    Value(const char* val) : data(memory::make<EZString>(val)) {}
     Value(StringPtr val) : data(val) {}
     Value(ArrayPtr val) : data(val) {}
     Value(FunctionPtr val) : data(val) {}
@@ -106,6 +139,12 @@ struct Value {
     Value(InstancePtr val) : data(val) {}
     Value(DictionaryPtr val) : data(val) {}
     Value(FuturePtr val) : data(val) {}
+    Value(StringBuilderPtr val) : data(val) {}
+    Value(TypedArrayPtr val) : data(val) {}
+    Value(RangePtr val) : data(val) {}
+    Value(IteratorPtr val) : data(val) {}
+    Value(FilePtr val) : data(val) {}
+    Value(JsonDocPtr val) : data(val) {}
     
     // Type checking
     ValueType type() const {
@@ -120,6 +159,12 @@ struct Value {
         if (std::holds_alternative<InstancePtr>(data)) return ValueType::INSTANCE;
         if (std::holds_alternative<DictionaryPtr>(data)) return ValueType::DICTIONARY;
         if (std::holds_alternative<FuturePtr>(data)) return ValueType::FUTURE;
+        if (std::holds_alternative<StringBuilderPtr>(data)) return ValueType::STRING_BUILDER;
+        if (std::holds_alternative<TypedArrayPtr>(data)) return ValueType::TYPED_ARRAY;
+        if (std::holds_alternative<RangePtr>(data)) return ValueType::RANGE;
+        if (std::holds_alternative<IteratorPtr>(data)) return ValueType::ITERATOR;
+        if (std::holds_alternative<FilePtr>(data)) return ValueType::FILE_HANDLE;
+        if (std::holds_alternative<JsonDocPtr>(data)) return ValueType::JSON_DOC;
         return ValueType::NIL;
     }
     
@@ -134,13 +179,20 @@ struct Value {
     bool isInstance() const { return std::holds_alternative<InstancePtr>(data); }
     bool isDictionary() const { return std::holds_alternative<DictionaryPtr>(data); }
     bool isFuture() const { return std::holds_alternative<FuturePtr>(data); }
+    bool isStringBuilder() const { return std::holds_alternative<StringBuilderPtr>(data); }
+    bool isTypedArray() const { return std::holds_alternative<TypedArrayPtr>(data); }
+    bool isRange() const { return std::holds_alternative<RangePtr>(data); }
+    bool isIterator() const { return std::holds_alternative<IteratorPtr>(data); }
+    bool isFile() const { return std::holds_alternative<FilePtr>(data); }
+    bool isJsonDoc() const { return std::holds_alternative<JsonDocPtr>(data); }
     bool isCallable() const { return isFunction() || isNativeFunction() || isClass(); }
     
     // Value extraction
     bool asBool() const { return std::get<bool>(data); }
     double asNumber() const { return std::get<double>(data); }
     StringPtr asStringPtr() const { return std::get<StringPtr>(data); }
-    const std::string& asString() const { return *std::get<StringPtr>(data); }
+    const std::string& asString() const { return std::get<StringPtr>(data)->str(); }
+    std::string_view asStringView() const { return std::get<StringPtr>(data)->view(); }
     ArrayPtr asArrayPtr() const { return std::get<ArrayPtr>(data); }
     ArrayType& asArray() { return *std::get<ArrayPtr>(data); }
     const ArrayType& asArray() const { return *std::get<ArrayPtr>(data); }
@@ -150,6 +202,12 @@ struct Value {
     InstancePtr asInstance() const { return std::get<InstancePtr>(data); }
     DictionaryPtr asDictionaryPtr() const { return std::get<DictionaryPtr>(data); }
     FuturePtr asFuture() const { return std::get<FuturePtr>(data); }
+    StringBuilderPtr asStringBuilder() const { return std::get<StringBuilderPtr>(data); }
+    TypedArrayPtr asTypedArray() const { return std::get<TypedArrayPtr>(data); }
+    RangePtr asRange() const { return std::get<RangePtr>(data); }
+    IteratorPtr asIterator() const { return std::get<IteratorPtr>(data); }
+    FilePtr asFile() const { return std::get<FilePtr>(data); }
+    JsonDocPtr asJsonDoc() const { return std::get<JsonDocPtr>(data); }
     EZDictionary& asDictionary();
     const EZDictionary& asDictionary() const;
     
@@ -168,7 +226,7 @@ struct Value {
             case ValueType::NIL: return true;
             case ValueType::BOOL: return asBool() == other.asBool();
             case ValueType::NUMBER: return asNumber() == other.asNumber();
-            case ValueType::STRING: return asString() == other.asString();
+            case ValueType::STRING: return asStringView() == other.asStringView();
             case ValueType::ARRAY: {
                 const auto& a = asArray();
                 const auto& b = other.asArray();
@@ -178,6 +236,11 @@ struct Value {
                 }
                 return true;
             }
+            case ValueType::TYPED_ARRAY: return typedArrayEquals(other);
+            case ValueType::RANGE: return rangeEquals(other);
+            case ValueType::ITERATOR: return asIterator() == other.asIterator();
+            case ValueType::FILE_HANDLE: return asFile() == other.asFile();
+            case ValueType::JSON_DOC: return asJsonDoc() == other.asJsonDoc();
             // Functions, Classes, Instances, Futures compared by pointer identity implicitly?
             // Actually, we should probably implement pointer comparison for objects.
             // But strict equality for now.
@@ -185,6 +248,9 @@ struct Value {
         }
     }
     
+    bool typedArrayEquals(const Value& other) const;
+    bool rangeEquals(const Value& other) const;
+    
     // String conversion
     std::string toString() const;
     
@@ -193,15 +259,16 @@ struct Value {
     
     // Create array
     static Value makeArray(const std::vector<Value>& elements = {}) {
-        return Value(std::make_shared<ArrayType>(elements));
+        return Value(memory::make<ArrayType>(elements));
     }
     
     // Create function
     static Value makeFunction(const std::string& name,
                               const std::vector<std::string>& params,
                               const std::vector<StmtPtr>& body,
-                              std::shared_ptr<Environment> closure) {
-        return Value(std::make_shared<EZFunction>(name, params, body, closure));
+                              std::shared_ptr<Environment> closure,
+                              bool isGenerator = false) {
+        return Value(memory::make<EZFunction>(name, params, body, closure, isGenerator));
     }
     
     // Create native function
@@ -226,6 +293,7 @@ struct EZClass {
     std::vector<StmtPtr> initBody;
     std::unordered_map<std::string, Value> methods;
     std::unordered_map<std::string, bool> visibility;  // true = public (shown)
+    int file = 0;  // --hotlines index of the file it was defined in
     
     EZClass(const std::string& name) : name(name), parent(nullptr) {}
 };
@@ -252,26 +320,106 @@ struct EZInstance {
     }
 };
 
+// Keys iterate in insertion order (see OrderedMap.h)
 struct EZDictionary {
-    std::unordered_map<std::string, Value> map;
+    OrderedMap<Value> map;
+};
+
+// Mutable string buffer; appending is amortized O(1)
+struct EZStringBuilder {
+    std::string buffer;
+};
+
+// Packed numeric array; elements are stored unboxed so the kernels in
+// Simd.h can run over them directly
+struct EZTypedArray {
+    enum class Kind { FLOAT, INT };
+    Kind kind;
+    std::vector<double> floats;   // used when kind == FLOAT
+    std::vector<int64_t> ints;    // used when kind == INT
+    
+    explicit EZTypedArray(Kind kind, size_t n = 0) : kind(kind) {
+        if (kind == Kind::FLOAT) floats.assign(n, 0.0);
+        else ints.assign(n, 0);
+    }
+    
+    bool isFloat() const { return kind == Kind::FLOAT; }
+    size_t size() const { return isFloat() ? floats.size() : ints.size(); }
+    double get(size_t i) const { return isFloat() ? floats[i] : static_cast<double>(ints[i]); }
+    // False (storing nothing) if v does not fit an IntArray element
+    bool set(size_t i, double v) {
+        if (isFloat()) {
+            floats[i] = v;
+            return true;
+        }
+        if (!fitsInt(v)) return false;
+        ints[i] = static_cast<int64_t>(v);
+        return true;
+    }
+    
+    // Finite and within int64_t (NaN fails both comparisons)
+    static bool fitsInt(double v) { return v >= -9223372036854775808.0 && v < 9223372036854775808.0; }
+};
+
+// Integer sequence start, start+step, ... stopping before end. Elements are
+// computed on demand, so a range costs the same whatever its length.
+struct EZRange {
+    int64_t start;
+    int64_t end;
+    int64_t step;
+    
+    EZRange(int64_t start, int64_t end, int64_t step = 1) : start(start), end(end), step(step) {}
+    
+    size_t size() const {
+        if (step > 0 && start < end) return static_cast<size_t>((end - start + step - 1) / step);
+        if (step < 0 && start > end) return static_cast<size_t>((start - end - step - 1) / -step);
+        return 0;
+    }
+    double at(size_t i) const { return static_cast<double>(start + static_cast<int64_t>(i) * step); }
+    bool contains(double v) const {
+        // NaN and values past the 64-bit range cannot be cast, nor be members
+        if (!EZTypedArray::fitsInt(v)) return false;
+        if (v != static_cast<double>(static_cast<int64_t>(v))) return false;
+        int64_t n = static_cast<int64_t>(v);
+        if (step > 0 ? (n < start || n >= end) : (n > start || n <= end)) return false;
+        return (n - start) % step == 0;
+    }
+};
+
+// One-shot cursor over a sequence. Everything `get x in` can loop over is
+// turned into one of these by Interpreter::makeIterator; iterator values
+// (from iter() or generators) are used as-is and are consumed by looping.
+class EZIterator {
+public:
+    virtual ~EZIterator() = default;
+    // Stores the next element in `out`; returns false once exhausted
+    virtual bool next(Interpreter& interp, Value& out) = 0;
 };
 
+inline bool Value::rangeEquals(const Value& other) const {
+    const EZRange& a = *asRange();
+    const EZRange& b = *other.asRange();
+    if (a.size() != b.size()) return false;
+    return a.size() == 0 || (a.start == b.start && (a.size() == 1 || a.step == b.step));
+}
+
+inline bool Value::typedArrayEquals(const Value& other) const {
+    const EZTypedArray& a = *asTypedArray();
+    const EZTypedArray& b = *other.asTypedArray();
+    if (a.kind != b.kind) return false;
+    return a.isFloat() ? a.floats == b.floats : a.ints == b.ints;
+}
+
 inline EZDictionary& Value::asDictionary() { return *std::get<DictionaryPtr>(data); }
 inline const EZDictionary& Value::asDictionary() const { return *std::get<DictionaryPtr>(data); }
-inline Value Value::makeDictionary() { return Value(std::make_shared<EZDictionary>()); } 
+inline Value Value::makeDictionary() { return Value(memory::make<EZDictionary>()); } 
 
 inline std::string Value::toString() const {
     switch (type()) {
         case ValueType::NIL: return "nil";
         case ValueType::BOOL: return asBool() ? "true" : "false";
-        case ValueType::NUMBER: {
-            double num = asNumber();
-            if (num == static_cast<int>(num)) {
-                return std::to_string(static_cast<int>(num));
-            }
-            return std::to_string(num);
-        }
-        case ValueType::STRING: return asString();
+        case ValueType::NUMBER: return formatNumber(asNumber());
+        case ValueType::STRING: return std::string(asStringView());
         case ValueType::ARRAY: {
             std::string result = "[";
             const auto& arr = asArray();
@@ -298,6 +446,34 @@ inline std::string Value::toString() const {
             return "<dictionary>";
         case ValueType::FUTURE:
             return "<future>";
+        case ValueType::STRING_BUILDER:
+            return asStringBuilder()->buffer;
+        case ValueType::TYPED_ARRAY: {
+            const EZTypedArray& ta = *asTypedArray();
+            std::string result = "[";
+            for (size_t i = 0; i < ta.size(); i++) {
+                if (i > 0) result += ", ";
+                result += Value(ta.get(i)).toString();
+            }
+            result += "]";
+            return result;
+        }
+        case ValueType::RANGE: {
+            const EZRange& range = *asRange();
+            std::string result = "[";
+            for (size_t i = 0; i < range.size(); i++) {
+                if (i > 0) result += ", ";
+                result += Value(range.at(i)).toString();
+            }
+            result += "]";
+            return result;
+        }
+        case ValueType::ITERATOR:
+            return "<iterator>";
+        case ValueType::FILE_HANDLE:
+            return "<file " + asFile()->path + ">";
+        case ValueType::JSON_DOC:
+            return "<json document>";
         default:
             return "<unknown>";
     }
@@ -316,6 +492,12 @@ inline std::string Value::typeName() const {
         case ValueType::INSTANCE: return "instance";
         case ValueType::DICTIONARY: return "dictionary";
         case ValueType::FUTURE: return "future";
+        case ValueType::STRING_BUILDER: return "stringbuilder";
+        case ValueType::TYPED_ARRAY: return asTypedArray()->isFloat() ? "floatarray" : "intarray";
+        case ValueType::RANGE: return "range";
+        case ValueType::ITERATOR: return "iterator";
+        case ValueType::FILE_HANDLE: return "file";
+        case ValueType::JSON_DOC: return "jsondoc";
         default: return "unknown";
     }
 }
@@ -3,12 +3,100 @@
 #include <sstream>
 #include <string>
 #include <cstdlib>
+#include <mutex>
 #include "Lexer.h"
 #include "Parser.h"
 #include "Interpreter.h"
 #include "PackageManager.h"
+#include "Output.h"
+#include "Profiler.h"
+#include "CallTracer.h"
+#include "Trace.h"
+#include "Bench.h"
+#include "HotLines.h"
+#include "Memory.h"
 
-void runFile(const std::string& path) {
+// Options given before the script name: ez [options] <file.ez>
+struct RunOptions {
+    bool profile = false;
+    std::string profileOut = "profile.folded";
+    int profileHz = Profiler::DEFAULT_HZ;
+    bool traceCalls = false;
+    std::string traceCallsOut;  // JSON output; empty for the text table only
+    bool trace = false;
+    std::string traceOut = "trace.json";
+    bool hotlines = false;
+    std::string hotlinesOut = "hotlines.txt";
+    bool memstats = false;
+};
+
+// Consumes the --options starting at argv[i]. Returns false after printing
+// a message if one is not recognized.
+bool parseOptions(int argc, char* argv[], int& i, RunOptions& options) {
+    for (; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0 || arg == "--help") break;
+        if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg.rfind("--profile=", 0) == 0) {
+            options.profile = true;
+            options.profileOut = arg.substr(10);
+        } else if (arg == "--trace-calls") {
+            options.traceCalls = true;
+        } else if (arg.rfind("--trace-calls=", 0) == 0) {
+            options.traceCalls = true;
+            options.traceCallsOut = arg.substr(14);
+        } else if (arg == "--trace") {
+            options.trace = true;
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.trace = true;
+            options.traceOut = arg.substr(8);
+        } else if (arg == "--hotlines") {
+            options.hotlines = true;
+        } else if (arg.rfind("--hotlines=", 0) == 0) {
+            options.hotlines = true;
+            options.hotlinesOut = arg.substr(11);
+        } else if (arg.rfind("--max-heap=", 0) == 0) {
+            uint64_t bytes = 0;
+            if (!memory::parseSize(arg.c_str() + 11, bytes)) {
+                std::cerr << "Error: --max-heap expects a size such as 512M or 2G" << std::endl;
+                return false;
+            }
+            memory::setHeapLimit(bytes);
+        } else if (arg == "--memstats") {
+            options.memstats = true;
+        } else if (arg.rfind("--profile-hz=", 0) == 0) {
+            options.profileHz = std::atoi(arg.c_str() + 13);
+            if (options.profileHz <= 0) {
+                std::cerr << "Error: --profile-hz expects a positive number" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Error: unknown option '" << arg << "' (see ez --help)" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The options of the script being run, for stopTools()
+RunOptions activeOptions;
+
+// Stops the tools chosen on the command line and writes their reports.
+// Runs once: after the script finishes, or from Output's SIGINT/SIGTERM
+// handler when the script is stopped inside a server() loop.
+void stopTools() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        if (activeOptions.profile) Profiler::instance().stop();
+        if (activeOptions.traceCalls) CallTracer::instance().stop();
+        if (activeOptions.trace) Trace::instance().stop();
+        if (activeOptions.hotlines) HotLines::instance().stop();
+        if (activeOptions.memstats) memory::printReport();
+    });
+}
+
+void runFile(const std::string& path, const RunOptions& options) {
     std::ifstream file(path);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open file '" << path << "'" << std::endl;
@@ -33,8 +121,21 @@ void runFile(const std::string& path) {
         exit(65);
     }
     
+    activeOptions = options;
+    Output::instance().setInterruptHandler(stopTools);
+    if (options.profile) Profiler::instance().start(options.profileOut, options.profileHz);
+    if (options.traceCalls) CallTracer::instance().start(options.traceCallsOut);
+    if (options.trace) Trace::instance().start(options.traceOut);
+    if (options.hotlines) {
+        HotLines::instance().start(options.hotlinesOut);
+        HotLines::instance().addFile(path, source, statements);
+    }
+    
     Interpreter interpreter;
     interpreter.interpret(statements);
+    
+    Output::instance().flush();
+    stopTools();
 }
 
 void runRepl() {
@@ -107,8 +208,23 @@ void showHelp() {
     std::cout << "  ez install <pkg>  Install a package" << std::endl;
     std::cout << "  ez list           List installed packages" << std::endl;
     std::cout << "  ez init <name>    Create a new package" << std::endl;
+    std::cout << "  ez bench <file>   Benchmark the bench_* tasks in a script" << std::endl;
     std::cout << "  ez --help         Show this help message" << std::endl;
     std::cout << std::endl;
+    std::cout << "Options (before the script name):" << std::endl;
+    std::cout << "  --profile[=out.folded]  Sample the script and write folded stacks" << std::endl;
+    std::cout << "                          (default profile.folded) plus a summary" << std::endl;
+    std::cout << "  --profile-hz=N          Samples per second (default 1000)" << std::endl;
+    std::cout << "  --trace-calls[=out.json]  Count calls and time every task and builtin;" << std::endl;
+    std::cout << "                          prints a table, optionally also as JSON" << std::endl;
+    std::cout << "  --trace[=out.json]      Record a timeline of requests, tasks, awaits," << std::endl;
+    std::cout << "                          DB/HTTP calls and lock waits (default trace.json)" << std::endl;
+    std::cout << "  --hotlines[=out.txt]    Count and time every source line; writes an" << std::endl;
+    std::cout << "                          annotated listing (default hotlines.txt)" << std::endl;
+    std::cout << "  --memstats              Print heap and object counts at exit" << std::endl;
+    std::cout << "  --max-heap=SIZE         Raise an error in code that grows the heap past" << std::endl;
+    std::cout << "                          SIZE (e.g. 512M); server() answers 503 near it" << std::endl;
+    std::cout << std::endl;
     std::cout << "EZ Language Syntax:" << std::endl;
     std::cout << "  out \"text\"        Print to console" << std::endl;
     std::cout << "  in                Read input from user" << std::endl;
@@ -133,28 +249,60 @@ void showHelp() {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc > 1) {
-        std::string cmd = argv[1];
+    Output::instance().init();
+    
+    int first = 1;
+    RunOptions options;
+    if (!parseOptions(argc, argv, first, options)) return 64;
+    
+    if (first < argc) {
+        std::string cmd = argv[first];
         
         if (cmd == "install") {
-            if (argc < 3) {
+            if (argc < first + 2) {
                 std::cout << "Usage: ez install <pkg> [version]" << std::endl;
                 return 1;
             }
-            std::string pkg = argv[2];
-            std::string ver = (argc >= 4) ? argv[3] : "main";
+            std::string pkg = argv[first + 1];
+            std::string ver = (argc >= first + 3) ? argv[first + 2] : "main";
             PackageManager pm;
             return pm.installPackage(pkg, ver) ? 0 : 1;
         }
         else if (cmd == "init") {
-            if (argc < 3) {
+            if (argc < first + 2) {
                 std::cout << "Usage: ez init <name>" << std::endl;
                 return 1;
             }
             PackageManager pm(".");
-            pm.initPackage(argv[2]);
+            pm.initPackage(argv[first + 1]);
             return 0;
         }
+        else if (cmd == "bench") {
+            BenchOptions benchOptions;
+            std::string script;
+            for (int i = first + 1; i < argc; i++) {
+                std::string arg = argv[i];
+                if (arg.rfind("--time=", 0) == 0) {
+                    benchOptions.seconds = std::atof(arg.c_str() + 7);
+                } else if (arg.rfind("--filter=", 0) == 0) {
+                    benchOptions.filter = arg.substr(9);
+                } else if (arg.rfind("--json=", 0) == 0) {
+                    benchOptions.jsonOut = arg.substr(7);
+                } else if (arg.rfind("--compare=", 0) == 0) {
+                    benchOptions.comparePath = arg.substr(10);
+                } else if (arg.rfind("--", 0) != 0 && script.empty()) {
+                    script = arg;
+                } else {
+                    std::cerr << "Error: unknown bench option '" << arg << "'" << std::endl;
+                    return 64;
+                }
+            }
+            if (script.empty() || benchOptions.seconds <= 0) {
+                std::cout << "Usage: ez bench <file.ez> [--time=seconds] [--filter=text] [--json=out.json] [--compare=old.json]" << std::endl;
+                return 1;
+            }
+            return BenchRunner(benchOptions).run(script);
+        }
         else if (cmd == "list") {
             PackageManager pm;
             pm.listPackages();
@@ -165,11 +313,16 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         else {
-            runFile(cmd);
+            runFile(cmd, options);
             return 0;
         }
     }
     
+    if (first > 1) {
+        std::cerr << "Error: options need a script (ez [options] <file.ez>)" << std::endl;
+        return 64;
+    }
+    
     runRepl();
     return 0;
 }
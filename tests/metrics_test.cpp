@@ -0,0 +1,92 @@
+// Bucket boundaries of ServerMetrics::Histogram, checked through the
+// Prometheus text it renders (ctest runs this as metrics_histogram).
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -Isrc tests/metrics_test.cpp src/Metrics.cpp src/Memory.cpp -o metrics_test
+//   ./metrics_test
+
+#include "Metrics.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+using Histogram = ServerMetrics::Histogram;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::printf("%s - %s\n", ok ? "ok" : "FAILED", what.c_str());
+    if (!ok) failures++;
+}
+
+// Cumulative count of the bucket whose line starts with `prefix`
+long long bucket(const std::string& text, const std::string& prefix) {
+    size_t at = text.find(prefix);
+    if (at == std::string::npos) return -1;
+    return std::atoll(text.c_str() + at + prefix.size());
+}
+
+std::string render(const Histogram& h) {
+    std::string out;
+    h.write(out, "t", "test");
+    return out;
+}
+
+// Records one value into a fresh histogram and returns its text
+std::string one(uint64_t micros) {
+    Histogram h;
+    h.record(micros);
+    return render(h);
+}
+
+} // namespace
+
+int main() {
+    const uint64_t top = uint64_t(1) << Histogram::MAX_EXP;  // last finite bound, ~33.5 s
+    const std::string last = "t_bucket{le=\"33.5544\"} ";
+    const std::string beforeLast = "t_bucket{le=\"25.1658\"} ";
+    const std::string inf = "t_bucket{le=\"+Inf\"} ";
+
+    std::string text = render(Histogram());
+    int finite = 0;
+    for (size_t at = text.find("t_bucket{le=\""); at != std::string::npos; at = text.find("t_bucket{le=\"", at + 1)) {
+        finite++;
+    }
+    check(finite == Histogram::BUCKETS + 1, "one line per bucket plus +Inf");
+    check(bucket(text, last) == 0 && bucket(text, inf) == 0, "the top buckets render");
+
+    text = one(16);
+    check(bucket(text, "t_bucket{le=\"1.6e-05\"} ") == 1, "16 us lands in the first bucket");
+    text = one(17);
+    check(bucket(text, "t_bucket{le=\"1.6e-05\"} ") == 0 && bucket(text, "t_bucket{le=\"2.4e-05\"} ") == 1,
+          "17 us lands in the second bucket");
+
+    text = one(top);
+    check(bucket(text, beforeLast) == 0 && bucket(text, last) == 1, "2^MAX_EXP us is the last finite bucket");
+    text = one(top - 1);
+    check(bucket(text, last) == 1, "just under 2^MAX_EXP us is the last finite bucket");
+    text = one(top + 1);
+    check(bucket(text, last) == 0 && bucket(text, inf) == 1, "just over 2^MAX_EXP us is +Inf");
+    text = one(2 * top - 1);
+    check(bucket(text, last) == 0 && bucket(text, inf) == 1, "2^(MAX_EXP+1) - 1 us is +Inf");
+    text = one(2 * top);
+    check(bucket(text, last) == 0 && bucket(text, inf) == 1, "2^(MAX_EXP+1) us is +Inf");
+    text = one(UINT64_MAX / 2);
+    check(bucket(text, inf) == 1, "huge values are +Inf");
+    check(text.find("t_count 1\n") != std::string::npos, "count");
+
+    // Every bucket's bound is inclusive
+    Histogram all;
+    for (int e = Histogram::MIN_EXP; e < Histogram::MAX_EXP; e++) {
+        all.record(uint64_t(1) << e);
+        all.record((uint64_t(1) << e) + 1);
+    }
+    text = render(all);
+    check(bucket(text, last) == 2 * (Histogram::MAX_EXP - Histogram::MIN_EXP) && bucket(text, inf) == bucket(text, last),
+          "powers of two and their successors stay finite");
+
+    if (failures) std::printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
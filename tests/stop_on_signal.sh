@@ -0,0 +1,45 @@
+#!/bin/sh
+# Usage: stop_on_signal.sh <ez> <script> <INT|TERM> [ez options...]
+# Runs the script, sends the signal once it prints "ready", and reports the
+# exit status and the files named by --option=file, for the test's regex.
+ez=$1
+script=$2
+sig=$3
+shift 3
+
+for arg in "$@"; do
+    case $arg in --*=*) rm -f "${arg#*=}" ;; esac
+done
+
+out=stop_on_signal.$$.out
+"$ez" "$@" "$script" > "$out" &
+pid=$!
+tries=0
+until grep -q ready "$out" 2>/dev/null; do
+    tries=$((tries + 1))
+    if [ $tries -gt 300 ]; then
+        echo "never ready"
+        kill -KILL $pid
+        exit 1
+    fi
+    sleep 0.1
+done
+kill -s "$sig" $pid
+wait $pid
+echo "exit status $?"
+rm -f "$out"
+
+for arg in "$@"; do
+    case $arg in
+        --*=*)
+            file=${arg#*=}
+            if [ -s "$file" ]; then
+                echo "== $file =="
+                cat "$file"
+                echo
+            else
+                echo "missing $file"
+            fi
+            ;;
+    esac
+done